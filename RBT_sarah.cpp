@@ -1,3 +1,4 @@
+#pragma once
 // C++ Program to Implement Red Black Tree
 #include <iostream>
 #include <vector>
@@ -5,9 +6,21 @@
 #include <fstream>
 #include <functional>
 #include <cmath>  // pour fabs()
-
-
-const double EPSILON = 1e-4;
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include "piecewise_core.cpp"
+#include "piecewise_concept.cpp"
+#include "rbt_augment.cpp"
+#include "trace.cpp"
+#include "metrics.cpp"
+#include "recorder.cpp"
+#include "profile_stats.cpp"
+
+
+// Tolérance de l'arbre sur les abscisses (RedBlackTree::EPSILON). Nom distinct de l'EPSILON de
+// piecewise_map.cpp pour que les deux représentations puissent être incluses ensemble.
+inline constexpr double RBT_EPSILON = 1e-4;
 using namespace std;
 
 
@@ -30,23 +43,25 @@ struct DeltaPoint {
     }
 
     bool operator==(const DeltaPoint& other) const {
-        return fabs(x - other.x) < EPSILON;
+        return fabs(x - other.x) < RBT_EPSILON;
     }
 };
 
 
-template <typename T> class RedBlackTree;
+template <typename T, typename Aug = Augment<>, typename Interp = Linear> class RedBlackTree;
 
 RedBlackTree<DeltaPoint> delta_profile(double gap, double a, double b, double c);
 RedBlackTree<DeltaPoint> cba_profile(double cap, double a, double b);
 
 
 
-template <typename T> class RedBlackTree  {
+// Aug : augmentations des noeuds (rbt_augment.cpp), aucune par défaut.
+// Interp : Linear (défaut) ou Step, fonction en escalier (voir piecewise_core.cpp).
+template <typename T, typename Aug, typename Interp> class RedBlackTree  {
 private:
+    template <typename, typename, typename> friend class RedBlackTree;
 
-
-    struct Node {
+    struct Node : Aug::Fields {
     T data;
     Color color;
     Node* left;
@@ -56,20 +71,91 @@ private:
     explicit Node(T val) : data(val), color(RED), left(nullptr), right(nullptr), parent(nullptr) {}
 };
 
+    static constexpr double EPSILON = RBT_EPSILON;
+
     Node* root;
+    bool autoNormalize; // normalisation après chaque sum/minus/minfunction/maxfunction
 
     //Fonction de clonage (copie profonde)
     Node* cloneTree(Node* node, Node* parent = nullptr) {
         if (!node) return nullptr;
         Node* n = new Node(node->data);
+        metric<MetricCounter::NodeAllocs>();
         n->color = node->color;
         n->parent = parent;
         n->left = cloneTree(node->left, n);
         n->right = cloneTree(node->right, n);
+        pull(n);
         return n;
     }
 
-    Node* successor(Node* node) {
+    // Construit un arbre équilibré à partir de points triés : O(n).
+    // Les noeuds du dernier niveau (incomplet) sont rouges, tous les autres noirs.
+    // Les noeuds sont pris dans pool tant qu'il en reste (réutilisation de l'ancien arbre), sinon alloués.
+    Node* buildBalanced(const std::vector<std::pair<double, double>>& pts, long lo, long hi,
+                        int depth, int redDepth, Node* parent, std::vector<Node*>& pool) {
+        if (lo > hi) return nullptr;
+        long mid = lo + (hi - lo) / 2;
+        Node* n;
+        if (!pool.empty()) {
+            n = pool.back();
+            pool.pop_back();
+            n->data = T{pts[mid].first, pts[mid].second};
+        } else {
+            n = new Node(T{pts[mid].first, pts[mid].second});
+            metric<MetricCounter::NodeAllocs>();
+        }
+        n->parent = parent;
+        n->color = (depth == redDepth && depth > 0) ? RED : BLACK;
+        n->left = buildBalanced(pts, lo, mid - 1, depth + 1, redDepth, n, pool);
+        n->right = buildBalanced(pts, mid + 1, hi, depth + 1, redDepth, n, pool);
+        pull(n);
+        return n;
+    }
+
+    // Remplace le contenu de l'arbre par des points (x, deltaY) triés, en réutilisant ses noeuds
+    void assignPoints(const std::vector<std::pair<double, double>>& pts) {
+        metric<MetricCounter::BreakpointsTouched>(pts.size());
+        std::vector<Node*> pool;
+        if (root) {
+            std::vector<Node*> stack{root};
+            while (!stack.empty()) {
+                Node* n = stack.back();
+                stack.pop_back();
+                if (n->left) stack.push_back(n->left);
+                if (n->right) stack.push_back(n->right);
+                pool.push_back(n);
+            }
+        }
+        int redDepth = 0;
+        while ((2L << redDepth) <= (long)pts.size()) ++redDepth; // floor(log2(n))
+        root = buildBalanced(pts, 0, (long)pts.size() - 1, 0, redDepth, nullptr, pool);
+        for (Node* n : pool) delete n; // noeuds en trop
+        metric<MetricCounter::NodeFrees>(pool.size());
+    }
+
+    // Recalcule les augmentations de n (enfants à jour) ; sans effet avec Augment<>
+    static void pull(Node* n) {
+        if constexpr (Aug::active) Aug::pull(n);
+    }
+
+    // Recalcule les augmentations de n jusqu'à la racine, après une modification de n ou de ses enfants
+    static void pullUp(Node* n) {
+        if constexpr (Aug::active)
+            for (; n; n = n->parent) Aug::pull(n);
+    }
+
+    // Change le signe des deltaY du sous-arbre et recalcule ses augmentations au retour (enfants avant parents) :
+    // un seul parcours, sans allocation, profondeur O(log n)
+    static void negateSubtree(Node* n) {
+        if (!n) return;
+        n->data.deltaY = -n->data.deltaY;
+        negateSubtree(n->left);
+        negateSubtree(n->right);
+        pull(n);
+    }
+
+    static Node* successor(Node* node) {
         if (!node) return nullptr;
         if (node->right) {
             Node* curr = node->right;
@@ -84,10 +170,82 @@ private:
         return parent;
     }
 
+    static Node* predecessor(Node* node) {
+        if (!node) return nullptr;
+        if (node->left) {
+            Node* curr = node->left;
+            while (curr->right) curr = curr->right;
+            return curr;
+        }
+        Node* parent = node->parent;
+        while (parent && node == parent->left) {
+            node = parent;
+            parent = parent->parent;
+        }
+        return parent;
+    }
+
+    // Insertion sans instrumentation, pour les opérations qui comptent déjà leurs points (apply_delta, splitAt)
+    void insertNode(T val) {
+        Node* newNode = new Node(val);
+        metric<MetricCounter::NodeAllocs>();
+        Node* y = nullptr;
+        Node* x = root;
+
+        while (x != nullptr) {
+            y = x;
+            if (newNode->data < x->data)
+                x = x->left;
+            else
+                x = x->right;
+        }
+
+        newNode->parent = y;
+        if (y == nullptr)
+            root = newNode;
+        else if (newNode->data < y->data)
+            y->left = newNode;
+        else
+            y->right = newNode;
+
+        pullUp(newNode);
+        fixInsert(newNode);
+    }
+
+    // premier noeud d'abscisse >= x
+    Node* lowerBound(double x) const {
+        Node* node = root;
+        Node* best = nullptr;
+        while (node) {
+            if (node->data.x >= x) {
+                best = node;
+                node = node->left;
+            } else {
+                node = node->right;
+            }
+        }
+        return best;
+    }
+
+    // Garantit un point d'abscisse x sans changer f : le nouveau point prend sa part du deltaY du suivant
+    void splitAt(double x) {
+        Node* next = lowerBound(x);
+        if (next && next->data.x == x) return;
+        Node* prev = next ? predecessor(next) : nullptr;
+        double share = 0.0; // avant le premier point (f = 0) ou après le dernier (f constante)
+        if (next && prev) {
+            share = split_share(prev->data.x, x, next->data.x, next->data.deltaY);
+            next->data.deltaY -= share;
+            pullUp(next);
+        }
+        insertNode(T{x, share});
+    }
+
     //  left rotation
     void leftRotate(Node* x) {
         if (x == nullptr || x->right == nullptr)
             return;
+        metric<MetricCounter::Rotations>();
 
         Node* y = x->right;
         x->right = y->left;
@@ -102,12 +260,15 @@ private:
             x->parent->right = y;
         y->left = x;
         x->parent = y;
+        pull(x);
+        pull(y);
     }
 
     //  right rotation
     void rightRotate(Node* y) {
         if (y == nullptr || y->left == nullptr)
             return;
+        metric<MetricCounter::Rotations>();
 
         Node* x = y->left;
         y->left = x->right;
@@ -122,11 +283,14 @@ private:
             y->parent->right = x;
         x->right = y;
         y->parent = x;
+        pull(y);
+        pull(x);
     }
 
     // fix violations after inserting a node
     void fixInsert(Node* z) {
         while (z != root && z->parent->color == RED) {
+            metric<MetricCounter::FixInsertIters>();
             if (z->parent == z->parent->parent->left) {
                 Node* y = z->parent->parent->right;
                 if (y != nullptr && y->color == RED) {
@@ -183,13 +347,16 @@ private:
 
         Node* y = z;
         Node* x = nullptr;
+        Node* xParent = nullptr; // parent de x, même quand x est nul (fixDelete en a besoin)
         Color y_original_color = y->color;
 
         if (z->left == nullptr) {
             x = z->right;
+            xParent = z->parent;
             transplant(z, z->right);
         } else if (z->right == nullptr) {
             x = z->left;
+            xParent = z->parent;
             transplant(z, z->left);
         } else {
             y = minimum(z->right);
@@ -197,87 +364,83 @@ private:
             x = y->right;
 
             if (y->parent == z) {
-                if (x != nullptr)
-                    x->parent = y; // Check if x is not nullptr before assigning parent
+                xParent = y;
             } else {
-                if (x != nullptr)
-                    x->parent = y->parent; // Check if x and y->parent are not nullptr before assigning parent
-                transplant(y, y->right);
-                if (y->right != nullptr)
-                    y->right->parent = y; // Check if y->right is not nullptr before assigning parent
+                xParent = y->parent;
+                transplant(y, y->right); // x remonte à la place de y
                 y->right = z->right;
-                if (y->right != nullptr)
-                    y->right->parent = y; // Check if y->right is not nullptr before assigning parent
+                y->right->parent = y;
             }
             transplant(z, y);
             y->left = z->left;
-            if (y->left != nullptr)
-                y->left->parent = y; // Check if y->left is not nullptr before assigning parent
+            y->left->parent = y;
             y->color = z->color;
         }
+        pullUp(xParent); // xParent est le noeud le plus bas dont le sous-arbre a changé
 
-        if (y_original_color == BLACK && x != nullptr) // Check if x is not nullptr
-            fixDelete(x);
+        if (y_original_color == BLACK)
+            fixDelete(x, xParent);
 
         delete z; // Free memory allocated for the deleted node
+        metric<MetricCounter::NodeFrees>();
     }
 
+    static bool isBlack(Node* n) { return n == nullptr || n->color == BLACK; }
 
-    // Function to fix violations after deleting a node
-    void fixDelete(Node* x) {
-        while (x != root && x != nullptr && x->color == BLACK) {
-            if (x == x->parent->left) {
-                Node* w = x->parent->right;
+    // Function to fix violations after deleting a node (x peut être nul : son parent est passé à part)
+    void fixDelete(Node* x, Node* parent) {
+        while (x != root && isBlack(x)) {
+            metric<MetricCounter::FixDeleteIters>();
+            if (x == parent->left) {
+                Node* w = parent->right;
                 if (w->color == RED) {
                     w->color = BLACK;
-                    x->parent->color = RED;
-                    leftRotate(x->parent);
-                    w = x->parent->right;
+                    parent->color = RED;
+                    leftRotate(parent);
+                    w = parent->right;
                 }
-                if ((w->left == nullptr || w->left->color == BLACK) &&
-                    (w->right == nullptr || w->right->color == BLACK)) {
+                if (isBlack(w->left) && isBlack(w->right)) {
                     w->color = RED;
-                    x = x->parent;
+                    x = parent;
+                    parent = x->parent;
                 } else {
-                    if (w->right == nullptr || w->right->color == BLACK) {
-                        if (w->left != nullptr)
-                            w->left->color = BLACK;
+                    if (isBlack(w->right)) {
+                        w->left->color = BLACK;
                         w->color = RED;
                         rightRotate(w);
-                        w = x->parent->right;
+                        w = parent->right;
                     }
-                    w->color = x->parent->color;
-                    x->parent->color = BLACK;
+                    w->color = parent->color;
+                    parent->color = BLACK;
                     if (w->right != nullptr)
                         w->right->color = BLACK;
-                    leftRotate(x->parent);
+                    leftRotate(parent);
                     x = root;
                 }
             } else {
-                Node* w = x->parent->left;
+                Node* w = parent->left;
                 if (w->color == RED) {
                     w->color = BLACK;
-                    x->parent->color = RED;
-                    rightRotate(x->parent);
-                    w = x->parent->left;
+                    parent->color = RED;
+                    rightRotate(parent);
+                    w = parent->left;
                 }
-                if ((w->right == nullptr || w->right->color == BLACK) &&
-                    (w->left == nullptr || w->left->color == BLACK)) {
+                if (isBlack(w->right) && isBlack(w->left)) {
                     w->color = RED;
-                    x = x->parent;
+                    x = parent;
+                    parent = x->parent;
                 } else {
-                    if (w->left == nullptr || w->left->color == BLACK) {
-                        if (w->right != nullptr)
-                            w->right->color = BLACK;
+                    if (isBlack(w->left)) {
+                        w->right->color = BLACK;
                         w->color = RED;
                         leftRotate(w);
-                        w = x->parent->left;
+                        w = parent->left;
                     }
-                    w->color = x->parent->color;
-                    x->parent->color = BLACK;
+                    w->color = parent->color;
+                    parent->color = BLACK;
                     if (w->left != nullptr)
                         w->left->color = BLACK;
-                    rightRotate(x->parent);
+                    rightRotate(parent);
                     x = root;
                 }
             }
@@ -291,6 +454,7 @@ private:
             deleteTree(node->left);
             deleteTree(node->right);
             delete node;
+            metric<MetricCounter::NodeFrees>();
         }
     }
 
@@ -352,22 +516,40 @@ private:
     }
 
 public:
-    RedBlackTree() : root(nullptr) {}
-    ~RedBlackTree() { deleteTree(root); root = nullptr; }
+    using Interpolation = Interp;
+
+    RedBlackTree() : root(nullptr), autoNormalize(false) {}
+    ~RedBlackTree() { record_forget(this); deleteTree(root); root = nullptr; }
 
 
     // Constructeur de copie (utilise cloneTree)
-    RedBlackTree(const RedBlackTree& other) : root(nullptr) {   
-        cout << " clone tree is called" << endl;
+    RedBlackTree(const RedBlackTree& other) : root(nullptr), autoNormalize(other.autoNormalize) {   
+        trace<TraceLevel::Debug>("rbt.clone");
         root = cloneTree(other.root, nullptr);
     }
 
+    // Constructeur de déplacement : reprend les noeuds, other reste vide
+    RedBlackTree(RedBlackTree&& other) noexcept : root(other.root), autoNormalize(other.autoNormalize) {
+        record_forget(&other);
+        other.root = nullptr;
+    }
+
     //swap helper
     void swap(RedBlackTree& other) noexcept {
+        record_forget(this);
+        record_forget(&other);
         std::swap(root, other.root);
+        std::swap(autoNormalize, other.autoNormalize);
     }
 
-    // Opérateur d’affectation (copy-and-swap)
+    // Arbre construit à partir de points (x, deltaY) triés, en O(n) (arbre équilibré, sans rotation)
+    static RedBlackTree from_points(const std::vector<std::pair<double, double>>& pts) {
+        RedBlackTree r;
+        r.assignPoints(pts);
+        return r;
+    }
+
+    // Opérateur d’affectation (copy-and-swap) : copie pour une lvalue, déplacement (sans clonage) pour une rvalue
     RedBlackTree& operator=(RedBlackTree other) { // copie locale
         swap(other);
         return *this;
@@ -376,27 +558,10 @@ public:
 
     // insert a node
     void insert(T val) {
-        Node* newNode = new Node(val);
-        Node* y = nullptr;
-        Node* x = root;
-
-        while (x != nullptr) {
-            y = x;
-            if (newNode->data < x->data)
-                x = x->left;
-            else
-                x = x->right;
-        }
-
-        newNode->parent = y;
-        if (y == nullptr)
-            root = newNode;
-        else if (newNode->data < y->data)
-            y->left = newNode;
-        else
-            y->right = newNode;
-
-        fixInsert(newNode);
+        RecordCall<> rec(this, RecordOp::Insert, {val.x, val.deltaY});
+        OpTimer<MetricOp::Insert> timer;
+        metric<MetricCounter::BreakpointsTouched>();
+        insertNode(val);
     }
 
 // delete a node by value
@@ -416,13 +581,41 @@ public:
     //     std::cout << "Node with value " << val.x << " not found in the tree." << std::endl;
     // }
 
+    // Noms de l'interface commune (piecewise_concept.cpp) : deltaY du point x, remplacé s'il existe
+    void addBreakpoint(double x, double deltaY) {
+        RecordCall<> rec(this, RecordOp::AddBreakpoint, {x, deltaY});
+        OpTimer<MetricOp::Insert> timer;
+        metric<MetricCounter::BreakpointsTouched>();
+        Node* z = lowerBound(x);
+        if (z && z->data.x == x) {
+            z->data.deltaY = deltaY;
+            pullUp(z);
+        } else {
+            insertNode(T{x, deltaY});
+        }
+    }
+
+    // Supprime le point d'abscisse x (exacte), sans message
+    void removeBreakpoint(double x) {
+        RecordCall<> rec(this, RecordOp::RemoveBreakpoint, {x});
+        OpTimer<MetricOp::Remove> timer;
+        Node* z = lowerBound(x);
+        if (z && z->data.x == x) {
+            metric<MetricCounter::BreakpointsTouched>();
+            deleteNode(z);
+        }
+    }
+
     void remove(const T& val) {
+        OpTimer<MetricOp::Remove> timer;
         Node* z = search(root, val); // utilise operator== (EPSILON)
         if (z) {
+            RecordCall<> rec(this, RecordOp::RemoveBreakpoint, {z->data.x});
+            metric<MetricCounter::BreakpointsTouched>();
             deleteNode(z);
-            std::cout << "Node with value " << val.x << " remove from the tree." << std::endl;
+            trace<TraceLevel::Debug>("rbt.remove", val.x, 1.0);
         } else {
-            std::cout << "Node with value " << val.x << " not found in the tree." << std::endl;
+            trace<TraceLevel::Debug>("rbt.remove", val.x, 0.0); // absent de l'arbre
         }
     }
     
@@ -443,9 +636,11 @@ double eval_in(double x) {
 
 
 
+// Somme des deltaY des points d'abscisse <= x. Comparaisons exactes, comme assignPoints et la fusion : la
+// fusion peut placer des croisements à moins de EPSILON d'un voisin, une tolérance ici les compterait à tort.
 void accumulateUpTo(Node* node, double x, double& sum) const{
     if (!node) return;
-    if (node->data.x > x + EPSILON) {
+    if (node->data.x > x) {
         accumulateUpTo(node->left, x, sum);
     } else {
         accumulateUpTo(node->left, x, sum);
@@ -454,13 +649,18 @@ void accumulateUpTo(Node* node, double x, double& sum) const{
     }
 }
 
+// Somme des deltaY jusqu'à x compris : O(log n) avec Augment<SumDelta>, parcours de l'arbre sinon
+double sumUpTo(double x) const {
+    double sum = 0.0;
+    if constexpr (Aug::template has<SumDelta>) sum = prefixSum(x);
+    else accumulateUpTo(root, x, sum);
+    return sum;
+}
+
+// left : dernier point d'abscisse <= x, right : premier point d'abscisse > x
 void findBoundingNodes(Node* node, double x, Node*& left, Node*& right) const{
     while (node) {
-        if (fabs(x - node->data.x) < EPSILON) {
-            left = node;
-            right = nullptr;
-            return;
-        } else if (x < node->data.x) {
+        if (x < node->data.x) {
             right = node;
             node = node->left;
         } else {
@@ -470,43 +670,35 @@ void findBoundingNodes(Node* node, double x, Node*& left, Node*& right) const{
     }
 }
 
+double evaluate(double x) const {
+    return eval(x);
+}
+
 double eval(double x) const {
+    OpTimer<MetricOp::Eval> timer;
+    metric<MetricCounter::Evals>();
     if (!root) return 0.0;
 
-    double sum = 0.0;
-    accumulateUpTo(root, x, sum);
+    double sum = sumUpTo(x);
+    if constexpr (Interp::step) return sum; // escalier : la somme préfixe suffit, pas d'interpolation
 
     Node* left = nullptr;
     Node* right = nullptr;
     findBoundingNodes(root, x, left, right);
 
-    if (!right) {
-        // x ≈ xi exact match, or x > max
-        return sum;
-    }
-
-    if (fabs(x - right->data.x) < EPSILON) {
-        // x ≈ x{i+1}, ajouter son deltaY complet
-        sum += right->data.deltaY;
-        return sum;
-    }
-
-    if (left) {
-        double dx = right->data.x - left->data.x;
-        if (dx != 0.0) {
-            double fraction = (x - left->data.x) / dx;
-            sum += fraction * right->data.deltaY;
-        }
-    }
+    // avant le premier point (f = 0) ou après le dernier (f constante)
+    if (!left || !right) return sum;
 
-    return sum;
+    // interpolation sur [left, right] : une part du deltaY de right proportionnelle à x - left.x
+    double fraction = (x - left->data.x) / (right->data.x - left->data.x);
+    return sum + fraction * right->data.deltaY;
 }
 
 double eval_delta(double x) const {
     DeltaPoint probe {x, 0.0};
 
     // enlever le const pour pouvoir utiliser search
-    auto* self = const_cast<RedBlackTree<T>*>(this);
+    auto* self = const_cast<RedBlackTree*>(this);
 
     Node* match = self->search(self->root, probe);
     if (match) {
@@ -518,7 +710,7 @@ double eval_delta(double x) const {
 
         double y = this->eval(x);   // eval peut rester const
         double yPrev = left ? this->eval(left->data.x) : 0.0;
-        cout << "eval_delta yprev = "<< yPrev << " y = "<< y <<endl;
+        trace<TraceLevel::Verbose>("rbt.eval_delta", yPrev, y);
         return y - yPrev;
     }
 }
@@ -547,849 +739,457 @@ double eval_delta(double x) const {
 //     }
 // }
 
-// void sum(const RedBlackTree& g) {
-//     auto g_points = g.to_points_delta();
-//     if (g_points.empty()) return;
-
-//     double xg_min = g_points.front().first;
-//     double xg_max = g_points.back().first;
-
-//     auto f_points = this->to_points_compact_bis(xg_min, xg_max);
-
-//     size_t i = 0, j = 0;
-
-//     std::cout << "=== Starting sum ===\n";
-//     std::cout << "g_points size: " << g_points.size() << ", f_points size: " << f_points.size() << "\n";
-
-//     // fusion parallèle
-//     while (i < g_points.size() || j < f_points.size()) {
-//         double x;
-//         bool take_g = false, take_f = false;
-
-//         if (i < g_points.size() && (j >= f_points.size() || g_points[i].first < f_points[j].first)) {
-//             x = g_points[i].first;
-//             take_g = true;
-//             std::cout << "Taking point from g_points: x = " << x << " (i = " << i << ")\n";
-//         } else if (j < f_points.size() && (i >= g_points.size() || f_points[j].first < g_points[i].first)) {
-//             x = f_points[j].first;
-//             take_f = true;
-//             std::cout << "Taking point from f_points: x = " << x << " (j = " << j << ")\n";
-//         } else { // même abscisse
-//             x = g_points[i].first;
-//             take_g = take_f = true;
-//             std::cout << "Points coincide: x = " << x << " (i = " << i << ", j = " << j << ")\n";
-//         }
-
-//         // calcul des deltas
-//         double deltaF = this->eval_delta(x);
-//         double deltaG = g.eval_delta(x);
-//         double delta_sum = deltaF + deltaG;
-
-//         std::cout << "deltaF = " << deltaF << ", deltaG = " << deltaG 
-//                   << ", delta_sum = " << delta_sum << "\n";
-
-//         // --- mise à jour du noeud suivant (right) ---
-//         Node* left = nullptr;
-//         Node* right = nullptr;
-//         findBoundingNodes(root, x+0.01, left, right);
-
-//         // insérer ou mettre à jour dans f
-//         DeltaPoint probe {x, 0.0};
-//         Node* match = search(root, probe);
-
-//         if (match) {
-//             match->data.deltaY = delta_sum;
-//             std::cout << "Updated existing node in f: x = " << x << ", new deltaY = " << match->data.deltaY << "\n";
-//         } else {
-//             this->insert({x, delta_sum});
-//             std::cout << "Inserted new node in f: x = " << x << ", deltaY = " << delta_sum << "\n";
-//         }
-
-
-
-//         if (right) {
-//             right->data.deltaY -= deltaG;
-//             std::cout << "Updated right node: x = " << right->data.x 
-//                       << ", new deltaY = " << right->data.deltaY << "\n";
-//         }
-
-//         // avancer les pointeurs
-//         if (take_g) i++;
-//         if (take_f) j++;
-//     }
-
-
-     
-//        std::cout << "===on s'occupe du dernier noeud ===\n";
-
-//         Node* left = nullptr;
-//         Node* right = nullptr;
-//         findBoundingNodes(root, xg_max+0.01, left, right);
-
-//         if (right) {
-//             double xright = right->data.x;
-//             double F = this->eval(xright);
-//             double G = g.eval(xright);
-//             double sum = F + G;
-//             double yprevf = (left)? this->eval(left->data.x):0;
-//             double delta_sum = sum - yprevf;
-//             right->data.deltaY = delta_sum ;
-//             std::cout << "Updated right node: x = " << right->data.x 
-//                       << ", new deltaY = " << right->data.deltaY << "\n";
-//         }
-
-
-//     std::cout << "=== Sum completed ===\n";
-// }
-
-void sum(const RedBlackTree& g) {
-    auto g_points = g.to_points_delta();
-    if (g_points.empty()) return;
-    auto f = *this;
-    double xg_min = g_points.front().first;
-    double xg_max = g_points.back().first;
-    double yi_prec = 0;
-
-    auto f_points = this->to_points_compact_bis(xg_min, xg_max);
-
-    size_t i = 0, j = 0;
-
-    // correction du noeud right (après x)
-    Node* left1 = nullptr;
-    Node* right1 = nullptr;
-    findBoundingNodes(root, xg_min-0.01, left1, right1);
-    if (right1) {
-        yi_prec  =  f.eval(left1->data.x);
-        cout<< "un noeud de f à gauche de g trouve" <<endl;
-        cout<< " fisrt yi = "<< yi_prec <<endl;
-        cout<< " fisrt xi = "<< left1->data.x <<endl;
-    }        
- 
-
-    // --- Phase 1 : on prépare les opérations ---
-    struct Operation {
-        enum Type { Insert, Update } type;
-        double x;
-        double delta;
-    };
-    std::vector<Operation> ops;
-
-    std::cout << "=== Starting sum ===\n";
-    std::cout << "g_points size: " << g_points.size() << ", f_points size: " << f_points.size() << "\n";
-
-    while (i < g_points.size() || j < f_points.size()) {
-        double x;
-        bool take_g = false, take_f = false;
-
-        if (i < g_points.size() && (j >= f_points.size() || g_points[i].first < f_points[j].first)) {
-            x = g_points[i].first;
-            take_g = true;
-        } else if (j < f_points.size() && (i >= g_points.size() || f_points[j].first < g_points[i].first)) {
-            x = f_points[j].first;
-            take_f = true;
-        } else { // même abscisse
-            x = g_points[i].first;
-            take_g = take_f = true;
-        }
-
-        // calcul des deltas
-        double F = f.eval(x);
-        double G = g.eval(x);
-        double sum = F + G;
-
-        std::cout << "x = " << x 
-                  << " | F = " << F << ", G = " << G 
-                  << " -> sum = " << sum << "\n";
-        double delta_sum = sum-yi_prec;
+//================================================================================================================
+//====================================== Requêtes sur les augmentations ==========================================
+//================================================================================================================
 
-        std::cout << "yi+1 = " << sum
-        << " | yi = " << yi_prec << endl; 
-        yi_prec = sum;
+// Nombre de points : O(1) avec Count, parcours sinon
+size_t size() const {
+    if constexpr (Aug::template has<Count>) {
+        return root ? root->count : 0;
+    } else {
+        size_t n = 0;
+        for (Cursor c = cursor(); c.node; c.node = successor(c.node)) ++n;
+        return n;
+    }
+}
 
-        Node* match = search(root, DeltaPoint{x, 0.0});
-        if (match) {
-            ops.push_back({Operation::Update, x, delta_sum});
+// Somme des deltaY des points d'abscisse <= x (même règle que accumulateUpTo), en une descente
+double prefixSum(double x) const requires (Aug::template has<SumDelta>) {
+    double s = 0.0;
+    for (Node* n = root; n;) {
+        if (n->data.x > x) {
+            n = n->left;
         } else {
-            ops.push_back({Operation::Insert, x, delta_sum});
+            s += n->data.deltaY + (n->left ? n->left->sumDelta : 0.0);
+            n = n->right;
         }
-
-        // // correction du noeud right (après x)
-        // Node* left = nullptr;
-        // Node* right = nullptr;
-        // findBoundingNodes(root, x+0.01, left, right);
-        // if (right) {
-        //     ops.push_back({Operation::Update, right->data.x, right->data.deltaY - deltaG});
-        // }
-
-        if (take_g) i++;
-        if (take_f) j++;
     }
-
-
-
-    // --- Phase 2 : traiter le dernier noeud ---
-    std::cout << "=== Handling last node ===\n";
-    Node* left = nullptr;
-    Node* right = nullptr;
-    findBoundingNodes(root, xg_max+0.01, left, right);
-
-
-    if (right) {
-        double xright = right->data.x;
-        double F = f.eval(xright);
-        double G = g.eval(xright);
-        cout << " F = "<< F << " G " << G << endl;
-        double sum = F + G;
-        cout << "yprev  = "<< yi_prec << endl;
-        cout << "y  = "<< sum << endl;
-        double delta_sum = sum - yi_prec;
-        right->data.deltaY = delta_sum ;
-        std::cout << "Updated right node: x = " << right->data.x 
-                  << ", new deltaY = " << right->data.deltaY << "\n";
-    
-    } 
-
-
-
-
-        // --- Phase 3 : on applique les opérations ---
-        std::cout << "=== Applying operations ===\n";
-        for (auto& op : ops) {
-            if (op.type == Operation::Insert) {
-                this->insert({op.x, op.delta});
-                std::cout << "Inserted node: x = " << op.x << ", deltaY = " << op.delta << "\n";
-            } else {
-                Node* match = search(root, DeltaPoint{op.x, 0.0});
-                if (match) {
-                    match->data.deltaY = op.delta;
-                    std::cout << "Updated node: x = " << op.x << ", new deltaY = " << op.delta << "\n";
-                }
-            }
-        }
-
-    
-
-    std::cout << "=== Sum completed ===\n";
+    return s;
 }
 
+// Valeur après le dernier point
+double total() const requires (Aug::template has<SumDelta>) {
+    return root ? root->sumDelta : 0.0;
+}
 
-void minus(const RedBlackTree& g) {
-    auto g_points = g.to_points_delta();
-    if (g_points.empty()) return;
-    auto f = *this; // copie snapshot
-    double xg_min = g_points.front().first;
-    double xg_max = g_points.back().first;
-    double yi_prec = 0;
-
-    auto f_points = this->to_points_compact_bis(xg_min, xg_max);
-
-    size_t i = 0, j = 0;
-
-    // Chercher un noeud de f à gauche de g pour initialiser yi_prec
-    Node* left1 = nullptr;
-    Node* right1 = nullptr;
-    findBoundingNodes(root, xg_min-0.01, left1, right1);
-    if (left1) {
-        yi_prec  = f.eval(left1->data.x);
-        std::cout << "un noeud de f à gauche de g trouvé\n";
-        std::cout << " first yi = " << yi_prec << "\n";
-        std::cout << " first xi = " << left1->data.x << "\n";
-    }
-
-    // --- Phase 1 : préparation des opérations ---
-    struct Operation {
-        enum Type { Insert, Update } type;
-        double x;
-        double delta;
-    };
-    std::vector<Operation> ops;
-
-    std::cout << "=== Starting minus ===\n";
-    std::cout << "g_points size: " << g_points.size() 
-              << ", f_points size: " << f_points.size() << "\n";
-
-    while (i < g_points.size() || j < f_points.size()) {
-        double x;
-        bool take_g = false, take_f = false;
-
-        if (i < g_points.size() && (j >= f_points.size() || g_points[i].first < f_points[j].first)) {
-            x = g_points[i].first;
-            take_g = true;
-        } else if (j < f_points.size() && (i >= g_points.size() || f_points[j].first < g_points[i].first)) {
-            x = f_points[j].first;
-            take_f = true;
-        } else { // même abscisse
-            x = g_points[i].first;
-            take_g = take_f = true;
-        }
-
-        // calcul F - G
-        double F = f.eval(x);
-        double G = g.eval(x);
-        double diff = F - G;
-
-        std::cout << "x = " << x 
-                  << " | F = " << F << ", G = " << G 
-                  << " -> diff = " << diff << "\n";
+// max et min de f sur tout R (f = 0 avant le premier point, linéaire entre deux points) : O(1)
+double max_value() const requires (Aug::template has<PrefixMax>) {
+    return root ? std::max(0.0, root->prefixMax) : 0.0;
+}
 
-        double delta_diff = diff - yi_prec;
-        std::cout << "yi+1 = " << diff
-                  << " | yi = " << yi_prec << "\n";
-        yi_prec = diff;
+double min_value() const requires (Aug::template has<PrefixMin>) {
+    return root ? std::min(0.0, root->prefixMin) : 0.0;
+}
 
-        Node* match = search(root, DeltaPoint{x, 0.0});
-        if (match) {
-            ops.push_back({Operation::Update, x, delta_diff});
+// k-ième point (x, deltaY), k à partir de 0 ; std::out_of_range si k >= size()
+std::pair<double, double> kth(size_t k) const requires (Aug::template has<Count>) {
+    if (!root || k >= root->count) throw std::out_of_range("RedBlackTree::kth");
+    Node* n = root;
+    for (;;) {
+        size_t l = n->left ? n->left->count : 0;
+        if (k < l) {
+            n = n->left;
+        } else if (k == l) {
+            return {n->data.x, n->data.deltaY};
         } else {
-            ops.push_back({Operation::Insert, x, delta_diff});
+            k -= l + 1;
+            n = n->right;
         }
-
-        if (take_g) i++;
-        if (take_f) j++;
-    }
-
-    // --- Phase 2 : traiter le dernier noeud ---
-    std::cout << "=== Handling last node ===\n";
-    Node* left = nullptr;
-    Node* right = nullptr;
-    findBoundingNodes(root, xg_max+0.01, left, right);
-
-    if (right) {
-        double xright = right->data.x;
-        double F = f.eval(xright);
-        double G = g.eval(xright);
-        std::cout << " F = " << F << " G = " << G << "\n";
-        double diff = F - G;
-        std::cout << "yprev  = " << yi_prec << "\n";
-        std::cout << "y  = " << diff << "\n";
-        double delta_diff = diff - yi_prec;
-        right->data.deltaY = delta_diff;
-        std::cout << "Updated right node: x = " << right->data.x 
-                  << ", new deltaY = " << right->data.deltaY << "\n";
     }
+}
 
-    // --- Phase 3 : appliquer les opérations ---
-    std::cout << "=== Applying operations ===\n";
-    for (auto& op : ops) {
-        if (op.type == Operation::Insert) {
-            this->insert({op.x, op.delta});
-            std::cout << "Inserted node: x = " << op.x 
-                      << ", deltaY = " << op.delta << "\n";
+// Nombre de points d'abscisse <= x
+size_t rank(double x) const requires (Aug::template has<Count>) {
+    size_t r = 0;
+    for (Node* n = root; n;) {
+        if (n->data.x > x) {
+            n = n->left;
         } else {
-            Node* match = search(root, DeltaPoint{op.x, 0.0});
-            if (match) {
-                match->data.deltaY = op.delta;
-                std::cout << "Updated node: x = " << op.x 
-                          << ", new deltaY = " << op.delta << "\n";
-            }
+            r += 1 + (n->left ? n->left->count : 0);
+            n = n->right;
         }
     }
-
-    std::cout << "=== Minus completed ===\n";
+    return r;
 }
 
-void minus(const RedBlackTree<T>& g){
-    function<void(typename RedBlackTree<T>::Node*)> process = [&](typename RedBlackTree<T>::Node* node) {
-        if (!node) return;
-        process(node->left);
-
-        double x = node->data.x;
-        double deltaG = -node->data.deltaY;
-
-        Node* match = search(root, node->data);
-        std::cout<< "looking for a match !!" << std::endl;
-        if (match) {
-            std::cout<< "match trouve  !!" << std::endl;
-             // Si x existe déjà dans f, on additionne les deltas
-            match->data.deltaY += deltaG;
-        } else {
-            // x n'existe pas dans f, calculer deltaF à x
-            std::cout<< "node not matched !!" << std::endl;
-            double y = this->eval(x);
-            std::cout<< "node not matched a !!" << std::endl;
-            
-            // Trouver le dernier point de f avant x (i.e., x_prev)
-            Node* left = nullptr;
-            Node* right = nullptr;
-            findBoundingNodes(root, x, left, right);
-            std::cout<< "node not matched b !!" << std::endl;
-
-            double yPrev = left ? this->eval(left->data.x) : 0.0;
-            std::cout<< "node not matched c !!" << std::endl;
-            double deltaF = y - yPrev;
-            std::cout<< " eval f = " << y << std::endl;
-            std::cout<< " new delta  = " << y -yPrev << std::endl;
-            
-            double delta_sum =  deltaF + deltaG ;
-
-            this->insert({x, delta_sum});
-            if(right) right->data.deltaY -= delta_sum ; //update delta of next point
-            std::cout<< "node not matched d !!" << std::endl;
-        }
+//================================================================================================================
+//====================================== Forme et mémoire ========================================================
+//================================================================================================================
 
-        process(node->right);
-    };
+// Taille, hauteur, hauteur noire, profondeur moyenne, octets sur le tas et tailles des sous-arbres, en O(n) :
+// parcours en largeur (parent et profondeur de chaque noeud), puis tailles des sous-arbres en remontant.
+ProfileStats stats() const {
+    ProfileStats s;
+    if (!root) return s;
+
+    struct Item { Node* node; size_t parent; size_t depth; };
+    std::vector<Item> order{{root, 0, 0}};
+    order.reserve(64);
+    size_t depthSum = 0;
+    for (size_t i = 0; i < order.size(); ++i) {
+        Item it = order[i];
+        depthSum += it.depth;
+        s.height = std::max(s.height, it.depth + 1);
+        if (it.node->left) order.push_back({it.node->left, i, it.depth + 1});
+        if (it.node->right) order.push_back({it.node->right, i, it.depth + 1});
+    }
 
-    process(g.root);
-}
+    std::vector<size_t> sizes(order.size(), 1);
+    for (size_t i = order.size(); i-- > 1;) sizes[order[i].parent] += sizes[i];
+    for (size_t n : sizes) s.addSubtree(n);
 
-void negate(){
-    function<void(Node*)> inorder = [&](Node* node) {
-        if (!node) return;
-        inorder(node->left);
-        node->data.deltaY = -node->data.deltaY;
-        inorder(node->right);
-    };
+    for (Node* n = root; n; n = n->left)
+        if (n->color == BLACK) ++s.blackHeight;
 
-    inorder(root);
+    s.nodes = order.size();
+    s.avgDepth = double(depthSum) / double(s.nodes);
+    s.bytes = s.nodes * heap_block_bytes(sizeof(Node));
+    s.payloadBytes = s.nodes * sizeof(T);
+    return s;
 }
 
+// //================================================================================================================
+//====================================== Fusion générique f op g (zip) ===========================================
+//================================================================================================================
 
-
-void minfunction(double c){
-
-    // === Étape 1 : gérer le noeud x = 0.0 ===
-    DeltaPoint zeroPt;
-    zeroPt.deltaY = 0;
-    zeroPt.x = 0;
-    double y_prev = 0;
-    Node* zeroNode = search(root, zeroPt);
-
-    if (zeroNode) {
-        y_prev  =  zeroNode->data.deltaY;
-        if (zeroNode->data.deltaY > c)  zeroNode->data.deltaY = c;
-    } else {
-
-        y_prev  = 0;
-        double y0 = (c < 0) ? c : 0; // règle pour le delta initial
-        this->insert({0.0, y0});
-        zeroNode = search(root, zeroPt); // on le récupère après insertion
+// Parcours des points (x, deltaY) dans l'ordre croissant, sans copie : source du moteur de fusion
+struct Cursor {
+    Node* node;
+    bool next(double& x, double& d) {
+        if (!node) return false;
+        x = node->data.x;
+        d = node->data.deltaY;
+        node = successor(node);
+        return true;
     }
+};
 
+Cursor cursor() const {
+    Node* node = root;
+    while (node && node->left) node = node->left;
+    return Cursor{node};
+}
 
-    double xprev = zeroNode->data.x;
-    cout<< xprev << endl;
-    // Trouver le dernier point de f avant x (i.e., x_prev)
-
-    // === Trouver le nœud suivant (qui est apres x = 0.0) et le mettre a jour ===
-    Node* right = successor(zeroNode);
-    //cout << "fist case zero node Visiting(current) x=" << right->data.x << ", deltaY=" << right->data.deltaY << ", currentY=" << this->eval_in(right->data.x)<< endl;
-
-    if(right){                        
-                bool prevabove = y_prev  > c ;
-                double x_current = right->data.x;
-                double y_current = y_prev + right->data.deltaY;
-                bool currunder =  y_current < c ;
-                cout << "fist case zero node Visiting(current) x=" << right->data.x << ", deltaY=" << right->data.deltaY << ", currentY=" << y_current<< endl;
-            //   cout << "Prev x=" << prevX << ", prevY=" << prevY<<  endl;
-
-                // Traversée de c ?
-                if ((prevabove && currunder)) {
-                    cout << "coupure found first node case" <<  endl;
-
-
-                    // Interpolation pour trouver l'intersection
-                    double t = (c - y_prev) / (y_current - y_prev);
-                    double xi = xprev + t * (x_current - xprev);
-                    double deltaAtXi =  0;
-                // cout << "Point de coupure x=" << xi << ", deltaXi=" <<deltaAtXi << endl;
-                    this->insert({xi, deltaAtXi});
-
-                    // Ajuster delta du nœud actuel
-                    double remainingDelta = y_current - c;
-                    right->data.deltaY = remainingDelta; 
-
-                }else{
-                    // Ajuster delta du nœud actuel
-                    cout << "pas de coupure" << endl;
-                    double newDelta = y_current - zeroNode->data.deltaY ;
-                    right->data.deltaY = newDelta ; 
-                }
-
-
-
+// r = op(f, g) dans un nouvel arbre, en O(n + m) (voir zip_deltas dans piecewise_core.cpp)
+template <typename Op, typename Switch = SwitchFG>
+RedBlackTree zip(const RedBlackTree& g, Op op, Switch sw = Switch()) const {
+    RedBlackTree r;
+    r.assignPoints(zip_deltas<Interp>(cursor(), g.cursor(), op, sw));
+    return r;
+}
 
-                } else { cout << " right n'a pas ete trouve , on est dans la merde gros" << endl;}
+// f = op(f, g) en place
+template <typename Op, typename Switch = SwitchFG>
+void zip_inplace(const RedBlackTree& g, Op op, Switch sw = Switch()) {
+    assignPoints(zip_deltas<Interp>(cursor(), g.cursor(), op, sw));
+    if (autoNormalize) normalize();
+}
 
+// Addition de deux fonctions
+void sum(const RedBlackTree& g) {
+    RecordCall<> rec(this, RecordOp::Sum, {}, &g);
+    OpTimer<MetricOp::Sum> timer;
+    metric<MetricCounter::Sums>();
+    if (!g.root) return;
+    zip_inplace(g, OpPlus(), NoSwitch());
+}
 
-   // === Commencer l'algo de la fonction min ===
-    vector<Node*> toDelete;
-    vector<DeltaPoint> toInsert;
-    cout << "minfunction execution starts here"<< endl;
-    Node* prevNode = nullptr;
-    double prevX = 0.0;
-    double prevY = 0.0;
-    double currentY = 0.0;
+// Soustraction de deux fonctions (f - g)
+void minus(const RedBlackTree& g) {
+    RecordCall<> rec(this, RecordOp::Minus, {}, &g);
+    OpTimer<MetricOp::Sum> timer;
+    metric<MetricCounter::Sums>();
+    if (!g.root) return;
+    zip_inplace(g, OpMinus(), NoSwitch());
+}
 
-    function<void(Node*)> inorder = [&](Node* node) {
-        if (!node) return;
-        inorder(node->left);
+// f += a * g en une seule fusion, g reste intact (remplace g.negate(); f.sum(g) pour a = -1)
+void add_scaled(const RedBlackTree& g, double a) {
+    RecordCall<> rec(this, RecordOp::AddScaled, {a}, &g);
+    OpTimer<MetricOp::Sum> timer;
+    metric<MetricCounter::Sums>();
+    if (!g.root) return;
+    zip_inplace(g, OpAxpy{a}, NoSwitch());
+}
 
-        double x = node->data.x;
-        currentY += node->data.deltaY;
+// f = clamp(f + g, lo, hi) en une seule fusion, avec les points de coupure sur lo et hi (lo <= 0 <= hi)
+void add_clamped(const RedBlackTree& g, double lo, double hi) {
+    RecordCall<> rec(this, RecordOp::AddClamped, {lo, hi}, &g);
+    OpTimer<MetricOp::Clamp> timer;
+    metric<MetricCounter::Clamps>();
+    zip_inplace(g, OpAddClamp{lo, hi}, SwitchAddClamp{lo, hi});
+}
 
-        if (prevNode) {
-            bool prevAbove = prevY > c ;
-            bool currAbove = currentY > c ;
-            bool prevUnder = prevY < c ;
-            bool currUnder  = currentY < c ;
+// f += w * g sur place, en ne touchant que les points de f dans le support de g : O((m + k) log n)
+// pour m points dans g et k points de f sur ce support. Même résultat que add_scaled(g, w).
+// g peut avoir d'autres augmentations (les deltas CBR sont des RedBlackTree<DeltaPoint>).
+// En escalier, les points de g sont des sauts : chacun s'ajoute au point de même abscisse, O(m log n).
+template <typename G, typename I>
+void apply_delta(const RedBlackTree<T, G, I>& g, double w = 1.0) {
+    RecordCall<> rec(this, RecordOp::ApplyDelta, {w}, &g);
+    OpTimer<MetricOp::ApplyDelta> timer;
+    std::vector<std::pair<double, double>> pts = g.to_points_delta();
+    metric<MetricCounter::BreakpointsTouched>(pts.size());
+    if constexpr (Interp::step) {
+        for (const auto& [x, d] : pts) {
+            if (d == 0.0) continue;
+            Node* n = lowerBound(x);
+            if (n && n->data.x == x) {
+                n->data.deltaY += w * d;
+                pullUp(n);
+            } else {
+                insertNode(T{x, w * d});
+            }
+        }
+        if (autoNormalize && !pts.empty()) normalize(pts.front().first, pts.back().first);
+        return;
+    }
+    auto [lo, hi] = delta_support(pts);
+    if (lo == hi) return;
+    for (size_t i = lo; i < hi; ++i) splitAt(pts[i].first);
+    Node* cur = nullptr;
+    std::vector<Node*> touched; // noeuds modifiés, pour les augmentations
+    spread_delta(pts, lo, hi, w, [&]() {
+        cur = cur ? successor(cur) : lowerBound(pts[lo].first);
+        if constexpr (Aug::active) touched.push_back(cur);
+        return std::make_pair(cur->data.x, &cur->data.deltaY);
+    });
+    for (Node* n : touched) pullUp(n);
+    if (autoNormalize) normalize(pts[lo].first, pts[hi - 1].first);
+}
 
-            cout << "Visiting(current) x=" << node->data.x << ", deltaY=" << node->data.deltaY << ", currentY=" << currentY << endl;
-            cout << "Prev x=" << prevX << ", prevY=" << prevY<<  endl;
+// Enveloppes supérieure max_k f_k et inférieure min_k f_k de K fonctions (balayage avec croisements)
+static RedBlackTree envelope_max(std::span<const RedBlackTree*> fs) {
+    return envelope(fs, true);
+}
 
-            // Traversée de c ?
-            if ((prevAbove && currUnder) || (prevUnder && currAbove)) {
-                cout << "coupure found" <<  endl;
+static RedBlackTree envelope_min(std::span<const RedBlackTree*> fs) {
+    return envelope(fs, false);
+}
 
-                // Interpolation pour trouver l'intersection
-                double t = (c - prevY) / (currentY - prevY);
-                double xi = prevX + t * (x - prevX);
-                double deltaAtXi = (prevY >= c)? 0 : c - prevY;
-                cout << "Point de coupure x=" << xi << ", deltaXi=" <<deltaAtXi << endl;
-                toInsert.push_back({xi, deltaAtXi});
-               // this->insert({xi, deltaAtXi});
+static RedBlackTree envelope(std::span<const RedBlackTree*> fs, bool upper) {
+    std::vector<Cursor> srcs;
+    srcs.reserve(fs.size());
+    for (const RedBlackTree* f : fs) srcs.push_back(f->cursor());
+    RedBlackTree r;
+    r.assignPoints(envelope_deltas<Interp>(srcs, upper));
+    return r;
+}
 
+// Somme pondérée de K fonctions (weights vide = poids 1) en un seul balayage k-way, O(N log K)
+static RedBlackTree sum_all(std::span<const RedBlackTree*> fs, std::span<const double> weights = {}) {
+    std::vector<Cursor> srcs;
+    srcs.reserve(fs.size());
+    for (const RedBlackTree* f : fs) srcs.push_back(f->cursor());
+    RedBlackTree r;
+    r.assignPoints(sum_all_deltas<Interp>(srcs, std::vector<double>(weights.begin(), weights.end())));
+    return r;
+}
 
-                if ((prevAbove && currUnder)) {
-                    // Ajuster delta du nœud actuel
-                    double remainingDelta = currentY - c;
-                    node->data.deltaY = remainingDelta;
-                    currentY = c + remainingDelta; }
+void negate(){
+    RecordCall<> rec(this, RecordOp::Negate);
+    negateSubtree(root);
+}
 
-            }
 
 
-        // Traversée de c ?
-        if ((prevAbove && currentY == c)) {
-            cout << "coupure found : breakpoint on c " <<  endl;
-                // Ajuster delta du nœud actuel
-                node->data.deltaY = 0;
-                currentY = c ;
-   
-                     }
-        }
+// f + g, f - g et -f par valeur. Un opérande temporaire sert de résultat : ses noeuds sont réutilisés
+// par la fusion en place au lieu d'allouer (ou de cloner) un nouvel arbre.
+friend RedBlackTree operator+(const RedBlackTree& f, const RedBlackTree& g) { return f.zip(g, OpPlus(), NoSwitch()); }
+friend RedBlackTree operator+(RedBlackTree&& f, const RedBlackTree& g) { f.sum(g); return std::move(f); }
+friend RedBlackTree operator+(const RedBlackTree& f, RedBlackTree&& g) { g.sum(f); return std::move(g); }
+friend RedBlackTree operator+(RedBlackTree&& f, RedBlackTree&& g) { f.sum(g); return std::move(f); }
 
-        // Marquer les nœuds au-dessus de c pour suppression
-        if (currentY > c ) {
-            cout << " deletion to be done for " << "node : ("<< node->data.x <<" , "<< node->data.deltaY<< ")"<< endl;
-            toDelete.push_back(node);
-        }
-        cout << "Hello "  << endl;
-        prevNode = node;
-        prevX = x;
-        prevY = currentY;
+friend RedBlackTree operator-(const RedBlackTree& f, const RedBlackTree& g) { return f.zip(g, OpMinus(), NoSwitch()); }
+friend RedBlackTree operator-(RedBlackTree&& f, const RedBlackTree& g) { f.minus(g); return std::move(f); }
+friend RedBlackTree operator-(const RedBlackTree& f, RedBlackTree&& g) { g.negate(); g.sum(f); return std::move(g); }
+friend RedBlackTree operator-(RedBlackTree&& f, RedBlackTree&& g) { f.minus(g); return std::move(f); }
 
-        inorder(node->right);
-    };
+friend RedBlackTree operator-(const RedBlackTree& f) {
+    RedBlackTree r;
+    r.autoNormalize = f.autoNormalize;
+    r.root = r.cloneTree(f.root);
+    r.negate();
+    return r;
+}
+friend RedBlackTree operator-(RedBlackTree&& f) { f.negate(); return std::move(f); }
+
+// min(f, c) : la constante c est définie à partir de x = 0
+void minfunction(double c) {
+    RecordCall<> rec(this, RecordOp::MinConst, {c});
+    OpTimer<MetricOp::MinMax> timer;
+    std::vector<std::pair<double, double>> cst{{0.0, c}};
+    assignPoints(zip_deltas<Interp>(cursor(), VectorSource{&cst}, OpMin(), SwitchFG()));
+    if (autoNormalize) normalize();
+}
 
-    inorder(root);
+// min(f, g) point par point, croisements inclus
+void minfunction(const RedBlackTree& g) {
+    RecordCall<> rec(this, RecordOp::MinFunction, {}, &g);
+    OpTimer<MetricOp::MinMax> timer;
+    zip_inplace(g, OpMin());
+}
 
 
-    if (!toInsert.empty()){
-       for (auto& pt : toInsert) {
-        insert(pt);  // Fait après le parcours, évite corruption
-    }
-    }
-    cout << "How are you "  << endl;
-    // Supprimer les nœuds après le parcours 
-    if (!toDelete.empty()) {
-        for (Node* node : toDelete) {
-            remove(node->data);
-        }
-    }
+// // max(f, c) : la constante c est définie à partir de x = 0
+void maxfunction(double c) {
+    RecordCall<> rec(this, RecordOp::MaxConst, {c});
+    OpTimer<MetricOp::MinMax> timer;
+    std::vector<std::pair<double, double>> cst{{0.0, c}};
+    assignPoints(zip_deltas<Interp>(cursor(), VectorSource{&cst}, OpMax(), SwitchFG()));
+    if (autoNormalize) normalize();
 }
 
+// max(f, g) point par point, croisements inclus
+void maxfunction(const RedBlackTree& g) {
+    RecordCall<> rec(this, RecordOp::MaxFunction, {}, &g);
+    OpTimer<MetricOp::MinMax> timer;
+    zip_inplace(g, OpMax());
+}
 
-// void maxfunction(double c) {
-//     cout << "=== Début maxfunction avec c=" << c << " ===" << endl;
+// max(f, c) et min(f, c) dans un nouvel arbre, construit directement par la fusion (pas de copie de f)
+RedBlackTree maxWithC(double c) const {
+    std::vector<std::pair<double, double>> cst{{0.0, c}};
+    RedBlackTree r;
+    r.autoNormalize = autoNormalize;
+    r.assignPoints(zip_deltas<Interp>(cursor(), VectorSource{&cst}, OpMax(), SwitchFG()));
+    if (autoNormalize) r.normalize();
+    return r;
+}
 
-//     // === Étape 1 : gérer le noeud x = 0.0 ===
-//     DeltaPoint zeroPt;
-//     zeroPt.deltaY = 0;
-//     zeroPt.x = 0;
-//     double y_prev = 0;
-//     Node* zeroNode = search(root, zeroPt);
 
-//     if (zeroNode) {
-//         cout << "Noeud x=0 trouvé: deltaY=" << zeroNode->data.deltaY << endl;
-//         y_prev = zeroNode->data.deltaY;
-//         if (zeroNode->data.deltaY < c) {
-//             cout << "Mise à jour deltaY du noeud x=0 de " << zeroNode->data.deltaY << " vers " << c << endl;
-//             zeroNode->data.deltaY = c;
-//         }
-//     } else {
-//         cout << "Noeud x=0 introuvable, insertion..." << endl;
-//         y_prev = 0;
-//         double y0 = (c > 0) ? c : 0; // règle pour le delta initial
-//         cout << "Insertion de (0, " << y0 << ")" << endl;
-//         this->insert({0.0, y0});
-//         zeroNode = search(root, zeroPt);
-//     }
+RedBlackTree minWithC(double c) const {
+    std::vector<std::pair<double, double>> cst{{0.0, c}};
+    RedBlackTree r;
+    r.autoNormalize = autoNormalize;
+    r.assignPoints(zip_deltas<Interp>(cursor(), VectorSource{&cst}, OpMin(), SwitchFG()));
+    if (autoNormalize) r.normalize();
+    return r;
+}
 
-//     double xprev = zeroNode->data.x;
-//     Node* right = successor(zeroNode);
-
-//     if (right) {
-//         cout << "Successeur de x=0 : x=" << right->data.x << ", deltaY=" << right->data.deltaY << endl;
-//         bool prevBelow = y_prev < c;
-//         double x_current = right->data.x;
-//         double y_current = y_prev + right->data.deltaY;
-//         bool currAbove = y_current > c;
-
-//         cout << "prevBelow=" << prevBelow << ", currAbove=" << currAbove
-//              << ", y_prev=" << y_prev << ", y_current=" << y_current << endl;
-
-//         if ((prevBelow && currAbove)) {
-//             cout << "Coupure détectée entre x=" << xprev << " et x=" << x_current << endl;
-//             double t = (c - y_prev) / (y_current - y_prev);
-//             double xi = xprev + t * (x_current - xprev);
-//             cout << "Interpolation: t=" << t << ", xi=" << xi << endl;
-//             double deltaAtXi = 0;
-//             this->insert({xi, deltaAtXi});
-//             cout << "Insertion du point d'intersection (" << xi << ", " << deltaAtXi << ")" << endl;
-//             double remainingDelta = y_current - c;
-//             right->data.deltaY = remainingDelta;
-//             cout << "Mise à jour deltaY du successeur vers " << remainingDelta << endl;
-//         } else {
-//             double newDelta = y_current - zeroNode->data.deltaY;
-//             cout << "Pas de coupure, mise à jour deltaY du successeur vers " << newDelta << endl;
-//             right->data.deltaY = newDelta;
-//         }
-//     } else {
-//         cout << "Pas de successeur trouvé pour x=0" << endl;
-//     }
-    
-//     this->printTree();
-//     // === Algo principal ===
-//     cout << "=== Parcours infixe de l'arbre ===" << endl;
-//     vector<DeltaPoint> toDeleteValues;
-//     vector<DeltaPoint> toInsert;
-//     Node* prevNode = nullptr;
-//     double prevX = 0.0;
-//     double prevY = 0.0;
-//     double currentY = 0.0;
-
-//     function<void(Node*)> inorder = [&](Node* node) {
-//         if (!node) return;
-//         inorder(node->left);
-          
-//         double x = node->data.x;
-//         currentY += node->data.deltaY;
-//         this->printTree();
-//         cout << "Visite: x=" << x << ", deltaY=" << node->data.deltaY
-//              << ", currentY=" << currentY << endl;
-
-//         if (prevNode) {
-//             bool prevBelow = prevY < c;
-//             bool currBelow = currentY < c;
-//             bool prevAbove = prevY > c;
-//             bool currAbove = currentY > c;
-
-//             cout << "   Comparaison: prevBelow=" << prevBelow
-//                  << ", currAbove=" << currAbove
-//                  << ", prevAbove=" << prevAbove
-//                  << ", currBelow=" << currBelow << endl;
-
-//             if ((prevBelow && currAbove) || (prevAbove && currBelow)) {
-//                 cout << "   ↳ Coupure détectée entre x=" << prevX << " et x=" << x << endl;
-//                 double t = (c - prevY) / (currentY - prevY);
-//                 double xi = roundToMilli(prevX + t * (x - prevX));
-//                 double deltaAtXi = (prevY <= c) ? 0 : c - prevY;
-//                 cout << "     Interpolation: t=" << t << ", xi=" << xi
-//                      << ", deltaAtXi=" << deltaAtXi << endl;
-//                 toInsert.push_back({xi, deltaAtXi});
-
-//                 if (prevBelow && currAbove) {
-//                     double remainingDelta = currentY - c;
-//                     node->data.deltaY = remainingDelta;
-//                     cout << "     Mise à jour deltaY du noeud courant vers " << remainingDelta << endl;
-//                 }
-//             }
-
-//             if (prevBelow && currentY == c) {
-//                 cout << "   ↳ Plateau à c détecté, mise à zéro deltaY du noeud" << endl;
-//                 node->data.deltaY = 0;
-//                 currentY = c;
-//             }
-//         }
-
-//         if (currentY < c) {
-//             cout << "   ↳ Marquage pour suppression: (" << node->data.x << ", " << node->data.deltaY << ")" << endl;
-//             toDeleteValues.push_back(node->data);
-//         }
-
-//         prevNode = node;
-//         prevX = x;
-//         prevY = currentY;
-
-//         inorder(node->right);
-//     };
-
-//     inorder(root);
-
-//     cout << "=== Suppression des noeuds marqués ===" << endl;
-//     for (auto& val : toDeleteValues) {
-//         cout << "Suppression: (" << val.x << ", " << val.deltaY << ")" << endl;
-//         remove(val);
-//     }
 
+bool isLessOrEqual(const RedBlackTree& g) const {
+    // f et g sont linéaires entre deux abscisses consécutives de l'union : il suffit de comparer en ces points
+    bool result = true;
+    merge_walk<Interp>(cursor(), g.cursor(), [&](double, double F, double G) {
+        if (F > G + COLLINEAR_TOL * std::max(1.0, std::fabs(G))) result = false; // g(x) < f(x), aux arrondis près
+        return result;
+    });
+    return result;
+}
 
-//     cout << "=== Insertion des points détectés ===" << endl;
-//     for (auto& pt : toInsert) {
-//         cout << "Insertion: (" << pt.x << ", " << pt.deltaY << ")" << endl;
-//         insert(pt);
-//     }
+//================================================================================================================
+//====================================== Normalisation : points redondants =======================================
+//================================================================================================================
 
+// Active la normalisation automatique après chaque sum/minus/minfunction/maxfunction
+void setAutoNormalize(bool on) {
+    RecordCall<> rec(this, RecordOp::AutoNormalize, {on ? 1.0 : 0.0});
+    autoNormalize = on;
+}
 
-//     cout << "=== Fin maxfunction ===" << endl;
-// }
+// Supprime les points qui ne changent pas la fonction :
+//  - points à moins de EPSILON l'un de l'autre, fusionnés dans le premier si f bouge de moins de tol,
+//  - points intérieurs alignés avec leurs deux voisins,
+//  - premier point sans saut suivi d'un segment plat, dernier point au bout d'un segment plat,
+//  - en escalier (Step) : tout point sans saut.
+// Le deltaY d'un point retiré est reporté sur son successeur : les valeurs aux points gardés sont exactes
+// (à tol près après une fusion).
+// Retourne le nombre de noeuds supprimés.
+size_t normalize(double tol = COLLINEAR_TOL) {
+    return normalize(-numeric_limits<double>::infinity(), numeric_limits<double>::infinity(), tol);
+}
 
-void maxfunction(double c) {
-    // === Étape 1 : gérer le noeud x = 0.0 ===
-    DeltaPoint zeroPt;
-    zeroPt.deltaY = 0;
-    zeroPt.x = 0;
-    double y_prev = 0;
-    Node* zeroNode = search(root, zeroPt);
-
-    if (zeroNode) {
-        y_prev = zeroNode->data.deltaY;
-        if (zeroNode->data.deltaY < c) zeroNode->data.deltaY = c;
-    } else {
-        y_prev = 0;
-        double y0 = (c > 0) ? c : 0; // règle pour le delta initial
-        this->insert({0.0, y0});
-        zeroNode = search(root, zeroPt);
+// Version locale : on n'examine que les points de [xmin, xmax] et leurs deux voisins
+size_t normalize(double xmin, double xmax, double tol = COLLINEAR_TOL) {
+    RecordCall<> rec(this, RecordOp::Normalize, {xmin, xmax, tol});
+    OpTimer<MetricOp::Normalize> timer;
+    size_t removed = 0;
+
+    Node* cur = lowerBound(xmin);
+    if (cur) {
+        if (Node* p = predecessor(cur)) cur = p;
+    } else if (root) {
+        cur = root;
+        while (cur->right) cur = cur->right;
     }
 
-    double xprev = zeroNode->data.x;
-    Node* right = successor(zeroNode);
-
-    if (right) {
-        bool prevBelow = y_prev < c;
-        double x_current = right->data.x;
-        double y_current = y_prev + right->data.deltaY;
-        bool currAbove = y_current > c;
-
-        if ((prevBelow && currAbove)) {
-            double t = (c - y_prev) / (y_current - y_prev);
-            double xi = xprev + t * (x_current - xprev);
-            double deltaAtXi = 0;
-            this->insert({xi, deltaAtXi});
-            double remainingDelta = y_current - c;
-            right->data.deltaY = remainingDelta;
-        } else {
-            double newDelta = y_current - zeroNode->data.deltaY;
-            right->data.deltaY = newDelta;
+    while (cur) {
+        Node* prev = predecessor(cur);
+        Node* next = successor(cur);
+
+        Node* after = next ? successor(next) : nullptr;
+        if (next && is_fusable(cur->data.x, next->data.x, next->data.deltaY,
+                               after ? after->data.x : numeric_limits<double>::infinity(),
+                               after && !Interp::step ? after->data.deltaY : 0.0, EPSILON, tol)) {
+            cur->data.deltaY += next->data.deltaY;
+            pullUp(cur);
+            deleteNode(next);
+            ++removed;
+            continue; // cur a un nouveau voisin, on le réexamine
         }
-    }
-
-    // === Algo principal ===
-    vector<Node*> toDelete;
-    vector<DeltaPoint> toInsert;
-    Node* prevNode = nullptr;
-    double prevX = 0.0;
-    double prevY = 0.0;
-    double currentY = 0.0;
-
-    function<void(Node*)> inorder = [&](Node* node) {
-        if (!node) return;
-        inorder(node->left);
-
-        double x = node->data.x;
-        currentY += node->data.deltaY;
-
-        if (prevNode) {
-            bool prevBelow = prevY < c;
-            bool currBelow = currentY < c;
-            bool prevAbove = prevY > c;
-            bool currAbove = currentY > c;
-
-            if ((prevBelow && currAbove) || (prevAbove && currBelow)) {
-                double t = (c - prevY) / (currentY - prevY);
-                double xi = prevX + t * (x - prevX);
-                double deltaAtXi = (prevY <= c) ? 0 : c - prevY;
-                toInsert.push_back({xi, deltaAtXi});
-
-                if (prevBelow && currAbove) {
-                    double remainingDelta = currentY - c;
-                    node->data.deltaY = remainingDelta;
-                    currentY = c + remainingDelta;
-                }
-            }
 
-            if (prevBelow && currentY == c) {
-                node->data.deltaY = 0;
-                currentY = c;
+        bool redundant = false;
+        if (Interp::step)
+            redundant = is_redundant_step(cur->data.deltaY, tol);
+        else if (prev && next)
+            redundant = is_collinear(prev->data.x, cur->data.x, cur->data.deltaY,
+                                     next->data.x, next->data.deltaY, tol);
+        else if (next)
+            redundant = is_redundant_first(cur->data.deltaY, next->data.deltaY, tol);
+        else if (prev)
+            redundant = is_redundant_last(cur->data.deltaY, tol);
+
+        bool pastRange = cur->data.x > xmax;
+        if (redundant) {
+            if (next) {
+                next->data.deltaY += cur->data.deltaY;
+                pullUp(next);
             }
+            deleteNode(cur);
+            ++removed;
         }
-
-        if (currentY < c) {
-            toDelete.push_back(node);
-        }
-
-        prevNode = node;
-        prevX = x;
-        prevY = currentY;
-
-        inorder(node->right);
-    };
-
-    inorder(root);
-
-
-    for (Node* node : toDelete) {
-        remove(node->data);
+        if (pastRange) break;
+        cur = next;
     }
-    for (auto& pt : toInsert) {
-        insert(pt);
-    }
-
-}
-
-RedBlackTree<DeltaPoint> maxWithC(double c) const {
-    RedBlackTree<DeltaPoint> copy;
-    copy = *this;
-    copy.maxfunction(c);
-    return copy;
+    return removed;
 }
 
+//================================================================================================================
+//====================================== Simplification à erreur bornée ==========================================
+//================================================================================================================
 
-RedBlackTree<DeltaPoint> minWithC(double c) const {
-    RedBlackTree<DeltaPoint> copy;
-    copy = *this;
-    copy.minfunction(c);
-    return copy;
+// Approximation linéaire par morceaux avec |g - f| <= max_error partout (sous-ensemble des points de f).
+// Retourne le nombre de noeuds supprimés.
+size_t simplify(double max_error) {
+    return simplifyBand(-max_error, max_error);
 }
 
+// Variante conservative : f <= g <= f + max_error (majorant, pour les tests de capacité)
+size_t simplify_upper(double max_error) {
+    return simplifyBand(0.0, max_error);
+}
 
-bool isLessOrEqual(const RedBlackTree<T>& g) {
-    // On calcule diff = g - f
-    RedBlackTree<DeltaPoint> diff = g;
-    diff.minus(*this);
-
-    bool result = true;
-
-    // Parcours récursif en ordre croissant
-    function<void(typename RedBlackTree<T>::Node*)> checkNode = [&](typename RedBlackTree<T>::Node* node) {
-        if (!node || !result) return; // arrêter si déjà faux
-
-        checkNode(node->left);
-
-        double x = node->data.x;         // on prend la position x du noeud courant
-        double diff_eval = diff.eval(x); // valeur de g(x) - f(x)
-
-        if (diff_eval < 0) {      // si jamais g(x) < f(x)
-            result = false;
-            return; // on arrête
-        }
-
-        checkNode(node->right);
-    };
+// Variante conservative : f - max_error <= g <= f (minorant)
+size_t simplify_lower(double max_error) {
+    return simplifyBand(-max_error, 0.0);
+}
 
-    checkNode(diff.root);
+// Garde au plus max_points points (au moins 2) ; retourne l'erreur L-infini garantie
+double simplify_to(size_t max_points) {
+    double err = simplify_error_for<Interp>(to_points_delta(), max_points);
+    simplify(err); // err = 0 (f constante par exemple) : seuls les points exactement alignés partent
+    return err;
+}
 
-    return result;
+size_t simplifyBand(double lo, double hi) {
+    RecordCall<> rec(this, RecordOp::SimplifyBand, {lo, hi});
+    auto pts = to_points_delta();
+    auto kept = simplify_deltas<Interp>(pts, lo, hi);
+    if (kept.size() == pts.size()) return 0;
+    assignPoints(kept);
+    return pts.size() - kept.size();
 }
 
 //================================================================================================================
@@ -1397,54 +1197,31 @@ bool isLessOrEqual(const RedBlackTree<T>& g) {
 //================================================================================================================
 
 double evaluate_max(double t_inf, double t_sup) const {
-    if (!root || t_inf > t_sup) return 0.0;
-    
-    double a = this->eval(t_inf); double b = this->eval(t_sup);
-    double maxVal = std::max(a, b); // bornes
-
-    // parcours infixe de l'arbre
-    function<void(Node*)> inorder = [&](Node* node) {
-        if (!node) return;
-        inorder(node->left);
-
-        double x = node->data.x;
-        if (x >= t_inf  && x <= t_sup ) {
-            double val = this->eval(x);
-            if (val > maxVal) maxVal = val;
-        }
-
-        inorder(node->right);
-    };
-
-    inorder(root);
-
-    return maxVal;
+    return extremum_on(t_inf, t_sup, [](double a, double b) { return std::max(a, b); });
 }
 
 
 double evaluate_min(double t_inf, double t_sup) const {
-    if (!root || t_inf > t_sup) return 0.0;
-    
-    double a = this->eval(t_inf); double b = this->eval(t_sup);
-    double minVal = std::min(a, b); // bornes
-
-    // parcours infixe de l'arbre
-    function<void(Node*)> inorder = [&](Node* node) {
-        if (!node) return;
-        inorder(node->left);
-
-        double x = node->data.x;
-        if (x >= t_inf  && x <= t_sup ) {
-            double val = this->eval(x);
-            if (val < minVal) minVal = val;
-        }
-
-        inorder(node->right);
-    };
+    return extremum_on(t_inf, t_sup, [](double a, double b) { return std::min(a, b); });
+}
 
-    inorder(root);
+// Extremum de f sur [t_inf, t_sup] : bornes, puis valeurs aux points de l'intervalle. Descente au premier point
+// >= t_inf, f juste avant lui par somme préfixe, puis successeurs jusqu'à t_sup : O(log n + k) pour k points dans
+// la fenêtre avec Augment<SumDelta> (la somme préfixe parcourt l'arbre sans augmentation).
+template <typename Pick>
+double extremum_on(double t_inf, double t_sup, Pick pick) const {
+    if (!root || t_inf > t_sup) return 0.0;
 
-    return minVal;
+    double best = pick(this->eval(t_inf), this->eval(t_sup)); // bornes
+    Node* node = lowerBound(t_inf);
+    if (!node || node->data.x > t_sup) return best;
+    Node* prev = predecessor(node);
+    double y = prev ? sumUpTo(prev->data.x) : 0.0; // f au point courant : somme des deltaY jusqu'à lui
+    for (; node && node->data.x <= t_sup; node = successor(node)) {
+        y += node->data.deltaY;
+        best = pick(best, y);
+    }
+    return best;
 }
 
 
@@ -1453,147 +1230,83 @@ double evaluate_min(double t_inf, double t_sup) const {
 //==================== Update total contribution (min & max) =================
 //============================================================================
 
-void update_cbr_stmin(double stmin_old, double stmin, 
-                                double ctmin, double cap_min, 
-                                double cap_max) 
+// Delta (petit profil en chapeau ou en marche) d'une mise à jour CBR, nul si rien ne change. L'analyse des
+// cas est celle de piecewise_core.cpp (cbr_*_hat), partagée avec la map et le tableau plat.
+static RedBlackTree<DeltaPoint> cbr_stmin_delta(double stmin_old, double stmin,
+                                double ctmin, double cap_min,
+                                double cap_max)
 {
-    double cap = (cap_min > 0) ? cap_max : cap_min;
-
-    if (std::abs(stmin - stmin_old) < 1e-6)
-        return;
-
-    RedBlackTree<DeltaPoint> delta;
-
-    // Case (1)
-    if (stmin_old < stmin && stmin < ctmin) {
-        double slope = -cap / (ctmin - stmin_old);
-        double gap = slope * (stmin - stmin_old);
-        delta = delta_profile(gap, stmin_old, stmin, ctmin);
-    }
-    // Case (2)
-    else if (stmin_old <= ctmin && ctmin < stmin) {
-        double gap = -cap;
-        delta = delta_profile(gap, stmin_old, ctmin, stmin);
-    }
-    // Case (3)
-    else if (ctmin < stmin_old && stmin_old < stmin) {
-        double slope = -cap / (ctmin - stmin);
-        double gap = slope * (stmin_old - stmin);
-        delta = delta_profile(gap, ctmin, stmin_old, stmin);
-    }
-
-    this->sum(delta);
+    return hat_delta(cbr_stmin_hat(stmin_old, stmin, ctmin, cap_min, cap_max, CBR_TOL));
 }
 
 
-void update_cbr_ctmin(double ctmin_old, double ctmin,
+static RedBlackTree<DeltaPoint> cbr_ctmin_delta(double ctmin_old, double ctmin,
                                 double stmin, double cap_min,
-                                double cap_max) 
+                                double cap_max)
 {
-    double cap = (cap_min > 0) ? cap_max : cap_min;
-
-    if (std::abs(ctmin - ctmin_old) < 1e-6)
-        return;
-
-    RedBlackTree<DeltaPoint> delta;
-
-    // Case (4)
-    if (stmin < ctmin_old && ctmin_old < ctmin) {
-        double slope = -cap / (ctmin - stmin);
-        double gap = slope * (ctmin - ctmin_old);
-        delta = delta_profile(gap, stmin, ctmin_old, ctmin);
-    }
-    // Case (5)
-    else if (ctmin_old <= stmin && stmin < ctmin) {
-        double gap = -cap;
-        delta = delta_profile(gap, ctmin_old, stmin, ctmin);
-    }
-    // Case (6)
-    else if (ctmin_old < ctmin && ctmin < stmin) {
-        double slope = -cap / (ctmin_old - stmin);
-        double gap = slope * (ctmin_old - ctmin);
-        delta = delta_profile(gap, ctmin_old, ctmin, stmin);
-    }
-
-    this->sum(delta);
+    return hat_delta(cbr_ctmin_hat(ctmin_old, ctmin, stmin, cap_min, cap_max, CBR_TOL));
 }
 
 
-void update_cbr_stmax(double stmax_old, double stmax,
+static RedBlackTree<DeltaPoint> cbr_stmax_delta(double stmax_old, double stmax,
                             double ctmax, double cap_min,
-                            double cap_max) 
+                            double cap_max)
 {
-    double cap = (cap_min > 0) ? cap_min : cap_max;
+    return hat_delta(cbr_stmax_hat(stmax_old, stmax, ctmax, cap_min, cap_max, CBR_TOL));
+}
 
-    if (std::abs(stmax - stmax_old) < 1e-6)
-        return;
 
-    RedBlackTree<DeltaPoint> delta;
+static RedBlackTree<DeltaPoint> cbr_ctmax_delta(double ctmax_old, double ctmax,
+                                double stmax, double cap_min,
+                                double cap_max)
+{
+    return hat_delta(cbr_ctmax_hat(ctmax_old, ctmax, stmax, cap_min, cap_max, CBR_TOL));
+}
 
-    // Case (7)
-    if (stmax < stmax_old && stmax_old < ctmax) {
-        double slope = cap / (ctmax - stmax);
-        double gap = slope * (stmax_old - stmax);
-        delta = delta_profile(gap, stmax, stmax_old, ctmax);
-    }
-    // Case (8)
-    else if (stmax <= ctmax && ctmax < stmax_old) {
-        double gap = cap;
-        delta = delta_profile(gap, stmax, ctmax, stmax_old);
-    }
-    // Case (9)
-    else if (ctmax < stmax && stmax < stmax_old) {
-        double slope = cap / (ctmax - stmax_old);
-        double gap = slope * (stmax - stmax_old);
-        delta = delta_profile(gap, ctmax, stmax, stmax_old);
-    }
 
-    this->sum(delta);
+static RedBlackTree<DeltaPoint> hat_delta(const CbrHat& h)
+{
+    return h.active ? delta_profile(h.gap, h.a, h.b, h.c) : RedBlackTree<DeltaPoint>();
 }
 
 
-void update_cbr_ctmax(double ctmax_old, double ctmax,
-                                double stmax, double cap_min,
-                                double cap_max) 
+static RedBlackTree<DeltaPoint> cbr_cap_delta(double cap_old, double cap, double start, double end) 
 {
-    double cap = (cap_min > 0) ? cap_min : cap_max;
-
-    if (std::abs(ctmax - ctmax_old) < 1e-6)
-        return;
+    if (std::abs(cap - cap_old) < CBR_TOL)
+        return {};
 
-    RedBlackTree<DeltaPoint> delta;
+    double gap = cap - cap_old;
+    RedBlackTree<DeltaPoint> delta = cba_profile(gap, start, end);
 
-    // Case (10)
-    if (stmax < ctmax && ctmax < ctmax_old) {
-        double slope = cap / (ctmax_old - stmax);
-        double gap = slope * (ctmax_old - ctmax);
-        delta = delta_profile(gap, stmax, ctmax, ctmax_old);
-    }
-    // Case (11)
-    else if (ctmax <= stmax && stmax < ctmax_old) {
-        double gap = cap;
-        delta = delta_profile(gap, ctmax, stmax, ctmax_old);
-    }
-    // Case (12)
-    else if (ctmax < ctmax_old && ctmax_old < stmax) {
-        double slope = cap / (ctmax - stmax);
-        double gap = slope * (ctmax - ctmax_old);
-        delta = delta_profile(gap, ctmax, ctmax_old, stmax);
-    }
+    return delta;
+}
 
-    this->sum(delta);
+// Les update_cbr_* ajoutent leur delta (petit profil en chapeau ou en marche) sur place, en ne touchant
+// que les points de f dans le support du delta. Les cbr_*_delta le construisent seul, pour le propager
+// à d'autres fonctions (voir ProfileNetwork).
+void update_cbr_stmin(double stmin_old, double stmin, double ctmin, double cap_min, double cap_max) {
+    RecordCall<> rec(this, RecordOp::CbrStMin, {stmin_old, stmin, ctmin, cap_min, cap_max});
+    apply_delta(cbr_stmin_delta(stmin_old, stmin, ctmin, cap_min, cap_max));
 }
 
+void update_cbr_ctmin(double ctmin_old, double ctmin, double stmin, double cap_min, double cap_max) {
+    RecordCall<> rec(this, RecordOp::CbrCtMin, {ctmin_old, ctmin, stmin, cap_min, cap_max});
+    apply_delta(cbr_ctmin_delta(ctmin_old, ctmin, stmin, cap_min, cap_max));
+}
 
-void update_cbr_cap(double cap_old, double cap, double start, double end) 
-{
-    if (std::abs(cap - cap_old) < 1e-6)
-        return;
+void update_cbr_stmax(double stmax_old, double stmax, double ctmax, double cap_min, double cap_max) {
+    RecordCall<> rec(this, RecordOp::CbrStMax, {stmax_old, stmax, ctmax, cap_min, cap_max});
+    apply_delta(cbr_stmax_delta(stmax_old, stmax, ctmax, cap_min, cap_max));
+}
 
-    double gap = cap - cap_old;
-    RedBlackTree<DeltaPoint> delta = cba_profile(gap, start, end);
+void update_cbr_ctmax(double ctmax_old, double ctmax, double stmax, double cap_min, double cap_max) {
+    RecordCall<> rec(this, RecordOp::CbrCtMax, {ctmax_old, ctmax, stmax, cap_min, cap_max});
+    apply_delta(cbr_ctmax_delta(ctmax_old, ctmax, stmax, cap_min, cap_max));
+}
 
-    this->sum(delta);
+void update_cbr_cap(double cap_old, double cap, double start, double end) {
+    RecordCall<> rec(this, RecordOp::CbrCap, {cap_old, cap, start, end});
+    apply_delta(cbr_cap_delta(cap_old, cap, start, end));
 }
 
 //==========================================================================================================
@@ -1616,6 +1329,9 @@ std::vector<std::pair<double, double>> to_points() const {
     return result;
 }
 
+// Nom de l'interface commune (map, tableaux triés) pour to_points
+std::vector<std::pair<double, double>> to_points_cumulative() const { return to_points(); }
+
 // extraction de tous les noeuds (x,deltay) 
 std::vector<std::pair<double, double>> to_points_delta() const {
     std::vector<std::pair<double, double>> result;
@@ -1684,7 +1400,7 @@ std::vector<std::pair<double, double>> to_points_compact_bis(double xmin, double
 //==================== methode annexe pour print/draw function =================
 //==============================================================================
 
-void exportFunction(const string& filename) {
+void exportFunction(const string& filename) const {
     vector<pair<double, double>> points;
     double currentY = 0.0;
 
@@ -1709,7 +1425,7 @@ void exportFunction(const string& filename) {
     }
 
     out.close();
-    cout << "Fonction exportee vers " << filename << endl;
+    trace<TraceLevel::Info>("rbt.export", (double)points.size());
 }
 
 
@@ -1748,3 +1464,9 @@ RedBlackTree<DeltaPoint> cba_profile(double cap, double a, double b) {
     return cba;
 }
 
+// Fonction en escalier sur arbre : eval = somme préfixe (en O(log n) avec SumDelta)
+template <typename Aug = Augment<>>
+using StepTree = RedBlackTree<DeltaPoint, Aug, Step>;
+
+static_assert(PiecewiseBackend<RedBlackTree<DeltaPoint>>);
+static_assert(PiecewiseBackend<StepTree<Augment<SumDelta>>>);
@@ -0,0 +1,59 @@
+// Banc d'essai des représentations maintenues (voir bench_core.cpp), résultats JSON sur la sortie standard :
+//
+//     g++ -std=c++20 -O2 -DNDEBUG bench.cpp -o bench
+//     ./bench --max-n 100000 --out bench.json
+//     ./bench --filter update_cbr --min-time 200
+//
+// Latence de queue des mises à jour CBR (bench_tail.cpp), sans les tableaux triés par défaut (mise à jour en
+// O(n)) ; avec -DPROFILE_METRICS=1 pour relier les appels lents aux événements de l'arbre :
+//
+//     ./bench --tail 200000 --tail-n 1000000 --backend rbt --backend map
+//
+// ou rejouer des mises à jour écrites par workload_gen (horizon de la charge = --tail-n) :
+//
+//     ./workload_gen --tasks 25000 --horizon 1000000 --updates 200000 --updates-out updates.txt
+//     ./bench --tail-file updates.txt --tail-n 1000000
+//
+// ou enregistrer le flot appliqué à l'arbre, sans mesure, pour le rejouer sur chaque représentation (replay.cpp) :
+//
+//     g++ -std=c++20 -O2 -DNDEBUG -DPROFILE_RECORD=1 bench.cpp -o bench_record
+//     ./bench_record --tail 200000 --tail-n 1000000 --record run.trace
+//     ./replay run.trace --backend rbt --backend map
+#include "RBT_sarah.cpp"
+#include "piecewise_function.cpp"
+#include "bench_core.cpp"
+#include "bench_tail.cpp"
+
+int main(int argc, char** argv) {
+    BenchOptions opt = parse_bench_args(argc, argv);
+
+    if (opt.tailCalls || !opt.tailFile.empty()) {
+        if (opt.backends.empty()) opt.backends = {"rbt", "rbt_sumdelta", "map", "adaptive"};
+        std::vector<CbrUpdate> stream = opt.tailFile.empty()
+                                            ? cbr_update_stream(opt.tailCalls, double(opt.tailN), opt.seed)
+                                            : read_updates(opt.tailFile);
+        if (!opt.record.empty()) return record_tail<RedBlackTree<DeltaPoint>>(opt, stream) ? 0 : 1;
+        std::vector<TailResult> results;
+        auto tail = [&]<typename F>(const char* name) {
+            if (opt.wantsBackend(name)) results.push_back(run_tail<F>(name, opt, stream));
+        };
+        tail.operator()<RedBlackTree<DeltaPoint>>("rbt");
+        tail.operator()<RedBlackTree<DeltaPoint, Augment<SumDelta>>>("rbt_sumdelta");
+        tail.operator()<PiecewiseLinearFunction>("map");
+        tail.operator()<FlatPiecewise>("flat");
+        tail.operator()<PiecewiseFunction>("adaptive");
+        write_tail_json(opt, stream, results);
+        return 0;
+    }
+
+    BenchReport report("profile_ops");
+
+    run_bench_suite<RedBlackTree<DeltaPoint>>(report, "rbt", opt);
+    run_bench_suite<RedBlackTree<DeltaPoint, Augment<SumDelta>>>(report, "rbt_sumdelta", opt);
+    run_bench_suite<PiecewiseLinearFunction>(report, "map", opt);
+    run_bench_suite<FlatPiecewise>(report, "flat", opt);
+    run_bench_suite<PiecewiseFunction>(report, "adaptive", opt);
+
+    report.write(opt);
+    return 0;
+}
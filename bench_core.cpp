@@ -0,0 +1,434 @@
+#pragma once
+// Banc d'essai des opérations sur les profils : temps (ns/op) et allocations (allocs/op) de chaque opération,
+// pour des fonctions de 10 à 10^7 points, résultats en JSON pour suivre les régressions d'une version à l'autre.
+//
+// Ce fichier remplace operator new / operator delete pour compter les allocations : l'inclure dans un seul
+// fichier par exécutable (bench.cpp, bench_legacy.cpp), après la représentation mesurée.
+//
+// run_bench_suite<F>(rapport, nom, options) mesure toutes les opérations que F sait faire (if constexpr + requires) :
+// les représentations du concept PiecewiseBackend comme les anciens prototypes (rbt_new.cpp, piecewise_RBT.cpp).
+// Chaque mesure est une suite d'exécutions : préparation non chronométrée (profil reconstruit...), puis la partie
+// chronométrée, répétée jusqu'à --min-time ms. Les allocations sont comptées dans la partie chronométrée seule,
+// comme les compteurs matériels avec --perf (perf_counters.cpp, ignorés s'ils sont indisponibles).
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "perf_counters.cpp"
+
+//=================================================================================================================
+//======================================  Compteur d'allocations  =================================================
+//=================================================================================================================
+
+inline std::atomic<uint64_t>& bench_alloc_counter() {
+    static std::atomic<uint64_t> n{0};
+    return n;
+}
+
+inline uint64_t bench_allocs() { return bench_alloc_counter().load(std::memory_order_relaxed); }
+
+void* operator new(std::size_t size) {
+    bench_alloc_counter().fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) { return ::operator new(size); }
+// hors ligne : sinon GCC voit free() sur un pointeur de new (-Wmismatched-new-delete)
+[[gnu::noinline]] void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { ::operator delete(p); }
+void operator delete(void* p, std::size_t) noexcept { ::operator delete(p); }
+void operator delete[](void* p, std::size_t) noexcept { ::operator delete(p); }
+
+//=================================================================================================================
+//======================================  Options et résultats  ===================================================
+//=================================================================================================================
+
+struct BenchOptions {
+    size_t minN = 10;
+    size_t maxN = 10'000'000;
+    size_t growth = 10;       // tailles minN, growth * minN, ... <= maxN
+    double minTimeMs = 50.0;  // temps chronométré minimal par mesure
+    size_t batch = 1000;      // opérations par exécution pour les opérations ponctuelles (eval, insert...)
+    uint64_t seed = 42;
+    std::string filter;       // ne garde que les opérations dont le nom contient filter
+    std::vector<std::string> skip; // opérations exclues (nom exact)
+    std::vector<std::string> backends; // représentations mesurées (toutes si vide)
+    std::string out;          // fichier JSON (sortie standard si vide)
+    bool quiet = false;       // pas de ligne de progression sur std::cerr
+    bool perf = false;        // compteurs matériels (perf_event_open) par opération
+    size_t tailCalls = 0;     // mode latence de queue (bench_tail.cpp) : nombre d'appels update_cbr_* rejoués
+    size_t tailN = 1'000'000; // points du profil en mode latence de queue
+    std::string tailFile;     // mises à jour rejouées en mode latence de queue (workload.cpp), au lieu du flot tiré
+    std::string record;       // trace d'opérations (recorder.cpp) du flot de mises à jour, sans mesure
+
+    bool wants(const std::string& op) const {
+        if (std::find(skip.begin(), skip.end(), op) != skip.end()) return false;
+        return filter.empty() || op.find(filter) != std::string::npos;
+    }
+
+    bool wantsBackend(const std::string& name) const {
+        return backends.empty() || std::find(backends.begin(), backends.end(), name) != backends.end();
+    }
+};
+
+// --min-n N --max-n N --growth G --min-time MS --batch K --seed S --filter OP --skip OP (répétable)
+// --backend NOM (répétable) --out FICHIER --quiet --perf --tail APPELS --tail-n N
+// --tail-file FICHIER --record FICHIER
+inline BenchOptions parse_bench_args(int argc, char** argv, BenchOptions o = {}) {
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                std::cerr << "Erreur: valeur manquante après " << a << std::endl;
+                std::exit(2);
+            }
+            return argv[++i];
+        };
+        if (a == "--min-n") o.minN = std::stoull(value());
+        else if (a == "--max-n") o.maxN = std::stoull(value());
+        else if (a == "--growth") o.growth = std::max<size_t>(2, std::stoull(value()));
+        else if (a == "--min-time") o.minTimeMs = std::stod(value());
+        else if (a == "--batch") o.batch = std::max<size_t>(1, std::stoull(value()));
+        else if (a == "--seed") o.seed = std::stoull(value());
+        else if (a == "--filter") o.filter = value();
+        else if (a == "--skip") o.skip.push_back(value());
+        else if (a == "--backend") o.backends.push_back(value());
+        else if (a == "--out") o.out = value();
+        else if (a == "--quiet") o.quiet = true;
+        else if (a == "--perf") o.perf = true;
+        else if (a == "--tail") o.tailCalls = std::stoull(value());
+        else if (a == "--tail-n") o.tailN = std::stoull(value());
+        else if (a == "--tail-file") o.tailFile = value();
+        else if (a == "--record") o.record = value();
+        else {
+            std::cerr << "Erreur: option inconnue " << a << "\n"
+                      << "usage: " << argv[0]
+                      << " [--min-n N] [--max-n N] [--growth G] [--min-time MS] [--batch K] [--seed S]"
+                      << " [--filter OP] [--skip OP] [--backend NOM] [--out FICHIER] [--quiet] [--perf]"
+                      << " [--tail APPELS] [--tail-n N] [--tail-file FICHIER] [--record FICHIER]"
+                      << std::endl;
+            std::exit(2);
+        }
+    }
+    if (o.perf && !PerfCounters::instance().available()) {
+        std::cerr << "Avertissement: compteurs matériels indisponibles (" << PerfCounters::instance().error()
+                  << "), --perf ignoré" << std::endl;
+        o.perf = false;
+    }
+    return o;
+}
+
+struct BenchResult {
+    std::string backend;
+    std::string op;
+    size_t n = 0;          // points du profil mesuré
+    uint64_t ops = 0;      // opérations chronométrées
+    double nsPerOp = 0.0;
+    double allocsPerOp = 0.0;
+    bool perf = false;     // perfPerOp mesuré (--perf)
+    std::array<double, PERF_EVENTS> perfPerOp{};
+};
+
+// Temps et allocations de la partie chronométrée d'une exécution (start / stop, cumulés)
+// (et compteurs matériels si perf est donné ; leurs appels système restent hors du temps mesuré)
+class BenchTimer {
+public:
+    explicit BenchTimer(PerfCounters* perf = nullptr) : perf(perf) {}
+
+    void start() {
+        allocs0 = bench_allocs();
+        if (perf) perf->start();
+        t0 = std::chrono::steady_clock::now();
+    }
+
+    void stop() {
+        auto t1 = std::chrono::steady_clock::now();
+        if (perf) perf->stop(counts);
+        ns += uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+        allocs += bench_allocs() - allocs0;
+    }
+
+    uint64_t ns = 0;
+    uint64_t allocs = 0;
+    PerfCounters::Values counts{};
+    PerfCounters* const perf;
+
+private:
+    std::chrono::steady_clock::time_point t0;
+    uint64_t allocs0 = 0;
+};
+
+// Empêche le compilateur de retirer un calcul dont le résultat n'est pas utilisé
+inline volatile double bench_sink = 0.0;
+
+inline void bench_keep(double v) { bench_sink = v; }
+
+class BenchReport {
+public:
+    explicit BenchReport(std::string name) : name(std::move(name)) {}
+
+    // run(timer, reps) fait une exécution d'au plus reps opérations et rend le nombre d'opérations chronométrées.
+    // reps part de 1 puis vise le temps restant d'après le coût observé (au plus --batch) : une opération lente
+    // (en O(n) sur 10^7 points) n'est pas répétée mille fois.
+    template <typename Run>
+    void measure(const BenchOptions& opt, const std::string& backend, const std::string& op, size_t n, Run run) {
+        if (!opt.wants(op)) return;
+        const uint64_t minNs = uint64_t(opt.minTimeMs * 1e6);
+        BenchTimer timer(opt.perf ? &PerfCounters::instance() : nullptr);
+        uint64_t ops = 0;
+        size_t reps = 1;
+        do {
+            ops += run(timer, reps);
+            double perOp = double(timer.ns) / double(ops);
+            double left = double(minNs) - double(timer.ns);
+            reps = size_t(std::clamp(left / std::max(perOp, 1.0), 1.0, double(opt.batch)));
+        } while (timer.ns < minNs);
+        BenchResult r{backend, op, n, ops, double(timer.ns) / double(ops), double(timer.allocs) / double(ops)};
+        if (timer.perf) {
+            r.perf = true;
+            for (size_t e = 0; e < PERF_EVENTS; ++e) r.perfPerOp[e] = double(timer.counts[e]) / double(ops);
+        }
+        if (!opt.quiet) {
+            std::cerr << backend << " " << op << " n=" << n << " " << r.nsPerOp << " ns/op " << r.allocsPerOp
+                      << " allocs/op";
+            if (r.perf && timer.perf->has(PerfEvent::Cycles))
+                std::cerr << " " << r.perfPerOp[size_t(PerfEvent::Cycles)] << " cycles/op";
+            std::cerr << std::endl;
+        }
+        results.push_back(r);
+    }
+
+    const std::vector<BenchResult>& all() const { return results; }
+
+    void write(std::ostream& out, const BenchOptions& opt) const {
+        out << std::setprecision(6);
+        out << "{\n  \"benchmark\": \"" << name << "\",\n"
+            << "  \"seed\": " << opt.seed << ",\n"
+            << "  \"min_time_ms\": " << opt.minTimeMs << ",\n"
+            << "  \"results\": [";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const BenchResult& r = results[i];
+            out << (i ? ",\n" : "\n") << "    {\"backend\": \"" << r.backend << "\", \"op\": \"" << r.op
+                << "\", \"n\": " << r.n << ", \"ops\": " << r.ops << ", \"ns_per_op\": " << r.nsPerOp
+                << ", \"allocs_per_op\": " << r.allocsPerOp;
+            if (r.perf) {
+                // par opération, compteurs disponibles seulement
+                const PerfCounters& pc = PerfCounters::instance();
+                const char* sep = "";
+                out << ", \"perf\": {";
+                for (size_t e = 0; e < PERF_EVENTS; ++e) {
+                    if (!pc.has(static_cast<PerfEvent>(e))) continue;
+                    out << sep << "\"" << perfEventName(static_cast<PerfEvent>(e)) << "\": " << r.perfPerOp[e];
+                    sep = ", ";
+                }
+                out << "}";
+            }
+            out << "}";
+        }
+        out << "\n  ]\n}\n";
+    }
+
+    void write(const BenchOptions& opt) const {
+        if (opt.out.empty()) {
+            write(std::cout, opt);
+            return;
+        }
+        std::ofstream out(opt.out);
+        if (!out) {
+            std::cerr << "Erreur: impossible d'ouvrir le fichier " << opt.out << std::endl;
+            return;
+        }
+        write(out, opt);
+    }
+
+private:
+    std::string name;
+    std::vector<BenchResult> results;
+};
+
+//=================================================================================================================
+//======================================  Données  ================================================================
+//=================================================================================================================
+
+// n points (x, deltaY) aux abscisses offset, offset + 1, ... ; deltaY uniforme dans [-1, 1]
+inline std::vector<std::pair<double, double>> bench_points(size_t n, double offset, std::mt19937_64& rng) {
+    std::uniform_real_distribution<double> d(-1.0, 1.0);
+    std::vector<std::pair<double, double>> pts(n);
+    for (size_t i = 0; i < n; ++i) pts[i] = {offset + double(i), d(rng)};
+    return pts;
+}
+
+// Remplit f (vide) avec des points triés : from_points si F l'a, sinon point par point. Sur place et sans
+// copie : les anciens prototypes n'ont ni constructeur de copie ni de déplacement (copie superficielle des noeuds).
+template <typename F>
+void bench_fill(F& f, const std::vector<std::pair<double, double>>& pts) {
+    if constexpr (requires { F::from_points(pts); }) {
+        f = F::from_points(pts);
+    } else {
+        for (const auto& [x, d] : pts) {
+            if constexpr (requires { f.addBreakpoint(x, d); }) f.addBreakpoint(x, d);
+            else f.insert({x, d});
+        }
+    }
+}
+
+// Fenêtre de mise à jour CBR : a < b < c dans [0, horizon], largeur de quelques unités (propagation locale)
+struct BenchWindow { double a, b, c; };
+
+inline std::vector<BenchWindow> bench_windows(size_t k, double horizon, std::mt19937_64& rng) {
+    std::uniform_real_distribution<double> start(0.0, std::max(1.0, horizon - 8.0));
+    std::uniform_real_distribution<double> width(0.5, 4.0);
+    std::vector<BenchWindow> w(k);
+    for (auto& v : w) {
+        v.a = start(rng);
+        v.b = v.a + width(rng);
+        v.c = v.b + width(rng);
+    }
+    return w;
+}
+
+//=================================================================================================================
+//======================================  Suite de mesures  =======================================================
+//=================================================================================================================
+
+// Mesure sur F toutes les opérations disponibles, pour n = minN, growth * minN, ... <= maxN
+template <typename F>
+void run_bench_suite(BenchReport& report, const std::string& backend, const BenchOptions& opt) {
+    if (!opt.wantsBackend(backend)) return;
+    for (size_t n = opt.minN; n <= opt.maxN; n *= opt.growth) {
+        std::mt19937_64 rng(opt.seed ^ n);
+        const std::vector<std::pair<double, double>> fPts = bench_points(n, 0.0, rng), gPts = bench_points(n, 0.5, rng);
+        F f, g;
+        bench_fill(f, fPts);
+        bench_fill(g, gPts);
+        const double horizon = double(n);
+        const size_t k = opt.batch;
+
+        std::uniform_real_distribution<double> ux(0.0, horizon);
+        std::vector<double> xs(k);
+        for (double& x : xs) x = ux(rng);
+        std::vector<BenchWindow> windows = bench_windows(k, horizon, rng);
+
+        report.measure(opt, backend, "insert", n, [&](BenchTimer& t, size_t reps) {
+            F h;
+            bench_fill(h, fPts);
+            t.start();
+            for (size_t i = 0; i < reps; ++i) {
+                if constexpr (requires { h.addBreakpoint(xs[i], 1.0); }) h.addBreakpoint(xs[i], 1.0);
+                else h.insert({xs[i], 1.0});
+            }
+            t.stop();
+            return reps;
+        });
+
+        report.measure(opt, backend, "remove", n, [&](BenchTimer& t, size_t reps) {
+            F h;
+            bench_fill(h, fPts);
+            for (size_t i = 0; i < reps; ++i) {
+                if constexpr (requires { h.addBreakpoint(xs[i], 1.0); }) h.addBreakpoint(xs[i], 1.0);
+                else h.insert({xs[i], 1.0});
+            }
+            t.start();
+            for (size_t i = 0; i < reps; ++i) {
+                if constexpr (requires { h.removeBreakpoint(xs[i]); }) h.removeBreakpoint(xs[i]);
+                else h.remove({xs[i], 0.0});
+            }
+            t.stop();
+            return reps;
+        });
+
+        {
+            // mesure sur f lui-même : eval n'est pas const dans les anciens prototypes. Une évaluation à blanc
+            // d'abord, pour ne pas compter la construction des caches paresseux (valeurs cumulées de la map).
+            if constexpr (requires { f.evaluate(0.0); }) bench_keep(f.evaluate(0.0));
+            else bench_keep(f.eval(0.0));
+            report.measure(opt, backend, "eval", n, [&](BenchTimer& t, size_t reps) {
+                double s = 0.0;
+                t.start();
+                for (size_t i = 0; i < reps; ++i) {
+                    if constexpr (requires { f.evaluate(xs[i]); }) s += f.evaluate(xs[i]);
+                    else s += f.eval(xs[i]);
+                }
+                t.stop();
+                bench_keep(s);
+                return reps;
+            });
+        }
+
+        // Opérations sur tout le profil : une par exécution, sur un profil reconstruit
+        auto whole = [&](const char* op, auto body) {
+            report.measure(opt, backend, op, n, [&](BenchTimer& t, size_t) {
+                F h;
+                bench_fill(h, fPts);
+                t.start();
+                body(h);
+                t.stop();
+                return size_t(1);
+            });
+        };
+
+        if constexpr (requires(F h) { h.sum(g); }) whole("sum", [&](F& h) { h.sum(g); });
+        if constexpr (requires(F h) { h.minus(g); }) whole("minus", [&](F& h) { h.minus(g); });
+        if constexpr (requires(F h) { h.negate(); }) whole("negate", [&](F& h) { h.negate(); });
+        if constexpr (requires(F h) { h.minfunction(0.0); }) whole("minfunction", [&](F& h) { h.minfunction(0.0); });
+        if constexpr (requires(F h) { h.maxfunction(0.0); }) whole("maxfunction", [&](F& h) { h.maxfunction(0.0); });
+
+        if constexpr (requires(F h) { h.evaluate_max(0.0, 1.0); }) {
+            // fenêtre de 32 points en moyenne (points uniformes sur [0, horizon]) : largeur fixe en nombre de
+            // points, la mesure suit le coût de la descente et non la taille de la fenêtre
+            const double width = 32.0 * horizon / double(n);
+            report.measure(opt, backend, "evaluate_max", n, [&](BenchTimer& t, size_t reps) {
+                double s = 0.0;
+                t.start();
+                for (size_t i = 0; i < reps; ++i) s += f.evaluate_max(xs[i], xs[i] + width);
+                t.stop();
+                bench_keep(s);
+                return reps;
+            });
+        }
+
+        if constexpr (requires(F h) { h.isLessOrEqual(g); }) {
+            report.measure(opt, backend, "isLessOrEqual", n, [&](BenchTimer& t, size_t reps) {
+                size_t yes = 0;
+                t.start();
+                for (size_t i = 0; i < reps; ++i) yes += f.isLessOrEqual(g);
+                t.stop();
+                bench_keep(double(yes));
+                return reps;
+            });
+        }
+
+        // Mises à jour CBR : reps appels sur place, fenêtres a < b < c tirées au hasard (capacités 1 et 2)
+        auto updates = [&](const char* op, auto call) {
+            report.measure(opt, backend, op, n, [&](BenchTimer& t, size_t reps) {
+                F h;
+                bench_fill(h, fPts);
+                t.start();
+                for (size_t i = 0; i < reps; ++i) call(h, windows[i]);
+                t.stop();
+                return reps;
+            });
+        };
+
+        if constexpr (requires(F h) { h.update_cbr_stmin(0.0, 1.0, 2.0, 1.0, 2.0); }) {
+            updates("update_cbr_stmin", [](F& h, const BenchWindow& w) { h.update_cbr_stmin(w.a, w.b, w.c, 1.0, 2.0); });
+            updates("update_cbr_ctmin", [](F& h, const BenchWindow& w) { h.update_cbr_ctmin(w.b, w.c, w.a, 1.0, 2.0); });
+            updates("update_cbr_stmax", [](F& h, const BenchWindow& w) { h.update_cbr_stmax(w.b, w.a, w.c, 1.0, 2.0); });
+            updates("update_cbr_ctmax", [](F& h, const BenchWindow& w) { h.update_cbr_ctmax(w.c, w.b, w.a, 1.0, 2.0); });
+            updates("update_cbr_cap", [](F& h, const BenchWindow& w) { h.update_cbr_cap(1.0, 2.0, w.a, w.c); });
+        }
+    }
+}
@@ -0,0 +1,42 @@
+// Banc d'essai des anciens prototypes (voir bench_core.cpp), au travers de l'adaptateur LegacyPiecewise
+// (piecewise_legacy.cpp) : ils définissent tous deux DeltaPoint et RedBlackTree, un exécutable par prototype.
+// Leur eval est en O(n) et leur sum en O(n^2) : --max-n 10000 par défaut. Leurs messages sur std::cout sont
+// coupés pendant les mesures. Seules les opérations propres au prototype sont mesurées (LEGACY_SKIP exclut
+// celles que l'adaptateur fait par les points) : eval, sum, insert, minus et negate pour rbt_new.cpp ; eval et
+// sum pour piecewise_RBT.cpp, dont fixInsert plante dès qu'une insertion n'est pas en fin d'arbre.
+//
+//     g++ -std=c++20 -O2 -DNDEBUG bench_legacy.cpp -o bench_rbt_new
+//     g++ -std=c++20 -O2 -DNDEBUG -DLEGACY_PIECEWISE_RBT bench_legacy.cpp -o bench_piecewise_rbt
+#ifdef LEGACY_PIECEWISE_RBT
+#include "piecewise_RBT.cpp"
+#define LEGACY_NAME "piecewise_rbt"
+#define LEGACY_MID_INSERT false
+#define LEGACY_SKIP {"insert", "remove", "minus", "negate", "minfunction", "maxfunction", "evaluate_max", \
+                     "isLessOrEqual"}
+#else
+#include "rbt_new.cpp"
+#define LEGACY_NAME "rbt_new"
+#define LEGACY_MID_INSERT true
+#define LEGACY_SKIP {"remove", "minfunction", "maxfunction", "evaluate_max", "isLessOrEqual"}
+#endif
+#include "piecewise_legacy.cpp"
+#include "bench_core.cpp"
+
+using Legacy = LegacyPiecewise<RedBlackTree<DeltaPoint>, LEGACY_MID_INSERT>;
+static_assert(PiecewiseBackend<Legacy>);
+
+int main(int argc, char** argv) {
+    BenchOptions defaults;
+    defaults.maxN = 10'000;
+    defaults.skip = LEGACY_SKIP;
+    BenchOptions opt = parse_bench_args(argc, argv, defaults);
+    BenchReport report("profile_ops_legacy");
+
+    std::streambuf* out = std::cout.rdbuf(nullptr);
+    run_bench_suite<Legacy>(report, LEGACY_NAME, opt);
+    std::cout.rdbuf(out);
+    std::cout.clear();
+
+    report.write(opt);
+    return 0;
+}
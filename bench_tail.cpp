@@ -0,0 +1,195 @@
+#pragma once
+// Mode latence de queue du banc d'essai (bench --tail APPELS) : un flot de mises à jour CBR mêlées, tel qu'en
+// produit la propagation (chaînes update_cbr_stmin puis ctmin quand une date de début au plus tôt avance,
+// stmax puis ctmax quand une date au plus tard recule, update_cbr_cap quand une capacité change), est rejoué
+// sur un grand profil. Chaque appel est chronométré seul et rangé dans un histogramme (metrics.cpp) par type
+// d'appel : p50, p90, p99, p99.9 et max.
+//
+// Pour expliquer les appels lents, chaque appel garde aussi ses allocations et, compilé avec
+// -DPROFILE_METRICS=1, les événements de l'arbre pendant l'appel (rotations, tours de fixInsert / fixDelete,
+// noeuds alloués ou libérés, points touchés). Le rapport compare leur moyenne sur tous les appels et sur les
+// appels au-delà du p99, et liste les appels les plus lents avec leurs événements.
+#include <array>
+#include <numeric>
+#include "bench_core.cpp"
+#include "metrics.cpp"
+#include "workload.cpp"
+
+// Flot de mises à jour sur calls / 8 tâches réparties uniformément sur [0, horizon] (durées de 1 à 20 environ,
+// marge de quelques durées), voir generate_updates dans workload.cpp
+inline std::vector<CbrUpdate> cbr_update_stream(size_t calls, double horizon, uint64_t seed) {
+    WorkloadSpec spec;
+    spec.tasks = std::max<size_t>(1, calls / 8);
+    spec.horizon = horizon;
+    spec.overlap = 10.5 * double(spec.tasks) / horizon; // durée moyenne 10,5
+    spec.slack = 2.5;
+    spec.seed = seed;
+    std::vector<WorkloadTask> tasks = generate_tasks(spec);
+    return generate_updates(tasks, spec, calls);
+}
+
+//=================================================================================================================
+//======================================  Mesure et rapport  ======================================================
+//=================================================================================================================
+
+// Ce qu'un appel a coûté : temps, allocations et événements de l'arbre (metrics.cpp, zéro sans PROFILE_METRICS)
+struct CbrCall {
+    uint64_t ns = 0;
+    uint64_t allocs = 0;
+    std::array<uint64_t, METRIC_COUNTERS> events{};
+};
+
+inline void read_tree_events(std::array<uint64_t, METRIC_COUNTERS>& out) {
+    if constexpr (METRICS_ENABLED) {
+        const Metrics::Block& b = Metrics::local();
+        for (size_t i = 0; i < METRIC_COUNTERS; ++i) out[i] = b.counters[i].load(std::memory_order_relaxed);
+    }
+}
+
+struct TailResult {
+    std::string backend;
+    size_t n = 0;
+    LatencyHistogram all;
+    std::array<LatencyHistogram, CBR_KINDS> byKind{};
+    uint64_t threshold = 0; // p99 de tous les appels
+    size_t outliers = 0;
+    double allocsAll = 0.0, allocsOutliers = 0.0; // moyennes par appel
+    std::array<double, METRIC_COUNTERS> eventsAll{}, eventsOutliers{};
+    std::vector<std::pair<size_t, CbrCall>> slowest; // (indice de l'appel, coût), du plus lent au moins lent
+};
+
+// bench --tail ... --record FICHIER : le flot est appliqué une fois, sans mesure, au profil que run_tail
+// construirait, et enregistré (recorder.cpp) pour être rejoué sur chaque représentation par replay.cpp.
+// Demande une compilation avec -DPROFILE_RECORD=1 (sinon rien ne serait écrit).
+template <typename F>
+bool record_tail(const BenchOptions& opt, const std::vector<CbrUpdate>& stream) {
+    if constexpr (!RECORD_ENABLED) {
+        std::cerr << "Erreur: --record demande une compilation avec -DPROFILE_RECORD=1" << std::endl;
+        return false;
+    }
+    std::mt19937_64 rng(opt.seed ^ opt.tailN);
+    F f;
+    bench_fill(f, bench_points(opt.tailN, 0.0, rng));
+    if (!Recorder::start(opt.record)) return false;
+    for (const CbrUpdate& u : stream) apply_cbr_update(f, u);
+    Recorder::stop();
+    if (!opt.quiet) std::cerr << opt.record << " : " << Recorder::count() << " entrées" << std::endl;
+    return true;
+}
+
+template <typename F>
+TailResult run_tail(const std::string& backend, const BenchOptions& opt, const std::vector<CbrUpdate>& stream) {
+    std::mt19937_64 rng(opt.seed ^ opt.tailN);
+    F f;
+    bench_fill(f, bench_points(opt.tailN, 0.0, rng));
+
+    std::vector<CbrCall> calls(stream.size());
+    std::array<uint64_t, METRIC_COUNTERS> ev0{}, ev1{};
+    for (size_t i = 0; i < stream.size(); ++i) {
+        CbrCall& c = calls[i];
+        read_tree_events(ev0);
+        uint64_t a0 = bench_allocs();
+        auto t0 = std::chrono::steady_clock::now();
+        apply_cbr_update(f, stream[i]);
+        auto t1 = std::chrono::steady_clock::now();
+        c.allocs = bench_allocs() - a0;
+        read_tree_events(ev1);
+        c.ns = uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+        for (size_t e = 0; e < METRIC_COUNTERS; ++e) c.events[e] = ev1[e] - ev0[e];
+    }
+
+    TailResult r;
+    r.backend = backend;
+    r.n = opt.tailN;
+    for (size_t i = 0; i < calls.size(); ++i) {
+        r.all.record(calls[i].ns);
+        r.byKind[static_cast<size_t>(stream[i].kind)].record(calls[i].ns);
+    }
+    r.threshold = r.all.percentile(99);
+
+    for (const CbrCall& c : calls) {
+        bool slow = c.ns > r.threshold;
+        r.outliers += slow;
+        r.allocsAll += double(c.allocs);
+        if (slow) r.allocsOutliers += double(c.allocs);
+        for (size_t e = 0; e < METRIC_COUNTERS; ++e) {
+            r.eventsAll[e] += double(c.events[e]);
+            if (slow) r.eventsOutliers[e] += double(c.events[e]);
+        }
+    }
+    double nAll = double(std::max<size_t>(1, calls.size())), nOut = double(std::max<size_t>(1, r.outliers));
+    r.allocsAll /= nAll;
+    r.allocsOutliers /= nOut;
+    for (size_t e = 0; e < METRIC_COUNTERS; ++e) {
+        r.eventsAll[e] /= nAll;
+        r.eventsOutliers[e] /= nOut;
+    }
+
+    std::vector<size_t> order(calls.size());
+    std::iota(order.begin(), order.end(), size_t(0));
+    size_t top = std::min<size_t>(10, order.size());
+    std::partial_sort(order.begin(), order.begin() + top, order.end(),
+                      [&](size_t x, size_t y) { return calls[x].ns > calls[y].ns; });
+    for (size_t i = 0; i < top; ++i) r.slowest.push_back({order[i], calls[order[i]]});
+
+    if (!opt.quiet)
+        std::cerr << backend << " tail n=" << r.n << " calls=" << calls.size() << " p50 " << r.all.percentile(50)
+                  << " p99 " << r.all.percentile(99) << " p999 " << r.all.percentile(99.9) << " max " << r.all.maxNs
+                  << " ns, allocs/call " << r.allocsAll << " (>p99: " << r.allocsOutliers << ")" << std::endl;
+    return r;
+}
+
+inline void write_latency_json(std::ostream& out, const LatencyHistogram& h) {
+    out << "{\"count\": " << h.count << ", \"mean\": " << h.mean() << ", \"p50\": " << h.percentile(50)
+        << ", \"p90\": " << h.percentile(90) << ", \"p99\": " << h.percentile(99)
+        << ", \"p999\": " << h.percentile(99.9) << ", \"max\": " << h.maxNs << "}";
+}
+
+inline void write_tail_json(std::ostream& out, const BenchOptions& opt, const std::vector<CbrUpdate>& stream,
+                            const std::vector<TailResult>& results) {
+    out << std::setprecision(6);
+    out << "{\n  \"benchmark\": \"cbr_tail\",\n  \"seed\": " << opt.seed << ",\n  \"n\": " << opt.tailN
+        << ",\n  \"calls\": " << stream.size() << ",\n  \"tree_events\": " << (METRICS_ENABLED ? "true" : "false")
+        << ",\n  \"results\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const TailResult& r = results[i];
+        out << (i ? "," : "") << "\n    {\n      \"backend\": \"" << r.backend << "\",\n      \"latency_ns\": {\"all\": ";
+        write_latency_json(out, r.all);
+        for (size_t k = 0; k < CBR_KINDS; ++k) {
+            out << ",\n        \"" << cbrKindName(static_cast<CbrKind>(k)) << "\": ";
+            write_latency_json(out, r.byKind[k]);
+        }
+        out << "},\n      \"outliers\": {\"threshold_ns\": " << r.threshold << ", \"count\": " << r.outliers
+            << ", \"per_call\": {\"allocs\": {\"all\": " << r.allocsAll << ", \"outliers\": " << r.allocsOutliers << "}";
+        if (METRICS_ENABLED)
+            for (size_t e = 0; e < METRIC_COUNTERS; ++e)
+                out << ", \"" << metricName(static_cast<MetricCounter>(e)) << "\": {\"all\": " << r.eventsAll[e]
+                    << ", \"outliers\": " << r.eventsOutliers[e] << "}";
+        out << "}},\n      \"slowest\": [";
+        for (size_t s = 0; s < r.slowest.size(); ++s) {
+            const auto& [index, c] = r.slowest[s];
+            out << (s ? ",\n" : "\n") << "        {\"call\": " << index << ", \"op\": \""
+                << cbrKindName(stream[index].kind) << "\", \"ns\": " << c.ns << ", \"allocs\": " << c.allocs;
+            if (METRICS_ENABLED)
+                for (size_t e = 0; e < METRIC_COUNTERS; ++e)
+                    if (c.events[e]) out << ", \"" << metricName(static_cast<MetricCounter>(e)) << "\": " << c.events[e];
+            out << "}";
+        }
+        out << "\n      ]\n    }";
+    }
+    out << "\n  ]\n}\n";
+}
+
+inline void write_tail_json(const BenchOptions& opt, const std::vector<CbrUpdate>& stream,
+                            const std::vector<TailResult>& results) {
+    if (opt.out.empty()) {
+        write_tail_json(std::cout, opt, stream, results);
+        return;
+    }
+    std::ofstream out(opt.out);
+    if (!out) {
+        std::cerr << "Erreur: impossible d'ouvrir le fichier " << opt.out << std::endl;
+        return;
+    }
+    write_tail_json(out, opt, stream, results);
+}
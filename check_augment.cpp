@@ -0,0 +1,188 @@
+// Contrôle des augmentations de RedBlackTree (rbt_augment.cpp) : un arbre augmenté et l'arbre nu subissent la
+// même suite aléatoire d'écritures (addBreakpoint, removeBreakpoint, insert, remove, apply_delta, sum, minus,
+// add_scaled, negate, min / max avec une constante, normalize, simplify, update_cbr_cap, copie et déplacement).
+// Après chacune, les requêtes de l'augmentation (size, prefixSum, total, max_value, min_value, kth, rank) sont
+// comparées à leur valeur recalculée directement sur les points de l'arbre, et evaluate à celle de l'arbre nu.
+// Plusieurs combinaisons de politiques, dans des ordres différents.
+//
+//     g++ -std=c++20 -O2 check_augment.cpp -o check_augment && ./check_augment
+#include <stdexcept>
+#include "RBT_sarah.cpp"
+#include "check_core.cpp"
+
+template <typename Aug>
+void check_policy(CheckReport& report, const std::string& name) {
+    using Tree = RedBlackTree<DeltaPoint, Aug>;
+    using Plain = RedBlackTree<DeltaPoint>;
+    using Points = std::vector<std::pair<double, double>>;
+    std::mt19937_64 rng(40);
+    std::uniform_real_distribution<double> ux(0.0, 100.0), ud(-20.0, 20.0), uw(-2.0, 2.0);
+
+    const char* names[] = {"addBreakpoint", "removeBreakpoint", "insert", "remove",   "apply_delta",
+                           "sum",           "minus",            "add_scaled", "negate", "maxfunction",
+                           "minfunction",   "normalize",        "simplify", "update_cbr_cap", "copy / move"};
+    double worstEval[std::size(names)] = {}, worstQuery[std::size(names)] = {};
+    bool shapeOk[std::size(names)];
+    std::fill(std::begin(shapeOk), std::end(shapeOk), true);
+
+    Points start = check_points(rng, 60);
+    Tree a = Tree::from_points(start);
+    Plain p = Plain::from_points(start);
+    for (int step = 0; step < 3000; ++step) {
+        if (step % 40 == 0) { // valeurs bornées : on repart d'un profil neuf
+            Points fresh = check_points(rng, 20 + step % 80);
+            a = Tree::from_points(fresh);
+            p = Plain::from_points(fresh);
+        }
+        Points cur = p.to_points_delta();
+        Points pg = check_points(rng, 1 + rng() % 30, 20.0 * double(rng() % 3));
+        double grid = std::round(ux(rng) * 10.0) / 10.0;
+        size_t op = rng() % std::size(names);
+        switch (op) {
+        case 0: {
+            double d = ud(rng);
+            a.addBreakpoint(grid, d);
+            p.addBreakpoint(grid, d);
+            break;
+        }
+        case 1:
+            if (!cur.empty()) {
+                double x = cur[rng() % cur.size()].first;
+                a.removeBreakpoint(x);
+                p.removeBreakpoint(x);
+            }
+            break;
+        case 2: { // abscisse hors de la grille : point toujours nouveau
+            double d = ud(rng);
+            a.insert(DeltaPoint{grid + 0.05, d});
+            p.insert(DeltaPoint{grid + 0.05, d});
+            break;
+        }
+        case 3:
+            if (!cur.empty()) {
+                auto [x, d] = cur[rng() % cur.size()];
+                a.remove(DeltaPoint{x, d});
+                p.remove(DeltaPoint{x, d});
+            }
+            break;
+        case 4: { // g nu, quelle que soit l'augmentation de l'arbre modifié
+            double w = uw(rng);
+            Plain g = Plain::from_points(pg);
+            a.apply_delta(g, w);
+            p.apply_delta(g, w);
+            break;
+        }
+        case 5:
+            a.sum(Tree::from_points(pg));
+            p.sum(Plain::from_points(pg));
+            break;
+        case 6:
+            a.minus(Tree::from_points(pg));
+            p.minus(Plain::from_points(pg));
+            break;
+        case 7: {
+            double w = uw(rng);
+            a.add_scaled(Tree::from_points(pg), w);
+            p.add_scaled(Plain::from_points(pg), w);
+            break;
+        }
+        case 8:
+            a.negate();
+            p.negate();
+            break;
+        case 9: {
+            double c = ud(rng);
+            a.maxfunction(c);
+            p.maxfunction(c);
+            break;
+        }
+        case 10: {
+            double c = ud(rng);
+            a.minfunction(c);
+            p.minfunction(c);
+            break;
+        }
+        case 11:
+            a.normalize();
+            p.normalize();
+            break;
+        case 12:
+            a.simplify(0.5);
+            p.simplify(0.5);
+            break;
+        case 13: {
+            double s = ux(rng), e = ux(rng), c0 = uw(rng), c1 = uw(rng);
+            a.update_cbr_cap(c0, c1, std::min(s, e), std::max(s, e));
+            p.update_cbr_cap(c0, c1, std::min(s, e), std::max(s, e));
+            break;
+        }
+        case 14: {
+            Tree copy = a;
+            Tree moved = std::move(copy);
+            a = moved;
+            a = std::move(moved);
+            break;
+        }
+        }
+
+        // Référence : valeurs recalculées sur les points de l'arbre augmenté
+        double errEval = 0.0, errQuery = 0.0;
+        Points pts = a.to_points_delta();
+        bool shape = pts.size() == p.to_points_delta().size() && a.size() == pts.size();
+        for (double x : check_xs(-1.0, 101.0, 0.7, {&pts})) {
+            double v = a.evaluate(x);
+            errEval = std::max({errEval, std::abs(v - p.evaluate(x)), std::abs(v - check_ref(pts, x))});
+            if constexpr (Aug::template has<SumDelta>) {
+                double s = 0.0;
+                for (const auto& [xi, d] : pts) s += xi <= x ? d : 0.0;
+                errQuery = std::max(errQuery, std::abs(a.prefixSum(x) - s));
+            }
+            if constexpr (Aug::template has<Count>) {
+                size_t k = 0;
+                while (k < pts.size() && pts[k].first <= x) ++k;
+                shape &= a.rank(x) == k;
+            }
+        }
+        double y = 0.0, hi = 0.0, lo = 0.0;
+        for (const auto& [x, d] : pts) {
+            y += d;
+            hi = std::max(hi, y);
+            lo = std::min(lo, y);
+        }
+        if constexpr (Aug::template has<SumDelta>) errQuery = std::max(errQuery, std::abs(a.total() - y));
+        if constexpr (Aug::template has<PrefixMax>) errQuery = std::max(errQuery, std::abs(a.max_value() - hi));
+        if constexpr (Aug::template has<PrefixMin>) errQuery = std::max(errQuery, std::abs(a.min_value() - lo));
+        if constexpr (Aug::template has<Count>) {
+            for (size_t k = 0; k < pts.size(); ++k) shape &= a.kth(k) == pts[k];
+            bool threw = false;
+            try {
+                a.kth(pts.size());
+            } catch (const std::out_of_range&) {
+                threw = true;
+            }
+            shape &= threw;
+        }
+        worstEval[op] = std::max(worstEval[op], errEval);
+        worstQuery[op] = std::max(worstQuery[op], errQuery);
+        shapeOk[op] &= shape;
+        // écart constaté : on resynchronise, pour l'imputer à cette seule opération
+        if (errEval > 1e-9 || errQuery > 1e-9 || !shape) a = Tree::from_points(p.to_points_delta());
+    }
+    for (size_t op = 0; op < std::size(names); ++op) {
+        report.expect(name + " " + names[op] + " evaluate", worstEval[op], 1e-9);
+        if constexpr (Aug::template has<SumDelta>)
+            report.expect(name + " " + names[op] + " sum queries", worstQuery[op], 1e-9);
+        report.expect(name + " " + names[op] + " size / rank / kth", shapeOk[op]);
+    }
+}
+
+int main() {
+    CheckReport report;
+    std::cout << std::setprecision(3);
+    check_policy<Augment<SumDelta>>(report, "sumdelta");
+    check_policy<Augment<Count>>(report, "count");
+    check_policy<Augment<SumDelta, PrefixMax>>(report, "sumdelta+prefixmax");
+    check_policy<Augment<PrefixMin, SumDelta>>(report, "prefixmin+sumdelta");
+    check_policy<Augment<Count, PrefixMax, SumDelta, PrefixMin>>(report, "all");
+    return report.finish();
+}
@@ -0,0 +1,135 @@
+// Contrôle des caches d'évaluation de PiecewiseLinearFunction (piecewise_map.cpp) et de FlatPiecewise
+// (piecewise_flat.cpp) : après addBreakpoint, removeBreakpoint, apply_delta, update_cbr_* et des copies
+// (partagées, COW, pour la std::map), evaluate doit rendre exactement (au bit près) la valeur d'une fonction
+// reconstruite par from_points, dont le cache part de zéro. Puis plusieurs threads évaluent des copies d'un même
+// Store dont le cache est vide pendant qu'un autre détache la sienne, et un même FlatPiecewise au cache vide
+// pendant qu'un autre le copie (à lancer aussi avec -fsanitize=thread).
+//
+//     g++ -std=c++20 -O2 -pthread check_cache.cpp -o check_cache && ./check_cache
+//     g++ -std=c++20 -O1 -g -fsanitize=thread check_cache.cpp -o check_cache_tsan && ./check_cache_tsan
+#include <thread>
+#include "piecewise_flat.cpp"
+#include "check_core.cpp"
+
+using PLF = PiecewiseLinearFunction;
+
+// Plus grand écart entre f et sa reconstruction à froid ; bit à bit : 0 ou +inf
+template <typename F>
+double cold_mismatch(const F& f, const std::vector<double>& xs) {
+    F cold = F::from_points(f.to_points_delta());
+    for (double x : xs)
+        if (f.evaluate(x) != cold.evaluate(x)) return std::numeric_limits<double>::infinity();
+    return 0.0;
+}
+
+template <typename F>
+void check_invalidation(CheckReport& report, const std::string& name) {
+    std::mt19937_64 rng(36);
+    std::uniform_real_distribution<double> ux(0.0, 100.0), ud(-20.0, 20.0), uw(0.5, 3.0);
+
+    // Réserve de profils : pour la std::map, les copies partagent leur Store jusqu'à la première écriture
+    std::vector<F> pool;
+    for (int i = 0; i < 4; ++i) pool.push_back(F::from_points(check_points(rng, 50)));
+    std::vector<double> probe;
+    for (double x = -5.0; x <= 105.0; x += 0.37) probe.push_back(x);
+
+    const char* names[] = {"addBreakpoint", "removeBreakpoint", "apply_delta", "update_cbr_stmin",
+                           "update_cbr_ctmax", "update_cbr_cap", "copy"};
+    double worst[std::size(names)] = {};
+    for (int step = 0; step < 3000; ++step) {
+        size_t i = rng() % pool.size(), j = rng() % pool.size();
+        F& f = pool[i];
+        f.evaluate(ux(rng)); // cache rempli avant l'opération : l'invalidation partielle est sollicitée
+        size_t op = rng() % std::size(names);
+        switch (op) {
+        case 0: f.addBreakpoint(std::round(ux(rng) * 10.0) / 10.0, ud(rng)); break;
+        case 1: {
+            auto pts = f.to_points_delta();
+            if (pts.size() > 2) f.removeBreakpoint(pts[1 + rng() % (pts.size() - 1)].first);
+            break;
+        }
+        case 2: f.apply_delta(pool[j], i == j ? 1.0 : ud(rng) / 10.0); break;
+        case 3: {
+            double a = ux(rng), b = ux(rng), c = ux(rng);
+            f.update_cbr_stmin(std::min(a, b), std::max(a, b), std::max({a, b}) + c / 10.0, 1.0, uw(rng));
+            break;
+        }
+        case 4: {
+            double a = ux(rng), b = ux(rng);
+            f.update_cbr_ctmax(std::max(a, b), std::min(a, b), std::min(a, b) - 5.0, 1.0, uw(rng));
+            break;
+        }
+        case 5: {
+            double a = ux(rng), b = ux(rng);
+            f.update_cbr_cap(uw(rng), uw(rng), std::min(a, b), std::max(a, b));
+            break;
+        }
+        case 6:
+            if (pool.size() < 12) pool.push_back(f);
+            else pool[j] = f;
+            break;
+        }
+        // tous les profils, y compris ceux qui partageaient le Store de f avant l'opération
+        for (const F& g : pool) {
+            std::vector<double> xs = probe;
+            for (const auto& [x, d] : g.to_points_delta()) xs.push_back(x);
+            worst[op] = std::max(worst[op], cold_mismatch(g, xs));
+        }
+    }
+    for (size_t op = 0; op < std::size(names); ++op)
+        report.expect(name + " cache after " + names[op], worst[op], 0.0);
+}
+
+int main() {
+    CheckReport report;
+    check_invalidation<PLF>(report, "map");
+    check_invalidation<FlatPiecewise>(report, "flat");
+
+    std::mt19937_64 rng(36);
+    // Évaluations concurrentes de copies partageant un Store au cache vide, pendant qu'un thread détache la sienne
+    bool threadsOk = true;
+    for (int round = 0; round < 20; ++round) {
+        PLF shared = PLF::from_points(check_points(rng, 2000, 0.0, 1000.0));
+        PLF cold = PLF::from_points(shared.to_points_delta());
+        std::vector<double> expected;
+        for (double x = 0.0; x < 1000.0; x += 0.9) expected.push_back(cold.evaluate(x));
+        std::vector<char> ok(4, 1);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+            threads.emplace_back([&, t, copy = shared] {
+                size_t k = 0;
+                for (double x = 0.0; x < 1000.0; x += 0.9, ++k) ok[t] &= copy.evaluate(x) == expected[k];
+            });
+        threads.emplace_back([copy = shared]() mutable { copy.addBreakpoint(500.05, 1.0); });
+        for (auto& th : threads) th.join();
+        for (char c : ok) threadsOk &= bool(c);
+    }
+    report.expect("map concurrent eval on shared store", threadsOk);
+
+    // Un même FlatPiecewise au cache vide (après une écriture), évalué par quatre threads pendant qu'un cinquième
+    // le copie et évalue la copie
+    threadsOk = true;
+    for (int round = 0; round < 20; ++round) {
+        FlatPiecewise f = FlatPiecewise::from_points(check_points(rng, 2000, 0.0, 1000.0));
+        std::vector<double> expected;
+        for (double x = 0.0; x < 1000.0; x += 0.9) expected.push_back(f.evaluate(x));
+        f.addBreakpoint(-1.0, 0.0); // point nul en tête : même fonction, cache invalidé depuis le début
+        const FlatPiecewise& shared = f;
+        std::vector<char> ok(5, 1);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+            threads.emplace_back([&, t] {
+                size_t k = 0;
+                for (double x = 0.0; x < 1000.0; x += 0.9, ++k) ok[t] &= shared.evaluate(x) == expected[k];
+            });
+        threads.emplace_back([&] {
+            FlatPiecewise copy = shared;
+            size_t k = 0;
+            for (double x = 0.0; x < 1000.0; x += 0.9, ++k) ok[4] &= copy.evaluate(x) == expected[k];
+        });
+        for (auto& th : threads) th.join();
+        for (char c : ok) threadsOk &= bool(c);
+    }
+    report.expect("flat concurrent eval on one object", threadsOk);
+    return report.finish();
+}
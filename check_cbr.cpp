@@ -0,0 +1,82 @@
+// Contrôle des mises à jour CBR (update_cbr_*) sur l'arbre, la std::map, les tableaux triés et la façade : les
+// mêmes appels doivent donner la même fonction partout, y compris pour des déplacements de fenêtre et des
+// changements de capacité minuscules (de 1e-6 à 1e-4, sous la tolérance d'abscisses de l'arbre mais au-dessus
+// du seuil CBR commun CBR_TOL). La std::map sert de référence.
+//
+//     g++ -std=c++20 -O2 check_cbr.cpp -o check_cbr && ./check_cbr
+#include "RBT_sarah.cpp"
+#include "piecewise_function.cpp"
+#include "workload.cpp"
+#include "check_core.cpp"
+
+// Suite d'appels sur des fenêtres de [0, 100] : déplacements ordinaires ou minuscules selon tiny
+std::vector<CbrUpdate> cbr_calls(std::mt19937_64& rng, size_t calls, bool tiny) {
+    std::uniform_real_distribution<double> ux(0.0, 90.0), ul(1.0, 10.0), ucap(1.0, 5.0), us(-6.0, -4.0);
+    std::vector<CbrUpdate> out;
+    for (size_t i = 0; i < calls; ++i) {
+        double s = ux(rng), len = ul(rng), c0 = ucap(rng);
+        double step = tiny ? std::pow(10.0, us(rng)) : len * 0.3;
+        switch (rng() % 5) {
+        case 0: out.push_back({CbrKind::StMin, s, s + step, s + len, c0, c0}); break;
+        case 1: out.push_back({CbrKind::CtMin, s + len, s + len + step, s, c0, c0}); break;
+        case 2: out.push_back({CbrKind::StMax, s + step, s, s + len, c0, c0}); break;
+        case 3: out.push_back({CbrKind::CtMax, s + len + step, s + len, s, c0, c0}); break;
+        default: out.push_back({CbrKind::Cap, c0, c0 + (tiny ? step : 1.5), s, s + len, 0.0}); break;
+        }
+    }
+    return out;
+}
+
+// Écart maximal entre F et la map après les mêmes appels
+template <typename F>
+double cbr_error(const std::vector<std::pair<double, double>>& start, const std::vector<CbrUpdate>& calls) {
+    F f = F::from_points(start);
+    PiecewiseLinearFunction ref = PiecewiseLinearFunction::from_points(start);
+    for (const CbrUpdate& u : calls) {
+        apply_cbr_update(f, u);
+        apply_cbr_update(ref, u);
+    }
+    auto pr = ref.to_points_delta();
+    double err = 0.0;
+    for (double x : check_xs(-1.0, 101.0, 0.01, {&pr})) err = std::max(err, std::abs(f.evaluate(x) - ref.evaluate(x)));
+    return err;
+}
+
+template <typename F>
+void check_backend(CheckReport& report, const std::string& name) {
+    std::mt19937_64 rng(37);
+    double worst[2] = {};
+    for (int trial = 0; trial < 60; ++trial) {
+        auto start = check_points(rng, 40);
+        for (bool tiny : {false, true})
+            worst[tiny] = std::max(worst[tiny], cbr_error<F>(start, cbr_calls(rng, 50, tiny)));
+    }
+    report.expect(name + " update_cbr_* vs map", worst[0], 1e-9);
+    report.expect(name + " update_cbr_* moves below 1e-4 vs map", worst[1], 1e-9);
+}
+
+int main() {
+    CheckReport report;
+    std::cout << std::setprecision(3);
+
+    // Cas isolés : la capacité 1 -> 1,00005 et un début avancé de 5e-5 doivent compter partout
+    const std::vector<std::pair<double, double>> ramp = {{0.0, 0.0}, {10.0, 1.0}}; // cba_profile(1, 0, 10)
+    auto one = [&]<typename F>(const std::string& name) {
+        F cap = F::from_points(ramp);
+        cap.update_cbr_cap(1.0, 1.00005, 0.0, 10.0);
+        report.expect(name + " cap 1 -> 1.00005", std::abs(cap.evaluate(5.0) - 0.500025), 1e-12);
+        F st = F::from_points(ramp);
+        st.update_cbr_stmin(0.0, 5e-5, 10.0, 1.0, 1.0);
+        report.expect(name + " stmin moved by 5e-5", st.evaluate(10.0) - st.evaluate(5.0) > 0.0 &&
+                                                         st.evaluate(1e-5) < 1e-5 * 0.1);
+    };
+    one.operator()<RedBlackTree<DeltaPoint>>("rbt");
+    one.operator()<PiecewiseLinearFunction>("map");
+    one.operator()<FlatPiecewise>("flat");
+
+    check_backend<RedBlackTree<DeltaPoint>>(report, "rbt");
+    check_backend<RedBlackTree<DeltaPoint, Augment<SumDelta>>>(report, "rbt_sumdelta");
+    check_backend<FlatPiecewise>(report, "flat");
+    check_backend<PiecewiseFunction>(report, "adaptive");
+    return report.finish();
+}
@@ -0,0 +1,78 @@
+#pragma once
+// Outils communs des programmes de contrôle (check_*.cpp) : profils aléatoires, évaluation de référence
+// directement sur les points (x, deltaY), et compte rendu "ok / FAIL" avec code de sortie, comme complexity.cpp.
+// Chaque contrôle est un main sans dépendance ni fichier de référence, utilisable comme test :
+//
+//     g++ -std=c++20 -O2 check_zip.cpp -o check_zip && ./check_zip
+#include <algorithm>
+#include <cmath>
+#include <initializer_list>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Points (x, deltaY) triés, abscisses sur une grille de pas 0,1 dans [lo, hi] (deux profils partagent ainsi des
+// abscisses), premier deltaY nul : la fonction part de 0 sans saut et la référence est continue.
+inline std::vector<std::pair<double, double>> check_points(std::mt19937_64& rng, size_t n, double lo = 0.0,
+                                                          double hi = 100.0) {
+    std::uniform_real_distribution<double> ux(lo, hi), ud(-50.0, 50.0);
+    std::vector<double> xs(n);
+    for (double& x : xs) x = std::round(ux(rng) * 10.0) / 10.0;
+    std::sort(xs.begin(), xs.end());
+    xs.erase(std::unique(xs.begin(), xs.end()), xs.end());
+    std::vector<std::pair<double, double>> pts;
+    for (size_t i = 0; i < xs.size(); ++i) pts.push_back({xs[i], i ? ud(rng) : 0.0});
+    return pts;
+}
+
+// Valeur en x de la fonction décrite par ses points : 0 avant le premier, linéaire entre deux points,
+// constante après le dernier (abscisses égales : somme de leurs deltaY)
+inline double check_ref(const std::vector<std::pair<double, double>>& pts, double x) {
+    double y = 0.0, px = 0.0, py = 0.0;
+    bool started = false;
+    for (const auto& [xi, d] : pts) {
+        if (x < xi) return started ? py + (y + d - py) * (x - px) / (xi - px) : 0.0;
+        y += d;
+        px = xi;
+        py = y;
+        started = true;
+    }
+    return y;
+}
+
+// Abscisses de contrôle : grille régulière sur [lo, hi] et tous les points donnés
+inline std::vector<double> check_xs(double lo, double hi, double step,
+                                    std::initializer_list<const std::vector<std::pair<double, double>>*> pts) {
+    std::vector<double> xs;
+    for (double x = lo; x <= hi; x += step) xs.push_back(x);
+    for (const auto* p : pts)
+        for (const auto& [x, d] : *p) xs.push_back(x);
+    return xs;
+}
+
+// Compte rendu : une ligne par contrôle, PASSED / FAILED à la fin, code de sortie 1 en cas d'échec
+class CheckReport {
+public:
+    // Écart maximal observé pour un contrôle, comparé à la tolérance
+    void expect(const std::string& what, double error, double tolerance) {
+        bool ok = error <= tolerance;
+        failures += !ok;
+        std::cout << (ok ? "ok   " : "FAIL ") << what << " error " << error << "\n";
+    }
+
+    void expect(const std::string& what, bool ok) {
+        failures += !ok;
+        std::cout << (ok ? "ok   " : "FAIL ") << what << "\n";
+    }
+
+    int finish() const {
+        std::cout << (failures ? "FAILED " : "PASSED ") << failures << " check(s) failed" << std::endl;
+        return failures ? 1 : 0;
+    }
+
+private:
+    int failures = 0;
+};
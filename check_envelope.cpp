@@ -0,0 +1,52 @@
+// Contrôle des enveloppes supérieure et inférieure de K profils (envelope_max / envelope_min) sur l'arbre, la
+// std::map et les tableaux triés : comparaison au max / min point par point des K fonctions, calculé directement
+// sur leurs points, pour K de 1 à 17 et des profils de débuts et de longueurs différents.
+//
+//     g++ -std=c++20 -O2 check_envelope.cpp -o check_envelope && ./check_envelope
+#include "RBT_sarah.cpp"
+#include "piecewise_function.cpp"
+#include "check_core.cpp"
+
+template <typename F>
+void check_backend(CheckReport& report, const std::string& name) {
+    std::mt19937_64 rng(30);
+    double worstMax = 0.0, worstMin = 0.0;
+    for (int trial = 0; trial < 340; ++trial) {
+        size_t k = 1 + trial % 17;
+        std::vector<std::vector<std::pair<double, double>>> pts;
+        std::vector<F> fs;
+        for (size_t i = 0; i < k; ++i) {
+            pts.push_back(check_points(rng, 3 + (trial + i) % 25, 5.0 * double(i % 4), 100.0));
+            fs.push_back(F::from_points(pts.back()));
+        }
+        std::vector<const F*> ptrs;
+        for (const F& f : fs) ptrs.push_back(&f);
+        F upper = F::envelope_max(ptrs), lower = F::envelope_min(ptrs);
+
+        auto pu = upper.to_points_delta(), pl = lower.to_points_delta();
+        std::vector<double> xs = check_xs(-1.0, 101.0, 0.23, {&pu, &pl});
+        for (const auto& p : pts)
+            for (const auto& [x, d] : p) xs.push_back(x);
+        for (double x : xs) {
+            double hi = -1e300, lo = 1e300;
+            for (const auto& p : pts) {
+                double v = check_ref(p, x);
+                hi = std::max(hi, v);
+                lo = std::min(lo, v);
+            }
+            worstMax = std::max(worstMax, std::abs(upper.evaluate(x) - hi));
+            worstMin = std::max(worstMin, std::abs(lower.evaluate(x) - lo));
+        }
+    }
+    report.expect(name + " envelope_max", worstMax, 1e-9);
+    report.expect(name + " envelope_min", worstMin, 1e-9);
+}
+
+int main() {
+    CheckReport report;
+    std::cout << std::setprecision(3);
+    check_backend<RedBlackTree<DeltaPoint>>(report, "rbt");
+    check_backend<PiecewiseLinearFunction>(report, "map");
+    check_backend<FlatPiecewise>(report, "flat");
+    return report.finish();
+}
@@ -0,0 +1,136 @@
+// Contrôle des expressions paresseuses (profile_expr.cpp) sur l'arbre, la std::map, les tableaux triés et la
+// façade : DAG aléatoires de +, -, négation, produit par un scalaire, min et max sur quelques feuilles, avec des
+// sous-expressions partagées. eval(x) (sans construire) et materialize() sont comparés à la valeur de référence
+// calculée sur les points des feuilles ; linear_form() d'une expression sans min/max doit avoir une entrée par
+// feuille et donner la même valeur, et lever std::invalid_argument dès qu'il y a un min ou un max.
+//
+//     g++ -std=c++20 -O2 check_expr.cpp -o check_expr && ./check_expr
+#include <functional>
+#include "RBT_sarah.cpp"
+#include "piecewise_function.cpp"
+#include "check_core.cpp"
+
+// Expression et sa valeur de référence, construites ensemble
+template <typename F>
+struct RefExpr {
+    ProfileExpr<F> expr;
+    std::function<double(double)> ref;
+    bool linear;
+};
+
+template <typename F>
+struct ExprGen {
+    std::mt19937_64& rng;
+    const std::vector<std::vector<std::pair<double, double>>>& pts;
+    const std::vector<F>& leaves;
+    bool allowMinMax;
+    std::vector<RefExpr<F>> made; // sous-expressions déjà construites, réutilisées (partage)
+
+    RefExpr<F> leaf() {
+        size_t i = rng() % leaves.size();
+        const auto* p = &pts[i];
+        return {ProfileExpr<F>(leaves[i]), [p](double x) { return check_ref(*p, x); }, true};
+    }
+
+    RefExpr<F> pick(int depth) {
+        if (!made.empty() && rng() % 4 == 0) return made[rng() % made.size()];
+        return make(depth);
+    }
+
+    RefExpr<F> make(int depth) {
+        if (depth == 0) return leaf();
+        RefExpr<F> a = pick(depth - 1), b = pick(depth - 1);
+        RefExpr<F> r{ProfileExpr<F>(leaves[0]), nullptr, a.linear && b.linear};
+        double w = std::round(std::uniform_real_distribution<double>(-3.0, 3.0)(rng) * 4.0) / 4.0;
+        switch (rng() % (allowMinMax ? 7 : 5)) {
+        case 0: r.expr = a.expr + b.expr; r.ref = [a, b](double x) { return a.ref(x) + b.ref(x); }; break;
+        case 1: r.expr = a.expr - b.expr; r.ref = [a, b](double x) { return a.ref(x) - b.ref(x); }; break;
+        case 2: r.expr = -a.expr; r.ref = [a](double x) { return -a.ref(x); }; r.linear = a.linear; break;
+        case 3: r.expr = w * a.expr; r.ref = [a, w](double x) { return w * a.ref(x); }; r.linear = a.linear; break;
+        case 4: r.expr = a.expr - a.expr + b.expr; r.ref = b.ref; break; // a s'annule : poids nul
+        case 5:
+            r.expr = min(a.expr, b.expr);
+            r.ref = [a, b](double x) { return std::min(a.ref(x), b.ref(x)); };
+            r.linear = false;
+            break;
+        default:
+            r.expr = max(a.expr, b.expr);
+            r.ref = [a, b](double x) { return std::max(a.ref(x), b.ref(x)); };
+            r.linear = false;
+            break;
+        }
+        made.push_back(r);
+        return r;
+    }
+};
+
+template <typename F>
+void check_backend(CheckReport& report, const std::string& name) {
+    std::mt19937_64 rng(32);
+    double worstEval = 0.0, worstBuilt = 0.0, worstForm = 0.0;
+    bool formOk = true, throwsOk = true;
+    for (int trial = 0; trial < 200; ++trial) {
+        std::vector<std::vector<std::pair<double, double>>> pts;
+        std::vector<F> leaves;
+        for (int i = 0; i < 5; ++i) {
+            pts.push_back(check_points(rng, 2 + (trial + i) % 30, 8.0 * double(i % 3), 100.0));
+            leaves.push_back(F::from_points(pts.back()));
+        }
+        bool allowMinMax = trial % 2 == 0;
+        ExprGen<F> gen{rng, pts, leaves, allowMinMax, {}};
+        RefExpr<F> e = gen.make(1 + trial % 4);
+
+        F built = e.expr.materialize();
+        std::vector<const std::vector<std::pair<double, double>>*> grid;
+        for (const auto& p : pts) grid.push_back(&p);
+        auto pb = built.to_points_delta();
+        grid.push_back(&pb);
+        std::vector<double> xs = check_xs(-1.0, 101.0, 0.41, {});
+        for (const auto* p : grid)
+            for (const auto& [x, d] : *p) xs.push_back(x);
+        for (double x : xs) {
+            double r = e.ref(x);
+            worstEval = std::max(worstEval, std::abs(e.expr.eval(x) - r));
+            worstBuilt = std::max(worstBuilt, std::abs(built.evaluate(x) - r));
+        }
+
+        if (e.linear) {
+            auto form = e.expr.linear_form();
+            std::vector<const F*> seen;
+            for (const auto& [f, w] : form) {
+                formOk &= std::find(seen.begin(), seen.end(), f) == seen.end();
+                seen.push_back(f);
+            }
+            for (double x : xs) {
+                double v = 0.0;
+                for (const auto& [f, w] : form) v += w * f->evaluate(x);
+                worstForm = std::max(worstForm, std::abs(v - e.ref(x)));
+            }
+        } else {
+            bool threw = false;
+            try {
+                e.expr.linear_form();
+            } catch (const std::invalid_argument&) {
+                threw = true;
+            }
+            throwsOk &= threw;
+        }
+    }
+    report.expect(name + " expression eval", worstEval, 1e-9);
+    report.expect(name + " expression materialize", worstBuilt, 1e-9);
+    report.expect(name + " linear_form value", worstForm, 1e-9);
+    report.expect(name + " linear_form has one entry per leaf", formOk);
+    report.expect(name + " linear_form rejects min / max", throwsOk);
+}
+
+int main() {
+    CheckReport report;
+    std::cout << std::setprecision(3);
+    check_backend<RedBlackTree<DeltaPoint>>(report, "rbt");
+    check_backend<PiecewiseLinearFunction>(report, "map");
+    check_backend<FlatPiecewise>(report, "flat");
+    PiecewiseFunction::setThresholds(16, 8);
+    check_backend<PiecewiseFunction>(report, "adaptive");
+    PiecewiseFunction::setThresholds(256, 64);
+    return report.finish();
+}
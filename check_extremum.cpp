@@ -0,0 +1,58 @@
+// Contrôle de evaluate_max / evaluate_min sur l'arbre (avec et sans SumDelta), la std::map, les tableaux triés
+// et la façade : comparaison au max / min de la référence sur les bornes et les points de la fenêtre (une
+// fonction linéaire par morceaux atteint ses extrema en ces points), pour des fenêtres aléatoires, réduites à un
+// point, collées sur un point de rupture, avant le premier point et après le dernier.
+//
+//     g++ -std=c++20 -O2 check_extremum.cpp -o check_extremum && ./check_extremum
+#include "RBT_sarah.cpp"
+#include "piecewise_function.cpp"
+#include "check_core.cpp"
+
+template <typename F>
+void check_backend(CheckReport& report, const std::string& name) {
+    std::mt19937_64 rng(46);
+    std::uniform_real_distribution<double> ut(-5.0, 105.0), uw(0.0, 30.0);
+    double worstMax = 0.0, worstMin = 0.0;
+    for (int trial = 0; trial < 300; ++trial) {
+        auto pts = check_points(rng, 1 + trial % 60, 10.0 * (trial % 3), 100.0);
+        F f = F::from_points(pts);
+        std::vector<std::pair<double, double>> windows;
+        for (int i = 0; i < 20; ++i) {
+            double a = ut(rng);
+            windows.push_back({a, a + uw(rng)});
+        }
+        const auto& [x0, d0] = pts[rng() % pts.size()];
+        windows.push_back({x0, x0});
+        windows.push_back({x0, x0 + 3.0});
+        windows.push_back({x0 - 3.0, x0});
+        windows.push_back({-10.0, pts.front().first - 1.0});
+        windows.push_back({pts.back().first + 1.0, 200.0});
+        windows.push_back({-10.0, 200.0});
+        for (const auto& [a, b] : windows) {
+            double hi = std::max(check_ref(pts, a), check_ref(pts, b));
+            double lo = std::min(check_ref(pts, a), check_ref(pts, b));
+            for (const auto& [x, d] : pts)
+                if (x >= a && x <= b) {
+                    hi = std::max(hi, check_ref(pts, x));
+                    lo = std::min(lo, check_ref(pts, x));
+                }
+            worstMax = std::max(worstMax, std::abs(f.evaluate_max(a, b) - hi));
+            worstMin = std::max(worstMin, std::abs(f.evaluate_min(a, b) - lo));
+        }
+    }
+    report.expect(name + " evaluate_max", worstMax, 1e-9);
+    report.expect(name + " evaluate_min", worstMin, 1e-9);
+}
+
+int main() {
+    CheckReport report;
+    std::cout << std::setprecision(3);
+    check_backend<RedBlackTree<DeltaPoint>>(report, "rbt");
+    check_backend<RedBlackTree<DeltaPoint, Augment<SumDelta>>>(report, "rbt_sumdelta");
+    check_backend<PiecewiseLinearFunction>(report, "map");
+    check_backend<FlatPiecewise>(report, "flat");
+    PiecewiseFunction::setThresholds(16, 8);
+    check_backend<PiecewiseFunction>(report, "adaptive");
+    PiecewiseFunction::setThresholds(256, 64);
+    return report.finish();
+}
@@ -0,0 +1,64 @@
+// Contrôle des opérations fusionnées add_scaled (f += a g) et add_clamped (f = clamp(f + g, lo, hi)) sur l'arbre
+// (avec et sans SumDelta), la std::map, les tableaux triés et la façade : comparaison point par point à la
+// référence calculée sur les points des opérandes, pour des coefficients nuls, négatifs et fractionnaires et des
+// bornes qui coupent ou non les profils (0 reste dans [lo, hi] : le résultat est nul avant son premier point).
+// L'argument doit ressortir inchangé, et f.add_scaled(f, a) doit donner (1 + a) f.
+//
+//     g++ -std=c++20 -O2 check_fused.cpp -o check_fused && ./check_fused
+#include "RBT_sarah.cpp"
+#include "piecewise_function.cpp"
+#include "check_core.cpp"
+
+template <typename F>
+void check_backend(CheckReport& report, const std::string& name) {
+    std::mt19937_64 rng(31);
+    const double coefs[] = {0.0, 1.0, -1.0, 2.5, -0.3};
+    const std::pair<double, double> bands[] = {{-30.0, 40.0}, {0.0, 0.0}, {-1e9, 1e9}, {-5.0, 0.0}, {0.0, 12.0}};
+    double worstScaled = 0.0, worstClamped = 0.0, worstSelf = 0.0;
+    bool argOk = true;
+    for (int trial = 0; trial < 200; ++trial) {
+        auto pf = check_points(rng, 1 + trial % 40), pg = check_points(rng, 1 + (trial * 7) % 40, 10.0 * (trial % 3));
+        const F g = F::from_points(pg);
+        auto gBefore = g.to_points_delta();
+        std::vector<double> xs = check_xs(-1.0, 101.0, 0.31, {&pf, &pg});
+
+        for (double a : coefs) {
+            F f = F::from_points(pf);
+            f.add_scaled(g, a);
+            auto pr = f.to_points_delta();
+            for (double x : check_xs(-1.0, 101.0, 0.31, {&pf, &pg, &pr}))
+                worstScaled = std::max(worstScaled, std::abs(f.evaluate(x) - (check_ref(pf, x) + a * check_ref(pg, x))));
+
+            F s = F::from_points(pf);
+            s.add_scaled(s, a);
+            for (double x : xs) worstSelf = std::max(worstSelf, std::abs(s.evaluate(x) - (1.0 + a) * check_ref(pf, x)));
+        }
+        for (const auto& [lo, hi] : bands) {
+            F f = F::from_points(pf);
+            f.add_clamped(g, lo, hi);
+            auto pr = f.to_points_delta();
+            for (double x : check_xs(-1.0, 101.0, 0.31, {&pf, &pg, &pr})) {
+                double r = std::clamp(check_ref(pf, x) + check_ref(pg, x), lo, hi);
+                worstClamped = std::max(worstClamped, std::abs(f.evaluate(x) - r));
+            }
+        }
+        argOk &= g.to_points_delta() == gBefore;
+    }
+    report.expect(name + " add_scaled", worstScaled, 1e-9);
+    report.expect(name + " add_scaled on itself", worstSelf, 1e-9);
+    report.expect(name + " add_clamped", worstClamped, 1e-9);
+    report.expect(name + " argument left unchanged", argOk);
+}
+
+int main() {
+    CheckReport report;
+    std::cout << std::setprecision(3);
+    check_backend<RedBlackTree<DeltaPoint>>(report, "rbt");
+    check_backend<RedBlackTree<DeltaPoint, Augment<SumDelta>>>(report, "rbt_sumdelta");
+    check_backend<PiecewiseLinearFunction>(report, "map");
+    check_backend<FlatPiecewise>(report, "flat");
+    PiecewiseFunction::setThresholds(16, 8);
+    check_backend<PiecewiseFunction>(report, "adaptive");
+    PiecewiseFunction::setThresholds(256, 64);
+    return report.finish();
+}
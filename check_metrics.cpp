@@ -0,0 +1,58 @@
+// Contrôle de l'instrumentation (metrics.cpp) : l'arbre et la std::map doivent compter les mêmes choses pour les
+// mêmes appels. Un appel à addBreakpoint, insert, removeBreakpoint ou remove donne une mesure de latence Insert
+// ou Remove, et un point touché seulement s'il écrit ou retire un point (retirer un point absent ne compte
+// pas) ; apply_delta compte les points de g une seule fois, sans y ajouter ses insertions internes.
+//
+//     g++ -std=c++20 -O2 check_metrics.cpp -o check_metrics && ./check_metrics
+#define PROFILE_METRICS 1
+#include "RBT_sarah.cpp"
+#include "piecewise_function.cpp"
+#include "check_core.cpp"
+
+struct MetricCounts {
+    uint64_t inserts = 0, removes = 0, touched = 0;
+};
+
+inline MetricCounts metric_counts() {
+    MetricsSnapshot s = Metrics::snapshot();
+    return {s[MetricOp::Insert].count, s[MetricOp::Remove].count, s[MetricCounter::BreakpointsTouched]};
+}
+
+template <typename F>
+void check_backend(CheckReport& report, const std::string& name) {
+    std::mt19937_64 rng(43);
+    auto pts = check_points(rng, 200);
+    const uint64_t k = pts.size();
+
+    Metrics::reset();
+    F f;
+    for (const auto& [x, d] : pts) f.addBreakpoint(x, d);           // k nouveaux points
+    for (const auto& [x, d] : pts) f.addBreakpoint(x, 2.0 * d);     // k points remplacés
+    if constexpr (requires { f.insert(DeltaPoint{0.0, 0.0}); })
+        for (const auto& [x, d] : pts) f.insert(DeltaPoint{x + 0.05, d}); // k points entre deux autres
+    else
+        for (const auto& [x, d] : pts) f.addBreakpoint(x + 0.05, d);
+    for (const auto& [x, d] : pts) f.removeBreakpoint(x + 0.05);    // k points retirés
+    for (const auto& [x, d] : pts) f.removeBreakpoint(x + 0.07);    // k points absents
+    MetricCounts c = metric_counts();
+    report.expect(name + " insert latency samples", c.inserts == 3 * k);
+    report.expect(name + " remove latency samples", c.removes == 2 * k);
+    report.expect(name + " breakpoints touched by add / insert / remove", c.touched == 4 * k);
+
+    auto pg = check_points(rng, 50);
+    for (auto& [x, d] : pg) x += 0.05; // abscisses absentes de f : apply_delta insère
+    F g = F::from_points(pg);
+    Metrics::reset();
+    f.apply_delta(g, 0.5);
+    c = metric_counts();
+    report.expect(name + " breakpoints touched by apply_delta", c.touched == pg.size());
+    report.expect(name + " apply_delta records no insert", c.inserts == 0);
+}
+
+int main() {
+    CheckReport report;
+    check_backend<RedBlackTree<DeltaPoint>>(report, "rbt");
+    check_backend<RedBlackTree<DeltaPoint, Augment<SumDelta>>>(report, "rbt_sumdelta");
+    check_backend<PiecewiseLinearFunction>(report, "map");
+    return report.finish();
+}
@@ -0,0 +1,65 @@
+// Contrôle du réseau de profils (profile_network.cpp) sur l'arbre et la std::map : après une suite de mises à
+// jour update_cbr_* des bases (workload.cpp), chaque dérivée propagée par apply_delta doit rester égale à la
+// combinaison de ses bases, évaluée point par point.
+//
+//     g++ -std=c++20 -O2 check_network.cpp -o check_network && ./check_network
+#include "RBT_sarah.cpp"
+#include "piecewise_map.cpp"
+#include "profile_network.cpp"
+#include "workload.cpp"
+#include "check_core.cpp"
+
+template <typename F>
+void check_backend(CheckReport& report, const std::string& name) {
+    using Id = typename ProfileNetwork<F>::Id;
+    ProfileNetwork<F> net;
+    std::vector<Id> bases;
+    std::vector<std::vector<CbrUpdate>> streams;
+    for (uint64_t seed = 1; seed <= 3; ++seed) {
+        WorkloadSpec spec;
+        spec.tasks = 200;
+        spec.horizon = 1000.0;
+        spec.seed = seed;
+        std::vector<WorkloadTask> tasks = generate_tasks(spec);
+        bases.push_back(net.add_base(F::from_points(workload_profile_points(tasks))));
+        streams.push_back(generate_updates(tasks, spec, 2000));
+    }
+    auto [a, b, c] = std::tuple{bases[0], bases[1], bases[2]};
+    Id d = net.add_derived({{a, 1.0}, {b, -1.0}, {c, 1.0}});
+    Id e = net.add_derived({{a, 0.5}, {d, 2.0}}); // dérivée d'une dérivée : 2,5 a - 2 b + 2 c
+
+    // mises à jour entrelacées des trois bases
+    for (size_t i = 0; i < streams[0].size(); ++i)
+        for (size_t k = 0; k < bases.size(); ++k) {
+            const CbrUpdate& u = streams[k][i];
+            switch (u.kind) {
+            case CbrKind::StMin: net.update_cbr_stmin(bases[k], u.a, u.b, u.c, u.d, u.e); break;
+            case CbrKind::CtMin: net.update_cbr_ctmin(bases[k], u.a, u.b, u.c, u.d, u.e); break;
+            case CbrKind::StMax: net.update_cbr_stmax(bases[k], u.a, u.b, u.c, u.d, u.e); break;
+            case CbrKind::CtMax: net.update_cbr_ctmax(bases[k], u.a, u.b, u.c, u.d, u.e); break;
+            case CbrKind::Cap:   net.update_cbr_cap(bases[k], u.a, u.b, u.c, u.d); break;
+            case CbrKind::COUNT: break;
+            }
+        }
+
+    std::vector<std::pair<double, double>> pts;
+    for (Id id : {a, b, c, d, e})
+        for (const auto& p : net.get(id).to_points_delta()) pts.push_back(p);
+    double worstD = 0.0, worstE = 0.0, scale = 1.0;
+    for (double x : check_xs(-10.0, 1100.0, 0.7, {&pts})) {
+        double fa = net.get(a).evaluate(x), fb = net.get(b).evaluate(x), fc = net.get(c).evaluate(x);
+        scale = std::max({scale, std::abs(fa), std::abs(fb), std::abs(fc)});
+        worstD = std::max(worstD, std::abs(net.get(d).evaluate(x) - (fa - fb + fc)));
+        worstE = std::max(worstE, std::abs(net.get(e).evaluate(x) - (2.5 * fa - 2.0 * fb + 2.0 * fc)));
+    }
+    report.expect(name + " derived a - b + c", worstD / scale, 1e-9);
+    report.expect(name + " derived 0.5 a + 2 (a - b + c)", worstE / scale, 1e-9);
+}
+
+int main() {
+    CheckReport report;
+    std::cout << std::setprecision(3);
+    check_backend<RedBlackTree<DeltaPoint>>(report, "rbt");
+    check_backend<PiecewiseLinearFunction>(report, "map");
+    return report.finish();
+}
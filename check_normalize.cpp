@@ -0,0 +1,74 @@
+// Contrôle de normalize sur l'arbre, la std::map, les tableaux triés et la façade : retirer les points
+// redondants ne doit pas changer f. Les profils aléatoires contiennent des points alignés ajoutés exprès, des
+// paliers, et des paires de points à moins de EPSILON l'un de l'autre (segments presque verticaux, ou second
+// point sans saut). Les valeurs avant et après normalize sont comparées sur une grille et en tous les points ;
+// les points alignés ajoutés doivent disparaître. Même contrôle pour sum sous setAutoNormalize(true).
+//
+//     g++ -std=c++20 -O2 check_normalize.cpp -o check_normalize && ./check_normalize
+#include "RBT_sarah.cpp"
+#include "piecewise_function.cpp"
+#include "check_core.cpp"
+
+// Profil aléatoire : points de check_points, un point aligné au milieu de chaque segment sur deux, un palier,
+// et quelques voisins à 1e-7..1e-5 (deltaY quelconque ou nul)
+std::vector<std::pair<double, double>> normalize_points(std::mt19937_64& rng, size_t n, size_t& aligned) {
+    auto base = check_points(rng, n);
+    std::uniform_real_distribution<double> ud(-50.0, 50.0), ue(-7.0, -5.0);
+    std::vector<std::pair<double, double>> pts;
+    aligned = 0;
+    for (size_t i = 0; i < base.size(); ++i) {
+        auto [x, d] = base[i];
+        if (i % 7 == 3) d = 0.0; // palier
+        if (i > 0 && i % 2 == 0) { // milieu aligné : deltaY partagé en deux
+            pts.push_back({0.5 * (pts.back().first + x), 0.5 * d});
+            d *= 0.5;
+            ++aligned;
+        }
+        pts.push_back({x, d});
+        if (i % 5 == 1 && i + 1 < base.size()) pts.push_back({x + std::pow(10.0, ue(rng)), rng() % 2 ? ud(rng) : 0.0});
+    }
+    return pts;
+}
+
+template <typename F>
+void check_backend(CheckReport& report, const std::string& name) {
+    std::mt19937_64 rng(26);
+    double worst = 0.0, worstAuto = 0.0;
+    bool removedAligned = true;
+    for (int t = 0; t < 300; ++t) {
+        size_t aligned = 0;
+        auto pf = normalize_points(rng, 5 + t % 60, aligned);
+        F f = F::from_points(pf);
+        size_t removed = f.normalize();
+        removedAligned &= removed >= aligned;
+        auto pr = f.to_points_delta();
+        for (double x : check_xs(-1.0, 101.0, 0.07, {&pf, &pr}))
+            worst = std::max(worst, std::abs(f.evaluate(x) - check_ref(pf, x)));
+
+        // zip sous normalisation automatique : croisements et points des opérandes à moins de EPSILON
+        size_t unused = 0;
+        auto pg = normalize_points(rng, 5 + (t * 3) % 60, unused);
+        F a = F::from_points(pf), b = F::from_points(pg);
+        a.setAutoNormalize(true);
+        a.sum(b);
+        a.minfunction(b);
+        auto pa = a.to_points_delta();
+        for (double x : check_xs(-1.0, 101.0, 0.07, {&pf, &pg, &pa})) {
+            double fx = check_ref(pf, x), gx = check_ref(pg, x);
+            worstAuto = std::max(worstAuto, std::abs(a.evaluate(x) - std::min(fx + gx, gx)));
+        }
+    }
+    report.expect(name + " normalize keeps f", worst, 1e-6);
+    report.expect(name + " normalize removes aligned points", removedAligned);
+    report.expect(name + " sum + minfunction under setAutoNormalize", worstAuto, 1e-6);
+}
+
+int main() {
+    CheckReport report;
+    std::cout << std::setprecision(3);
+    check_backend<RedBlackTree<DeltaPoint>>(report, "rbt");
+    check_backend<PiecewiseLinearFunction>(report, "map");
+    check_backend<FlatPiecewise>(report, "flat");
+    check_backend<PiecewiseFunction>(report, "adaptive");
+    return report.finish();
+}
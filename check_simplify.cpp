@@ -0,0 +1,78 @@
+// Contrôle de la simplification à erreur bornée (simplify, simplify_upper, simplify_lower, simplify_to) sur
+// l'arbre, la std::map, les tableaux triés et la façade : la fonction simplifiée g doit rester dans la bande
+// demandée autour de f (|g - f| <= e, f <= g <= f + e, f - e <= g <= f), calculée directement sur les points
+// de f, et simplify_to(k) doit garder au plus max(k, 2) points avec l'erreur annoncée, y compris pour une
+// fonction constante.
+//
+//     g++ -std=c++20 -O2 check_simplify.cpp -o check_simplify && ./check_simplify
+#include "RBT_sarah.cpp"
+#include "piecewise_function.cpp"
+#include "check_core.cpp"
+
+// Plus grand dépassement de la bande [f + lo, f + hi] par g = simplify(f), sur trials profils aléatoires
+template <typename F, typename Simplify>
+double band_excess(std::mt19937_64& rng, int trials, double lo, double hi, Simplify simplify) {
+    double worst = 0.0;
+    for (int t = 0; t < trials; ++t) {
+        auto pf = check_points(rng, 5 + t % 200);
+        F g = F::from_points(pf);
+        simplify(g);
+        auto pg = g.to_points_delta();
+        if (pg.size() > pf.size()) return std::numeric_limits<double>::infinity();
+        for (double x : check_xs(-1.0, 101.0, 0.13, {&pf, &pg})) {
+            double d = g.evaluate(x) - check_ref(pf, x);
+            worst = std::max({worst, d - hi, lo - d});
+        }
+    }
+    return worst;
+}
+
+template <typename F>
+void check_backend(CheckReport& report, const std::string& name) {
+    std::mt19937_64 rng(27);
+    const int trials = 200;
+    const double tol = 1e-9;
+    for (double e : {0.0, 0.5, 5.0, 40.0}) {
+        std::string band = "(" + std::to_string(e).substr(0, 4) + ")";
+        report.expect(name + " simplify" + band,
+                      band_excess<F>(rng, trials, -e, e, [e](F& g) { g.simplify(e); }), tol);
+        report.expect(name + " simplify_upper" + band,
+                      band_excess<F>(rng, trials, 0.0, e, [e](F& g) { g.simplify_upper(e); }), tol);
+        report.expect(name + " simplify_lower" + band,
+                      band_excess<F>(rng, trials, -e, 0.0, [e](F& g) { g.simplify_lower(e); }), tol);
+    }
+
+    // simplify_to(k) : au plus max(k, 2) points, erreur annoncée respectée
+    double worst = 0.0;
+    bool fits = true;
+    for (int t = 0; t < trials; ++t) {
+        auto pf = check_points(rng, 5 + t % 200);
+        size_t k = 1 + t % 30;
+        F g = F::from_points(pf);
+        double err = g.simplify_to(k);
+        auto pg = g.to_points_delta();
+        fits &= pg.size() <= std::max<size_t>(k, 2);
+        for (double x : check_xs(-1.0, 101.0, 0.13, {&pf, &pg}))
+            worst = std::max(worst, std::abs(g.evaluate(x) - check_ref(pf, x)) - err);
+    }
+    report.expect(name + " simplify_to error", worst, tol);
+    report.expect(name + " simplify_to max_points", fits);
+
+    // fonction constante : l'erreur nécessaire est nulle, les points doivent partir quand même
+    std::vector<std::pair<double, double>> flat = {{0.0, 3.0}};
+    for (int i = 1; i < 20; ++i) flat.push_back({double(i), 0.0});
+    F c = F::from_points(flat);
+    double err = c.simplify_to(3);
+    report.expect(name + " simplify_to(3) on a constant", c.to_points_delta().size() <= 3 && err == 0.0 &&
+                                                              c.evaluate(0.0) == 3.0 && c.evaluate(25.0) == 3.0);
+}
+
+int main() {
+    CheckReport report;
+    std::cout << std::setprecision(3);
+    check_backend<RedBlackTree<DeltaPoint>>(report, "rbt");
+    check_backend<PiecewiseLinearFunction>(report, "map");
+    check_backend<FlatPiecewise>(report, "flat");
+    check_backend<PiecewiseFunction>(report, "adaptive");
+    return report.finish();
+}
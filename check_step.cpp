@@ -0,0 +1,171 @@
+// Contrôle de l'interpolation en escalier (politique Step de piecewise_core.cpp) sur StepTree (avec et sans
+// SumDelta) et FlatStep : f(x) est la somme des deltaY des points d'abscisse <= x, sans interpolation (continue à
+// droite). Chaque opération est comparée point par point à cette référence calculée sur les points des
+// opérandes, de part et d'autre de chaque saut : evaluate, sum, minus, add_scaled, add_clamped, apply_delta,
+// negate, min / max avec une fonction (pas de croisement) ou une constante, sum_all, enveloppes,
+// evaluate_max / evaluate_min, isLessOrEqual ; normalize doit garder la fonction et retirer tous les sauts nuls,
+// simplify(e) rester à e près avec au plus autant de points.
+//
+//     g++ -std=c++20 -O2 check_step.cpp -o check_step && ./check_step
+#include "RBT_sarah.cpp"
+#include "piecewise_flat.cpp"
+#include "check_core.cpp"
+
+using Points = std::vector<std::pair<double, double>>;
+
+// Valeur en x de la fonction en escalier décrite par ses points
+inline double step_ref(const Points& pts, double x) {
+    double y = 0.0;
+    for (const auto& [xi, d] : pts) {
+        if (xi > x) break;
+        y += d;
+    }
+    return y;
+}
+
+// Points (x, deltaY) quelconques : premier saut non nul, quelques sauts nuls
+inline Points step_points(std::mt19937_64& rng, size_t n, double lo = 0.0, double hi = 100.0) {
+    Points pts = check_points(rng, n, lo, hi);
+    std::uniform_real_distribution<double> ud(-50.0, 50.0);
+    for (size_t i = 0; i < pts.size(); ++i) pts[i].second = i % 9 == 4 ? 0.0 : ud(rng);
+    return pts;
+}
+
+// Abscisses de contrôle : grille, chaque point et juste avant chaque point
+inline std::vector<double> step_xs(std::initializer_list<const Points*> pts) {
+    std::vector<double> xs = check_xs(-1.0, 101.0, 0.37, {});
+    for (const auto* p : pts)
+        for (const auto& [x, d] : *p) {
+            xs.push_back(x);
+            xs.push_back(x - 1e-7);
+        }
+    return xs;
+}
+
+template <typename F>
+void check_backend(CheckReport& report, const std::string& name) {
+    std::mt19937_64 rng(41);
+    std::uniform_real_distribution<double> uw(-2.0, 2.0), uc(-30.0, 30.0), ux(-5.0, 105.0);
+    const char* names[] = {"evaluate", "sum",          "minus",        "add_scaled",   "add_clamped",
+                           "apply_delta", "negate",    "max(f, g)",    "min(f, g)",    "max(f, c)",
+                           "min(f, c)", "sum_all",     "envelope_max", "envelope_min", "evaluate_max / min",
+                           "normalize", "simplify"};
+    double worst[std::size(names)] = {};
+    bool lessOk = true, normalizeOk = true, simplifyOk = true;
+    for (int trial = 0; trial < 200; ++trial) {
+        Points pf = step_points(rng, 1 + trial % 40), pg = step_points(rng, 1 + (trial * 7) % 40, 10.0 * (trial % 3));
+        const F f = F::from_points(pf), g = F::from_points(pg);
+        std::vector<double> xs = step_xs({&pf, &pg});
+        auto track = [&](size_t k, const F& r, auto ref) {
+            for (double x : xs) worst[k] = std::max(worst[k], std::abs(r.evaluate(x) - ref(x)));
+        };
+        auto fv = [&](double x) { return step_ref(pf, x); };
+        auto gv = [&](double x) { return step_ref(pg, x); };
+
+        track(0, f, fv);
+        double a = uw(rng), c = uc(rng);
+        F r = f;
+        r.sum(g);
+        track(1, r, [&](double x) { return fv(x) + gv(x); });
+        r = f;
+        r.minus(g);
+        track(2, r, [&](double x) { return fv(x) - gv(x); });
+        r = f;
+        r.add_scaled(g, a);
+        track(3, r, [&](double x) { return fv(x) + a * gv(x); });
+        r = f;
+        r.add_clamped(g, -std::abs(c), 20.0);
+        track(4, r, [&](double x) { return std::clamp(fv(x) + gv(x), -std::abs(c), 20.0); });
+        r = f;
+        r.apply_delta(g, a);
+        track(5, r, [&](double x) { return fv(x) + a * gv(x); });
+        r = f;
+        r.negate();
+        track(6, r, [&](double x) { return -fv(x); });
+        r = f;
+        r.maxfunction(g);
+        track(7, r, [&](double x) { return std::max(fv(x), gv(x)); });
+        r = f;
+        r.minfunction(g);
+        track(8, r, [&](double x) { return std::min(fv(x), gv(x)); });
+        // constantes définies à partir de x = 0
+        r = f;
+        r.maxfunction(c);
+        track(9, r, [&](double x) { return std::max(fv(x), x >= 0.0 ? c : 0.0); });
+        r = f;
+        r.minfunction(c);
+        track(10, r, [&](double x) { return std::min(fv(x), x >= 0.0 ? c : 0.0); });
+
+        // K fonctions (f, g et d'autres)
+        std::vector<Points> ps{pf, pg};
+        for (int k = 0; k < trial % 5; ++k) ps.push_back(step_points(rng, 1 + (trial + k) % 30, 15.0 * k));
+        std::vector<F> fs;
+        for (const auto& p : ps) fs.push_back(F::from_points(p));
+        std::vector<const F*> ptrs;
+        for (const F& h : fs) ptrs.push_back(&h);
+        std::vector<double> kx = xs;
+        for (const auto& p : ps)
+            for (const auto& [x, d] : p) kx.insert(kx.end(), {x, x - 1e-7});
+        F s = F::sum_all(ptrs), hi = F::envelope_max(ptrs), lo = F::envelope_min(ptrs);
+        for (double x : kx) {
+            double sum = 0.0, top = -1e300, bottom = 1e300;
+            for (const auto& p : ps) {
+                double v = step_ref(p, x);
+                sum += v;
+                top = std::max(top, v);
+                bottom = std::min(bottom, v);
+            }
+            worst[11] = std::max(worst[11], std::abs(s.evaluate(x) - sum));
+            worst[12] = std::max(worst[12], std::abs(hi.evaluate(x) - top));
+            worst[13] = std::max(worst[13], std::abs(lo.evaluate(x) - bottom));
+        }
+
+        // fenêtres [t_inf, t_sup] : valeur en t_inf et à chaque saut de ]t_inf, t_sup]
+        for (int w = 0; w < 10; ++w) {
+            double t0 = ux(rng), t1 = w % 5 == 0 ? t0 : ux(rng);
+            if (t1 < t0) std::swap(t0, t1);
+            double top = fv(t0), bottom = top;
+            for (const auto& [x, d] : pf)
+                if (x > t0 && x <= t1) {
+                    top = std::max(top, fv(x));
+                    bottom = std::min(bottom, fv(x));
+                }
+            worst[14] = std::max({worst[14], std::abs(f.evaluate_max(t0, t1) - top),
+                                  std::abs(f.evaluate_min(t0, t1) - bottom)});
+        }
+
+        // f <= g aux sauts de l'un ou de l'autre (et avant le premier, où les deux valent 0)
+        bool le = true;
+        for (double x : xs) le &= fv(x) <= gv(x);
+        F upper = f;
+        upper.maxfunction(g);
+        lessOk &= f.isLessOrEqual(g) == le && f.isLessOrEqual(upper) && g.isLessOrEqual(upper);
+
+        r = f;
+        r.normalize();
+        track(15, r, fv);
+        Points pn = r.to_points_delta();
+        normalizeOk &= pn.size() <= pf.size();
+        for (const auto& [x, d] : pn) normalizeOk &= d != 0.0;
+
+        const double e = 0.1 + 5.0 * (trial % 4);
+        r = f;
+        r.simplify(e);
+        double err = 0.0;
+        for (double x : xs) err = std::max(err, std::abs(r.evaluate(x) - fv(x)));
+        simplifyOk &= err <= e + 1e-9 && r.to_points_delta().size() <= pf.size();
+    }
+    for (size_t k = 0; k < std::size(names); ++k) report.expect(name + " " + names[k], worst[k], 1e-9);
+    report.expect(name + " isLessOrEqual", lessOk);
+    report.expect(name + " normalize drops every zero jump", normalizeOk);
+    report.expect(name + " simplify stays within the error", simplifyOk);
+}
+
+int main() {
+    CheckReport report;
+    std::cout << std::setprecision(3);
+    check_backend<StepTree<>>(report, "step_rbt");
+    check_backend<StepTree<Augment<SumDelta>>>(report, "step_rbt_sumdelta");
+    check_backend<FlatStep>(report, "step_flat");
+    return report.finish();
+}
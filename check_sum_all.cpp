@@ -0,0 +1,74 @@
+// Contrôle de la somme k-way sum_all sur l'arbre (avec et sans SumDelta), la std::map, les tableaux triés et la
+// façade : comparaison à la somme pondérée des K fonctions calculée directement sur leurs points, pour K de 0 à
+// 24, des profils de débuts et de longueurs différents, sans poids (tous à 1), avec des poids négatifs ou nuls,
+// et la même fonction passée plusieurs fois.
+//
+//     g++ -std=c++20 -O2 check_sum_all.cpp -o check_sum_all && ./check_sum_all
+#include "RBT_sarah.cpp"
+#include "piecewise_function.cpp"
+#include "check_core.cpp"
+
+template <typename F>
+void check_backend(CheckReport& report, const std::string& name) {
+    std::mt19937_64 rng(29);
+    std::uniform_real_distribution<double> uw(-3.0, 3.0);
+    double worstPlain = 0.0, worstWeighted = 0.0, worstRepeated = 0.0;
+    bool emptyOk = true;
+    for (int trial = 0; trial < 250; ++trial) {
+        size_t k = trial % 25;
+        std::vector<std::vector<std::pair<double, double>>> pts;
+        std::vector<F> fs;
+        for (size_t i = 0; i < k; ++i) {
+            pts.push_back(check_points(rng, 1 + (trial + 3 * i) % 40, 7.0 * double(i % 5), 100.0));
+            fs.push_back(F::from_points(pts.back()));
+        }
+        std::vector<const F*> ptrs;
+        for (const F& f : fs) ptrs.push_back(&f);
+        std::vector<double> ws(k);
+        for (size_t i = 0; i < k; ++i) ws[i] = i % 7 == 3 ? 0.0 : uw(rng);
+
+        F plain = F::sum_all(ptrs), weighted = F::sum_all(ptrs, ws);
+        if (k == 0) emptyOk &= plain.to_points_delta().empty() && weighted.to_points_delta().empty();
+
+        auto pp = plain.to_points_delta(), pw = weighted.to_points_delta();
+        std::vector<double> xs = check_xs(-1.0, 101.0, 0.29, {&pp, &pw});
+        for (const auto& p : pts)
+            for (const auto& [x, d] : p) xs.push_back(x);
+        for (double x : xs) {
+            double s = 0.0, sw = 0.0;
+            for (size_t i = 0; i < k; ++i) {
+                double v = check_ref(pts[i], x);
+                s += v;
+                sw += ws[i] * v;
+            }
+            worstPlain = std::max(worstPlain, std::abs(plain.evaluate(x) - s));
+            worstWeighted = std::max(worstWeighted, std::abs(weighted.evaluate(x) - sw));
+        }
+
+        // la même fonction trois fois, poids 1, -2 et 0,5 : -0,5 f
+        if (k > 0) {
+            std::vector<const F*> same{ptrs[0], ptrs[0], ptrs[0]};
+            std::vector<double> w3{1.0, -2.0, 0.5};
+            F r = F::sum_all(same, w3);
+            for (double x : xs)
+                worstRepeated = std::max(worstRepeated, std::abs(r.evaluate(x) + 0.5 * check_ref(pts[0], x)));
+        }
+    }
+    report.expect(name + " sum_all", worstPlain, 1e-9);
+    report.expect(name + " sum_all weighted", worstWeighted, 1e-9);
+    report.expect(name + " sum_all repeated operand", worstRepeated, 1e-9);
+    report.expect(name + " sum_all of no function is empty", emptyOk);
+}
+
+int main() {
+    CheckReport report;
+    std::cout << std::setprecision(3);
+    check_backend<RedBlackTree<DeltaPoint>>(report, "rbt");
+    check_backend<RedBlackTree<DeltaPoint, Augment<SumDelta>>>(report, "rbt_sumdelta");
+    check_backend<PiecewiseLinearFunction>(report, "map");
+    check_backend<FlatPiecewise>(report, "flat");
+    PiecewiseFunction::setThresholds(16, 8);
+    check_backend<PiecewiseFunction>(report, "adaptive");
+    PiecewiseFunction::setThresholds(256, 64);
+    return report.finish();
+}
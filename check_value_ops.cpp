@@ -0,0 +1,91 @@
+// Contrôle de la sémantique de valeur de RedBlackTree (avec et sans SumDelta) : f + g, f - g et -f pour toutes
+// les combinaisons lvalue / rvalue, maxWithC / minWithC, comparés point par point à la référence calculée sur
+// les points des opérandes ; les opérandes lvalue doivent ressortir inchangés. Copie indépendante de
+// l'original, auto-affectation, déplacement (source vide). Compilé avec PROFILE_METRICS : déplacements, -f sur
+// une rvalue et retours par valeur des fabriques (from_points, delta_profile) n'allouent aucun noeud de plus.
+//
+//     g++ -std=c++20 -O2 check_value_ops.cpp -o check_value_ops && ./check_value_ops
+#define PROFILE_METRICS 1
+#include "RBT_sarah.cpp"
+#include "check_core.cpp"
+
+inline uint64_t node_allocs() { return Metrics::snapshot()[MetricCounter::NodeAllocs]; }
+
+template <typename Tree>
+void check_backend(CheckReport& report, const std::string& name) {
+    using Points = std::vector<std::pair<double, double>>;
+    std::mt19937_64 rng(34);
+    double worst[8] = {};
+    const char* names[] = {"f + g", "f&& + g", "f + g&&", "f&& + g&&", "f - g", "f&& - g", "f - g&&", "-f / -f&&"};
+    double worstC = 0.0;
+    bool operandsOk = true, copyOk = true, moveOk = true, selfOk = true;
+    for (int trial = 0; trial < 200; ++trial) {
+        Points pf = check_points(rng, 1 + trial % 40), pg = check_points(rng, 1 + (trial * 3) % 40, 10.0 * (trial % 3));
+        const Tree f = Tree::from_points(pf), g = Tree::from_points(pg);
+        auto fresh = [](const Points& p) { return Tree::from_points(p); };
+
+        Tree r[8] = {f + g, fresh(pf) + g, f + fresh(pg), fresh(pf) + fresh(pg),
+                     f - g, fresh(pf) - g, f - fresh(pg), -f};
+        Tree negMoved = -fresh(pf);
+        Tree hi = f.maxWithC(7.5), lo = f.minWithC(-4.0);
+        for (double x : check_xs(-1.0, 101.0, 0.33, {&pf, &pg})) {
+            double a = check_ref(pf, x), b = check_ref(pg, x);
+            for (int k = 0; k < 4; ++k) worst[k] = std::max(worst[k], std::abs(r[k].evaluate(x) - (a + b)));
+            for (int k = 4; k < 7; ++k) worst[k] = std::max(worst[k], std::abs(r[k].evaluate(x) - (a - b)));
+            worst[7] = std::max({worst[7], std::abs(r[7].evaluate(x) + a), std::abs(negMoved.evaluate(x) + a)});
+            // constantes définies à partir de x = 0, comme les profils de contrôle
+            double c = x >= 0.0 ? 1.0 : 0.0;
+            worstC = std::max({worstC, std::abs(hi.evaluate(x) - std::max(a, 7.5 * c)),
+                               std::abs(lo.evaluate(x) - std::min(a, -4.0 * c))});
+        }
+        operandsOk &= f.to_points_delta() == pf && g.to_points_delta() == pg;
+
+        Tree copy = f;
+        copy.addBreakpoint(50.05, 3.0);
+        copy.negate();
+        copyOk &= f.to_points_delta() == pf;
+
+        Tree self = fresh(pf);
+        Tree& alias = self;
+        self = alias;
+        selfOk &= self.to_points_delta() == pf;
+
+        Tree src = fresh(pf);
+        Tree moved = std::move(src);
+        Tree assigned;
+        assigned = std::move(moved);
+        moveOk &= src.to_points_delta().empty() && moved.to_points_delta().empty() && assigned.to_points_delta() == pf;
+    }
+    for (int k = 0; k < 8; ++k) report.expect(name + " " + names[k], worst[k], 1e-9);
+    report.expect(name + " maxWithC / minWithC", worstC, 1e-9);
+    report.expect(name + " lvalue operands unchanged", operandsOk);
+    report.expect(name + " copy independent of the original", copyOk);
+    report.expect(name + " self-assignment", selfOk);
+    report.expect(name + " move leaves the source empty", moveOk);
+
+    // allocations de noeuds
+    Points pts = check_points(rng, 500);
+    Metrics::reset();
+    Tree f = Tree::from_points(pts);
+    bool factoryOk = node_allocs() == pts.size();
+    if constexpr (std::is_same_v<Tree, RedBlackTree<DeltaPoint>>) {
+        Tree d = delta_profile(2.0, 1.0, 3.0, 5.0);
+        factoryOk &= node_allocs() == pts.size() + 3;
+    }
+    report.expect(name + " factories return without copying", factoryOk);
+
+    Metrics::reset();
+    Tree m = std::move(f);
+    Tree n;
+    n = std::move(m);
+    Tree neg = -std::move(n);
+    report.expect(name + " moves and -f&& allocate no node", node_allocs() == 0);
+}
+
+int main() {
+    CheckReport report;
+    std::cout << std::setprecision(3);
+    check_backend<RedBlackTree<DeltaPoint>>(report, "rbt");
+    check_backend<RedBlackTree<DeltaPoint, Augment<SumDelta>>>(report, "rbt_sumdelta");
+    return report.finish();
+}
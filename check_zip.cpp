@@ -0,0 +1,124 @@
+// Contrôle du moteur de fusion (zip_deltas, piecewise_core.cpp) sur l'arbre, la std::map, les tableaux triés et
+// la façade : sum, minus, minfunction, maxfunction (fonction et constante) et add_clamped comparés point par
+// point à op(f(x), g(x)) calculé directement sur les points des opérandes, sur des profils aléatoires.
+//
+// Deuxième partie : une longue suite d'opérations (min, max, clamp, négation, sommes répétées) accumule des
+// croisements à moins de EPSILON les uns des autres ; eval doit rester cohérent avec ses propres points (somme
+// des deltaY, interpolation), et l'arbre et la std::map doivent donner la même fonction.
+//
+//     g++ -std=c++20 -O2 check_zip.cpp -o check_zip && ./check_zip
+#include "RBT_sarah.cpp"
+#include "piecewise_function.cpp"
+#include "check_core.cpp"
+
+using Tree = RedBlackTree<DeltaPoint>;
+
+// Écart maximal entre op appliqué sur place à F et la référence, sur trials paires de profils aléatoires
+template <typename F, typename Apply, typename Ref>
+double zip_error(std::mt19937_64& rng, int trials, Apply apply, Ref ref) {
+    double worst = 0.0;
+    for (int t = 0; t < trials; ++t) {
+        auto pf = check_points(rng, 5 + t % 40), pg = check_points(rng, 5 + (t * 7) % 40, 10.0 * (t % 3), 100.0);
+        F f = F::from_points(pf), g = F::from_points(pg);
+        apply(f, g);
+        auto pr = f.to_points_delta();
+        for (double x : check_xs(-1.0, 101.0, 0.37, {&pf, &pg, &pr}))
+            worst = std::max(worst, std::abs(f.evaluate(x) - ref(check_ref(pf, x), check_ref(pg, x))));
+    }
+    return worst;
+}
+
+template <typename F>
+void check_backend(CheckReport& report, const std::string& name) {
+    std::mt19937_64 rng(28);
+    const int trials = 300;
+    const double tol = 1e-9;
+    report.expect(name + " sum", zip_error<F>(rng, trials, [](F& f, const F& g) { f.sum(g); },
+                                              [](double a, double b) { return a + b; }), tol);
+    report.expect(name + " minus", zip_error<F>(rng, trials, [](F& f, const F& g) { f.minus(g); },
+                                                [](double a, double b) { return a - b; }), tol);
+    report.expect(name + " minfunction", zip_error<F>(rng, trials, [](F& f, const F& g) { f.minfunction(g); },
+                                                      [](double a, double b) { return std::min(a, b); }), tol);
+    report.expect(name + " maxfunction", zip_error<F>(rng, trials, [](F& f, const F& g) { f.maxfunction(g); },
+                                                      [](double a, double b) { return std::max(a, b); }), tol);
+    report.expect(name + " add_clamped", zip_error<F>(rng, trials, [](F& f, const F& g) { f.add_clamped(g, -30.0, 40.0); },
+                                                      [](double a, double b) { return std::clamp(a + b, -30.0, 40.0); }), tol);
+    // constante définie à partir de x = 0, comme les profils de contrôle
+    report.expect(name + " minfunction(c)", zip_error<F>(rng, trials, [](F& f, const F&) { f.minfunction(12.5); },
+                                                         [](double a, double) { return std::min(a, 12.5); }), tol);
+    report.expect(name + " maxfunction(c)", zip_error<F>(rng, trials, [](F& f, const F&) { f.maxfunction(-7.5); },
+                                                         [](double a, double) { return std::max(a, -7.5); }), tol);
+}
+
+// Suite d'opérations qui tasse des croisements sur quelques 1e-5 : points de départ communs pour les trois
+// représentations
+template <typename F>
+F crowded_profile() {
+    std::mt19937_64 rng(1);
+    std::uniform_real_distribution<double> ux(0.0, 10.0), ud(-1.0, 1.0);
+    auto make = [&]() {
+        std::vector<double> xs(200);
+        for (double& x : xs) x = ux(rng);
+        std::sort(xs.begin(), xs.end());
+        std::vector<std::pair<double, double>> pts;
+        for (double x : xs) pts.push_back({x, ud(rng)});
+        return pts;
+    };
+    auto pa = make(), pb = make();
+    F a = F::from_points(pa), b = F::from_points(pb);
+    for (int i = 0; i < 50; ++i) {
+        a.sum(b);
+        a.minfunction(b);
+        a.maxfunction(3.0);
+        a.negate();
+        a.add_clamped(b, -2.0, 2.0);
+        F c = a;
+        c.sum(b);
+        b = c;
+    }
+    return a;
+}
+
+// Écart entre eval et les points du profil, aux points et entre deux points consécutifs (amas compris)
+template <typename F>
+double self_error(const F& f) {
+    auto pts = f.to_points_delta();
+    double worst = 0.0;
+    for (size_t i = 0; i + 1 < pts.size(); ++i)
+        for (double t : {0.0, 0.25, 0.5, 0.75}) {
+            double x = pts[i].first + t * (pts[i + 1].first - pts[i].first);
+            worst = std::max(worst, std::abs(f.evaluate(x) - check_ref(pts, x)));
+        }
+    return worst;
+}
+
+int main() {
+    CheckReport report;
+    std::cout << std::setprecision(3);
+    check_backend<Tree>(report, "rbt");
+    check_backend<PiecewiseLinearFunction>(report, "map");
+    check_backend<FlatPiecewise>(report, "flat");
+    // façade, seuils abaissés : les profils de contrôle passent des tableaux à l'arbre augmenté et retour
+    PiecewiseFunction::setThresholds(16, 8);
+    check_backend<PiecewiseFunction>(report, "adaptive");
+    PiecewiseFunction::setThresholds(256, 64);
+
+    Tree tree = crowded_profile<Tree>();
+    PiecewiseLinearFunction map = crowded_profile<PiecewiseLinearFunction>();
+    FlatPiecewise flat = crowded_profile<FlatPiecewise>();
+    report.expect("rbt eval on crowded breakpoints", self_error(tree), 1e-9);
+    report.expect("map eval on crowded breakpoints", self_error(map), 1e-9);
+    report.expect("flat eval on crowded breakpoints", self_error(flat), 1e-9);
+
+    // arbre contre std::map, au milieu des segments de plus de 1e-3 (dans un amas, la fonction est un saut
+    // représenté par des segments presque verticaux : sa valeur n'y est pas significative)
+    auto pts = tree.to_points_delta();
+    double worst = 0.0;
+    for (size_t i = 0; i + 1 < pts.size(); ++i) {
+        if (pts[i + 1].first - pts[i].first < 1e-3) continue;
+        double x = 0.5 * (pts[i].first + pts[i + 1].first);
+        worst = std::max(worst, std::abs(tree.evaluate(x) - map.evaluate(x)));
+    }
+    report.expect("rbt vs map on crowded breakpoints", worst, 1e-9);
+    return report.finish();
+}
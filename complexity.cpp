@@ -0,0 +1,175 @@
+// Contrôle de complexité : chaque opération de chaque représentation est mesurée sur des tailles doublées
+// (bench_core.cpp), l'exposant de croissance est ajusté par moindres carrés sur log(ns/op) = k log n + c, et
+// le programme échoue (code 1) si une opération croît plus vite que sa borne déclarée.
+//
+// La comparaison se fait sur le rapport mesure / borne : pente de log(ns / b(n)) en fonction de log n, qui doit
+// rester sous --tolerance (0,3 par défaut, marge pour les caches qui débordent quand n grandit). Une opération
+// O(log n) devenue O(√n) donne une pente proche de 0,5, une boucle quadratique réintroduite (eval par point
+// dans un parcours, copie complète dans sum...) une pente proche de 1 : les deux font échouer le contrôle.
+// Chaque taille garde la meilleure de --repeat passes (5 par défaut). Sans réseau ni fichier de référence :
+// utilisable comme test.
+//
+//     g++ -std=c++20 -O2 -DNDEBUG complexity.cpp -o complexity && ./complexity
+//     ./complexity --min-n 1024 --max-n 262144 --repeat 5 --filter update_cbr
+#include "RBT_sarah.cpp"
+#include "piecewise_function.cpp"
+#include "bench_core.cpp"
+#include <map>
+
+enum class Bound { Log, Linear, NLogN, Quadratic };
+
+inline const char* boundName(Bound b) {
+    switch (b) {
+    case Bound::Log:       return "O(log n)";
+    case Bound::Linear:    return "O(n)";
+    case Bound::NLogN:     return "O(n log n)";
+    case Bound::Quadratic: return "O(n^2)";
+    }
+    return "?";
+}
+
+inline double boundValue(Bound b, double n) {
+    switch (b) {
+    case Bound::Log:       return std::log2(n);
+    case Bound::Linear:    return n;
+    case Bound::NLogN:     return n * std::log2(n);
+    case Bound::Quadratic: return n * n;
+    }
+    return n;
+}
+
+// Borne déclarée d'une opération (coût d'un appel sur un profil de n points) : celle de l'opération, sauf
+// exception propre à une représentation (backend vide = toutes)
+struct DeclaredBound {
+    const char* backend;
+    const char* op;
+    Bound bound;
+};
+
+inline const std::vector<DeclaredBound>& declared_bounds() {
+    static const std::vector<DeclaredBound> bounds = {
+        {"", "insert", Bound::Log},
+        {"", "remove", Bound::Log},
+        {"", "eval", Bound::Log},
+        {"", "sum", Bound::NLogN},
+        {"", "minus", Bound::NLogN},
+        {"", "negate", Bound::Linear},
+        {"", "minfunction", Bound::NLogN},
+        {"", "maxfunction", Bound::NLogN},
+        {"", "evaluate_max", Bound::Log}, // fenêtre de 32 points : O(log n + k), k fixe
+        {"", "isLessOrEqual", Bound::Linear},
+        {"", "update_cbr_stmin", Bound::Log},
+        {"", "update_cbr_ctmin", Bound::Log},
+        {"", "update_cbr_stmax", Bound::Log},
+        {"", "update_cbr_ctmax", Bound::Log},
+        {"", "update_cbr_cap", Bound::Log},
+        // arbre sans augmentation : eval additionne tous les deltaY à gauche de x
+        {"rbt", "eval", Bound::Linear},
+        {"rbt", "evaluate_max", Bound::Linear},
+        // tableaux triés : insertion et suppression décalent la fin du tableau
+        {"flat", "insert", Bound::Linear},
+        {"flat", "remove", Bound::Linear},
+        {"flat", "update_cbr_stmin", Bound::Linear},
+        {"flat", "update_cbr_ctmin", Bound::Linear},
+        {"flat", "update_cbr_stmax", Bound::Linear},
+        {"flat", "update_cbr_ctmax", Bound::Linear},
+        {"flat", "update_cbr_cap", Bound::Linear},
+    };
+    return bounds;
+}
+
+inline Bound bound_of(const std::string& backend, const std::string& op) {
+    Bound b = Bound::Quadratic;
+    for (const DeclaredBound& d : declared_bounds()) {
+        if (op != d.op) continue;
+        if (backend == d.backend) return d.bound;
+        if (!*d.backend) b = d.bound;
+    }
+    return b;
+}
+
+// Pente des moindres carrés de y en fonction de x
+inline double fit_slope(const std::vector<double>& x, const std::vector<double>& y) {
+    double mx = 0.0, my = 0.0;
+    for (size_t i = 0; i < x.size(); ++i) {
+        mx += x[i];
+        my += y[i];
+    }
+    mx /= double(x.size());
+    my /= double(y.size());
+    double sxy = 0.0, sxx = 0.0;
+    for (size_t i = 0; i < x.size(); ++i) {
+        sxy += (x[i] - mx) * (y[i] - my);
+        sxx += (x[i] - mx) * (x[i] - mx);
+    }
+    return sxx > 0.0 ? sxy / sxx : 0.0;
+}
+
+int main(int argc, char** argv) {
+    // options propres au contrôle, retirées avant parse_bench_args
+    double tolerance = 0.3;
+    int repeat = 5;
+    std::vector<char*> rest{argv[0]};
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--tolerance" && i + 1 < argc) tolerance = std::stod(argv[++i]);
+        else if (a == "--repeat" && i + 1 < argc) repeat = std::max(1, std::stoi(argv[++i]));
+        else rest.push_back(argv[i]);
+    }
+
+    BenchOptions defaults;
+    defaults.minN = 256;
+    defaults.maxN = 32768;
+    defaults.growth = 2;
+    defaults.minTimeMs = 10.0;
+    defaults.batch = 256;
+    defaults.quiet = true;
+    BenchOptions opt = parse_bench_args(int(rest.size()), rest.data(), defaults);
+
+    // façade : seuils sous la plus petite taille, toutes les mesures en mode arbre (un passage des tableaux à
+    // l'arbre au milieu de la plage est un saut de constante, que l'ajustement prendrait pour une croissance ;
+    // le mode tableaux est mesuré par flat)
+    const size_t promoteAt = std::max<size_t>(2, opt.minN / 2);
+    PiecewiseFunction::setThresholds(promoteAt, promoteAt / 2);
+
+    // meilleure mesure sur repeat passes : le bruit (interruptions, fréquence) ne fait qu'allonger les temps
+    BenchReport report("complexity");
+    for (int r = 0; r < repeat; ++r) {
+        run_bench_suite<RedBlackTree<DeltaPoint>>(report, "rbt", opt);
+        run_bench_suite<RedBlackTree<DeltaPoint, Augment<SumDelta>>>(report, "rbt_sumdelta", opt);
+        run_bench_suite<PiecewiseLinearFunction>(report, "map", opt);
+        run_bench_suite<FlatPiecewise>(report, "flat", opt);
+        run_bench_suite<PiecewiseFunction>(report, "adaptive", opt);
+    }
+
+    std::map<std::pair<std::string, std::string>, std::map<size_t, double>> best;
+    for (const BenchResult& r : report.all()) {
+        auto& cell = best[{r.backend, r.op}];
+        auto it = cell.find(r.n);
+        if (it == cell.end() || r.nsPerOp < it->second) cell[r.n] = r.nsPerOp;
+    }
+
+    int failures = 0;
+    std::cout << std::fixed << std::setprecision(2);
+    for (const auto& [key, points] : best) {
+        const auto& [backend, op] = key;
+        Bound b = bound_of(backend, op);
+        std::vector<double> logN, logT, logRatio;
+        for (const auto& [n, ns] : points) {
+            logN.push_back(std::log(double(n)));
+            logT.push_back(std::log(std::max(ns, 1e-3)));
+            logRatio.push_back(logT.back() - std::log(boundValue(b, double(n))));
+        }
+        if (logN.size() < 3) continue; // pas assez de tailles pour une pente
+        double exponent = fit_slope(logN, logT);
+        double excess = fit_slope(logN, logRatio);
+        bool ok = excess <= tolerance;
+        failures += !ok;
+        std::cout << (ok ? "ok   " : "FAIL ") << backend << " " << op << " exponent " << exponent
+                  << " bound " << boundName(b) << " excess " << excess << "\n";
+    }
+
+    if (!opt.out.empty()) report.write(opt);
+    std::cout << (failures ? "FAILED " : "PASSED ") << failures << " operation(s) above bound" << std::endl;
+    return failures ? 1 : 0;
+}
@@ -50,32 +50,18 @@ int main() {
 
 
 
-    PiecewiseLinearFunction levelmin;
-    PiecewiseLinearFunction levelmax;
-    PiecewiseLinearFunction totalmin;
-    PiecewiseLinearFunction totalmax;
-    levelmin.sum(g1);
-    levelmin.sum(f2);
-    totalmin.sum(g1);
-    totalmin.sum(f2);
-    levelmax.sum(g2);
-    levelmax.sum(f1);
-    totalmax.sum(g2);
-    totalmax.sum(f1);
-
-
-    PiecewiseLinearFunction kmin = levelmin;
-    PiecewiseLinearFunction kmax = levelmax;
-
-    totalmax.negate();
-    totalmin.negate(); 
-
-    kmin.sum(totalmax);
-    kmax.sum(totalmin);
-
-
-    kmin.sum(f1);
-    kmax.sum(f2);
+    // sommes k-way : un seul balayage par profil agrégé
+    const PiecewiseLinearFunction* mins[] = {&g1, &f2};
+    const PiecewiseLinearFunction* maxs[] = {&g2, &f1};
+    PiecewiseLinearFunction levelmin = PiecewiseLinearFunction::sum_all(mins);
+    PiecewiseLinearFunction levelmax = PiecewiseLinearFunction::sum_all(maxs);
+    PiecewiseLinearFunction totalmin = PiecewiseLinearFunction::sum_all(mins);
+    PiecewiseLinearFunction totalmax = PiecewiseLinearFunction::sum_all(maxs);
+
+
+    // expressions paresseuses : une seule somme k-way par résultat
+    PiecewiseLinearFunction kmin = levelmin - totalmax + f1;
+    PiecewiseLinearFunction kmax = levelmax - totalmin + f2;
 
 
 
@@ -0,0 +1,267 @@
+#pragma once
+// Compteurs d'opérations et histogrammes de latence des profils (RedBlackTree, PiecewiseLinearFunction).
+//
+// Compilés seulement avec -DPROFILE_METRICS=1 : sinon metric<C>() et OpTimer<Op> sont vides et le compilateur
+// les retire. Chaque thread écrit dans son propre bloc (un seul écrivain, aucune opération atomique verrouillée) ;
+// Metrics::snapshot() additionne les blocs de tous les threads à la lecture.
+//
+// Latences : histogramme logarithmique à la HDR, 16 sous-intervalles par puissance de 2 (erreur relative < 6,25 %),
+// de 1 ns à 2^64 ns. Metrics::write(fichier) exporte compteurs et percentiles en texte, une mesure par ligne.
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#ifndef PROFILE_METRICS
+#define PROFILE_METRICS 0
+#endif
+
+inline constexpr bool METRICS_ENABLED = PROFILE_METRICS != 0;
+
+enum class MetricCounter : size_t {
+    Rotations,          // leftRotate / rightRotate
+    FixInsertIters,     // tours de boucle de fixInsert
+    FixDeleteIters,     // tours de boucle de fixDelete
+    NodeAllocs,         // noeuds alloués
+    NodeFrees,          // noeuds libérés
+    Evals,
+    Sums,               // sum / minus / add_scaled
+    Clamps,             // add_clamped
+    BreakpointsTouched, // points écrits, modifiés ou retirés par les opérations
+    COUNT
+};
+
+enum class MetricOp : size_t { Eval, Sum, MinMax, Clamp, ApplyDelta, Insert, Remove, Normalize, COUNT };
+
+inline constexpr size_t METRIC_COUNTERS = static_cast<size_t>(MetricCounter::COUNT);
+inline constexpr size_t METRIC_OPS = static_cast<size_t>(MetricOp::COUNT);
+
+inline const char* metricName(MetricCounter c) {
+    static const char* names[] = {"rotations", "fix_insert_iters", "fix_delete_iters", "node_allocs",
+                                  "node_frees", "evals", "sums", "clamps", "breakpoints_touched"};
+    return names[static_cast<size_t>(c)];
+}
+
+inline const char* metricName(MetricOp op) {
+    static const char* names[] = {"eval", "sum", "minmax", "clamp", "apply_delta", "insert", "remove", "normalize"};
+    return names[static_cast<size_t>(op)];
+}
+
+//=================================================================================================================
+//======================================  Histogramme de latence  =================================================
+//=================================================================================================================
+
+struct LatencyHistogram {
+    static constexpr size_t SUB = 16;                  // sous-intervalles par puissance de 2
+    static constexpr size_t BUCKETS = SUB + 60 * SUB;  // valeurs < 16 exactes, puis 2^4 .. 2^64
+
+    std::array<uint64_t, BUCKETS> buckets{};
+    uint64_t count = 0;
+    uint64_t sumNs = 0;
+    uint64_t maxNs = 0;
+
+    static size_t bucketOf(uint64_t ns) {
+        if (ns < SUB) return ns;
+        int e = std::bit_width(ns) - 1; // ns dans [2^e, 2^(e+1)), e >= 4
+        return SUB + (e - 4) * SUB + ((ns >> (e - 4)) - SUB);
+    }
+
+    // Plus petite et plus grande valeur du seau i
+    static uint64_t bucketLow(size_t i) {
+        if (i < SUB) return i;
+        size_t e = (i - SUB) / SUB + 4, sub = (i - SUB) % SUB;
+        return (SUB + sub) << (e - 4);
+    }
+
+    static uint64_t bucketHigh(size_t i) {
+        if (i < SUB) return i;
+        size_t e = (i - SUB) / SUB + 4;
+        return bucketLow(i) + ((uint64_t(1) << (e - 4)) - 1);
+    }
+
+    void record(uint64_t ns) {
+        ++buckets[bucketOf(ns)];
+        ++count;
+        sumNs += ns;
+        maxNs = std::max(maxNs, ns);
+    }
+
+    void merge(const LatencyHistogram& o) {
+        for (size_t i = 0; i < BUCKETS; ++i) buckets[i] += o.buckets[i];
+        count += o.count;
+        sumNs += o.sumNs;
+        maxNs = std::max(maxNs, o.maxNs);
+    }
+
+    double mean() const { return count ? double(sumNs) / double(count) : 0.0; }
+
+    // Percentile p dans [0, 100] : borne haute du seau qui le contient (au plus maxNs)
+    uint64_t percentile(double p) const {
+        if (count == 0) return 0;
+        uint64_t rank = uint64_t(std::max(1.0, p / 100.0 * double(count) + 0.5));
+        rank = std::min(rank, count);
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            seen += buckets[i];
+            if (seen >= rank) return std::min(bucketHigh(i), maxNs);
+        }
+        return maxNs;
+    }
+};
+
+//=================================================================================================================
+//======================================  Compteurs par thread  ===================================================
+//=================================================================================================================
+
+struct MetricsSnapshot {
+    std::array<uint64_t, METRIC_COUNTERS> counters{};
+    std::array<LatencyHistogram, METRIC_OPS> latency{};
+
+    uint64_t operator[](MetricCounter c) const { return counters[static_cast<size_t>(c)]; }
+    const LatencyHistogram& operator[](MetricOp op) const { return latency[static_cast<size_t>(op)]; }
+
+    // Format texte : "counter <nom> <valeur>" puis
+    // "latency <op> count <n> mean <ns> p50 <ns> p90 <ns> p99 <ns> p999 <ns> max <ns>"
+    void write(std::ostream& out) const {
+        for (size_t c = 0; c < METRIC_COUNTERS; ++c)
+            out << "counter " << metricName(static_cast<MetricCounter>(c)) << " " << counters[c] << "\n";
+        for (size_t o = 0; o < METRIC_OPS; ++o) {
+            const LatencyHistogram& h = latency[o];
+            out << "latency " << metricName(static_cast<MetricOp>(o)) << " count " << h.count
+                << " mean " << h.mean() << " p50 " << h.percentile(50) << " p90 " << h.percentile(90)
+                << " p99 " << h.percentile(99) << " p999 " << h.percentile(99.9) << " max " << h.maxNs << "\n";
+        }
+    }
+};
+
+class Metrics {
+public:
+    // Bloc du thread courant (créé au premier usage, gardé jusqu'à la fin du programme)
+    struct Block {
+        std::array<std::atomic<uint64_t>, METRIC_COUNTERS> counters{};
+        std::array<std::array<std::atomic<uint64_t>, LatencyHistogram::BUCKETS>, METRIC_OPS> buckets{};
+        std::array<std::atomic<uint64_t>, METRIC_OPS> sumNs{}, maxNs{};
+
+        // un seul écrivain : lecture + écriture relâchées, pas d'incrément verrouillé
+        static void bump(std::atomic<uint64_t>& a, uint64_t n) {
+            a.store(a.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        }
+    };
+
+    static Block& local() {
+        thread_local Block* b = registerThread();
+        return *b;
+    }
+
+    static void add(MetricCounter c, uint64_t n) {
+        Block::bump(local().counters[static_cast<size_t>(c)], n);
+    }
+
+    static void record(MetricOp op, uint64_t ns) {
+        Block& b = local();
+        size_t o = static_cast<size_t>(op);
+        Block::bump(b.buckets[o][LatencyHistogram::bucketOf(ns)], 1);
+        Block::bump(b.sumNs[o], ns);
+        if (ns > b.maxNs[o].load(std::memory_order_relaxed)) b.maxNs[o].store(ns, std::memory_order_relaxed);
+    }
+
+    // Somme des blocs de tous les threads
+    static MetricsSnapshot snapshot() {
+        MetricsSnapshot s;
+        std::lock_guard<std::mutex> lock(registryMutex());
+        for (const auto& b : registry()) {
+            for (size_t c = 0; c < METRIC_COUNTERS; ++c)
+                s.counters[c] += b->counters[c].load(std::memory_order_relaxed);
+            for (size_t o = 0; o < METRIC_OPS; ++o) {
+                LatencyHistogram& h = s.latency[o];
+                for (size_t i = 0; i < LatencyHistogram::BUCKETS; ++i) {
+                    uint64_t n = b->buckets[o][i].load(std::memory_order_relaxed);
+                    h.buckets[i] += n;
+                    h.count += n;
+                }
+                h.sumNs += b->sumNs[o].load(std::memory_order_relaxed);
+                h.maxNs = std::max(h.maxNs, b->maxNs[o].load(std::memory_order_relaxed));
+            }
+        }
+        return s;
+    }
+
+    // Remise à zéro (à appeler quand aucun thread ne mesure)
+    static void reset() {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        for (const auto& b : registry()) {
+            for (auto& c : b->counters) c.store(0, std::memory_order_relaxed);
+            for (auto& op : b->buckets)
+                for (auto& n : op) n.store(0, std::memory_order_relaxed);
+            for (auto& n : b->sumNs) n.store(0, std::memory_order_relaxed);
+            for (auto& n : b->maxNs) n.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    static void write(const std::string& filename) {
+        std::ofstream out(filename);
+        if (!out) {
+            std::cerr << "Erreur: impossible d'ouvrir le fichier " << filename << std::endl;
+            return;
+        }
+        snapshot().write(out);
+    }
+
+private:
+    static std::mutex& registryMutex() {
+        static std::mutex m;
+        return m;
+    }
+
+    static std::vector<std::unique_ptr<Block>>& registry() {
+        static std::vector<std::unique_ptr<Block>> blocks;
+        return blocks;
+    }
+
+    static Block* registerThread() {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        registry().push_back(std::make_unique<Block>());
+        return registry().back().get();
+    }
+};
+
+//=================================================================================================================
+//======================================  Points de mesure  =======================================================
+//=================================================================================================================
+
+// Compteur : retiré à la compilation sans PROFILE_METRICS
+template <MetricCounter C>
+inline void metric(uint64_t n = 1) {
+    if constexpr (METRICS_ENABLED) Metrics::add(C, n);
+}
+
+// Mesure la durée de la portée courante dans l'histogramme de Op (vide sans PROFILE_METRICS)
+template <MetricOp Op, bool = METRICS_ENABLED>
+class OpTimer {
+public:
+    OpTimer() : start(std::chrono::steady_clock::now()) {}
+    ~OpTimer() {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        Metrics::record(Op, uint64_t(ns.count()));
+    }
+    OpTimer(const OpTimer&) = delete;
+    OpTimer& operator=(const OpTimer&) = delete;
+
+private:
+    std::chrono::steady_clock::time_point start;
+};
+
+template <MetricOp Op>
+class OpTimer<Op, false> {
+public:
+    OpTimer() {}
+};
@@ -0,0 +1,146 @@
+#pragma once
+// Compteurs matériels Linux (perf_event_open) autour des parties chronométrées du banc d'essai : cycles,
+// instructions, défauts de cache L1 données et dernier niveau, mauvaises prédictions de branchement.
+//
+// Chaque compteur est ouvert séparément (processus courant, mode utilisateur seul) : un compteur que le noyau ou
+// la machine refuse (perf_event_paranoid, conteneur, machine virtuelle sans PMU) est simplement absent du
+// rapport, les autres restent mesurés. Hors Linux, ou si aucun ne s'ouvre, available() est faux et le banc
+// d'essai ne publie que le temps et les allocations. Les valeurs sont corrigées du multiplexage
+// (time_enabled / time_running) quand le noyau partage les compteurs. Les ioctl de début et de fin sont comptés
+// avec la mesure (quelques centaines d'instructions par exécution, négligeable dès que reps est grand).
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+enum class PerfEvent : size_t { Cycles, Instructions, L1dMisses, LlcMisses, BranchMisses, COUNT };
+
+inline constexpr size_t PERF_EVENTS = static_cast<size_t>(PerfEvent::COUNT);
+
+inline const char* perfEventName(PerfEvent e) {
+    static const char* names[] = {"cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses"};
+    return names[static_cast<size_t>(e)];
+}
+
+class PerfCounters {
+public:
+    using Values = std::array<uint64_t, PERF_EVENTS>;
+
+    PerfCounters() {
+        fds.fill(-1);
+#ifdef __linux__
+        for (size_t i = 0; i < PERF_EVENTS; ++i) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            configure(static_cast<PerfEvent>(i), attr);
+            long fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+            if (fd >= 0) fds[i] = int(fd);
+            else if (!lastErrno) lastErrno = errno;
+        }
+#endif
+    }
+
+    ~PerfCounters() {
+#ifdef __linux__
+        for (int fd : fds)
+            if (fd >= 0) close(fd);
+#endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool available() const {
+        for (int fd : fds)
+            if (fd >= 0) return true;
+        return false;
+    }
+
+    bool has(PerfEvent e) const { return fds[static_cast<size_t>(e)] >= 0; }
+
+    // Raison du premier refus (vide si tous les compteurs sont ouverts)
+    std::string error() const {
+#ifdef __linux__
+        return lastErrno ? std::strerror(lastErrno) : "";
+#else
+        return "perf_event_open n'existe que sous Linux";
+#endif
+    }
+
+    void start() {
+#ifdef __linux__
+        for (int fd : fds) {
+            if (fd < 0) continue;
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    // Arrête les compteurs et ajoute leurs valeurs à acc (0 pour un compteur absent)
+    void stop(Values& acc) {
+#ifdef __linux__
+        for (int fd : fds)
+            if (fd >= 0) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        for (size_t i = 0; i < PERF_EVENTS; ++i) {
+            if (fds[i] < 0) continue;
+            uint64_t r[3]; // valeur, time_enabled, time_running
+            if (read(fds[i], r, sizeof(r)) != ssize_t(sizeof(r))) continue;
+            double v = double(r[0]);
+            if (r[2] > 0 && r[2] < r[1]) v *= double(r[1]) / double(r[2]);
+            acc[i] += uint64_t(v);
+        }
+#else
+        (void)acc;
+#endif
+    }
+
+    // Ouverts une fois pour tout le programme
+    static PerfCounters& instance() {
+        static PerfCounters counters;
+        return counters;
+    }
+
+private:
+    std::array<int, PERF_EVENTS> fds;
+    int lastErrno = 0;
+
+#ifdef __linux__
+    static void configure(PerfEvent e, perf_event_attr& attr) {
+        auto cache = [&](uint64_t level) {
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = level | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        };
+        switch (e) {
+        case PerfEvent::Cycles:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case PerfEvent::Instructions:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case PerfEvent::L1dMisses: cache(PERF_COUNT_HW_CACHE_L1D); break;
+        case PerfEvent::LlcMisses: cache(PERF_COUNT_HW_CACHE_LL); break;
+        case PerfEvent::BranchMisses:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+        case PerfEvent::COUNT: break;
+        }
+    }
+#endif
+};
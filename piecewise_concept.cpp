@@ -0,0 +1,96 @@
+#pragma once
+// Interface commune des représentations d'une fonction linéaire par morceaux en (x, deltaY) :
+// RedBlackTree<DeltaPoint> (RBT_sarah.cpp), PiecewiseLinearFunction (piecewise_map.cpp),
+// FlatPiecewise (piecewise_flat.cpp) et PiecewiseFunction (piecewise_function.cpp).
+// Chaque fichier vérifie par static_assert que sa classe satisfait PiecewiseBackend ; les algorithmes et
+// les bancs d'essai écrits contre le concept marchent sur toutes les représentations.
+//
+// rbt_new.cpp et piecewise_RBT.cpp sont des versions antérieures de RBT_sarah.cpp (pas de min/max,
+// de minus ni de fusion), qui ne sont plus maintenues : elles satisfont le concept au travers de l'adaptateur
+// LegacyPiecewise (piecewise_legacy.cpp), vérifié par static_assert dans bench_legacy.cpp.
+#include <concepts>
+#include <cstddef>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "piecewise_core.cpp"
+
+// Source de points (x, deltaY) dans l'ordre croissant (voir le moteur de fusion de piecewise_core.cpp)
+template <typename S>
+concept PointSource = requires(S s, double& x, double& d) {
+    { s.next(x, d) } -> std::convertible_to<bool>;
+};
+
+template <typename F>
+concept PiecewiseBackend = std::default_initializable<F> && std::copy_constructible<F> &&
+    requires(F f, const F cf, double x, double y, std::span<const F*> fs) {
+        // évaluation et points
+        { cf.evaluate(x) } -> std::convertible_to<double>;
+        f.addBreakpoint(x, y);   // deltaY du point x (remplacé s'il existe)
+        f.removeBreakpoint(x);   // sans effet si x n'est pas un point
+        { cf.to_points_delta() } -> std::convertible_to<std::vector<std::pair<double, double>>>;
+        { cf.cursor() } -> PointSource;
+
+        // opérations en place
+        f.sum(cf);
+        f.minus(cf);
+        f.add_scaled(cf, y);
+        f.negate();
+        f.minfunction(y);
+        f.maxfunction(y);
+        f.minfunction(cf);
+        f.maxfunction(cf);
+        { f.normalize() } -> std::convertible_to<size_t>;
+        { f.simplify(y) } -> std::convertible_to<size_t>;
+
+        // requêtes
+        { cf.isLessOrEqual(cf) } -> std::convertible_to<bool>;
+        { cf.evaluate_max(x, y) } -> std::convertible_to<double>;
+        { cf.evaluate_min(x, y) } -> std::convertible_to<double>;
+
+        // agrégats
+        { F::sum_all(fs) } -> std::same_as<F>;
+        { F::envelope_max(fs) } -> std::same_as<F>;
+        { F::envelope_min(fs) } -> std::same_as<F>;
+    };
+
+// Interpolation d'une représentation : F::Interpolation si elle est paramétrée (Linear ou Step), Linear sinon
+template <typename F>
+struct interpolation_of { using type = Linear; };
+
+template <typename F>
+    requires requires { typename F::Interpolation; }
+struct interpolation_of<F> { using type = typename F::Interpolation; };
+
+template <typename F>
+using interpolation_t = typename interpolation_of<F>::type;
+
+//=================================================================================================================
+//======================================  Algorithmes génériques  =================================================
+//=================================================================================================================
+
+// Copie f dans une autre représentation, point par point (les points sont repris tels quels : passer de
+// Linear à Step change la fonction)
+template <PiecewiseBackend To, PiecewiseBackend From>
+To convert_profile(const From& f) {
+    To r;
+    r.removeBreakpoint(0.0); // certaines représentations démarrent avec un point (0, y0)
+    for (const auto& [x, d] : f.to_points_delta()) r.addBreakpoint(x, d);
+    return r;
+}
+
+// Plus grand écart |f(x) - g(x)|, atteint sur l'union des abscisses (f et g sont linéaires entre deux
+// points, ou constantes en escalier). Les deux fonctions peuvent venir de représentations différentes, avec la
+// même interpolation : comparaison tête à tête.
+template <PiecewiseBackend F, PiecewiseBackend G>
+double max_profile_gap(const F& f, const G& g) {
+    using I = interpolation_t<F>;
+    static_assert(std::is_same_v<I, interpolation_t<G>>, "max_profile_gap : interpolations différentes");
+    double gap = 0.0;
+    merge_walk<I>(f.cursor(), g.cursor(), [&](double, double a, double b) {
+        gap = std::max(gap, std::fabs(a - b));
+        return true;
+    });
+    return gap;
+}
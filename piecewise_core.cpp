@@ -0,0 +1,645 @@
+#pragma once
+// Briques communes aux représentations (x, deltaY) des fonctions linéaires par morceaux
+// (RedBlackTree<DeltaPoint> dans RBT_sarah.cpp, PiecewiseLinearFunction dans piecewise_map.cpp).
+//
+// Convention partagée : f vaut 0 avant le premier point, f(x_i) = somme des deltaY jusqu'à x_i,
+// interpolation linéaire entre deux points, constante après le dernier point.
+// Les briques qui dépendent de l'interpolation prennent une politique Linear (défaut) ou Step (escalier).
+#include <cmath>
+#include <vector>
+#include <utility>
+#include <tuple>
+#include <limits>
+#include <algorithm>
+#include <queue>
+#include <functional>
+
+// Tolérance par défaut pour décider qu'un point est aligné avec ses voisins
+const double COLLINEAR_TOL = 1e-9;
+
+// Interpolation entre deux points, choisie à la compilation :
+//  - Linear : f linéaire entre deux points,
+//  - Step   : fonction en escalier, f(x) = somme des deltaY des points d'abscisse <= x (constante jusqu'au
+//             point suivant). Une opération ponctuelle (somme, min, max, enveloppe) ne change alors de valeur
+//             qu'aux points des opérandes : aucun croisement à chercher entre deux abscisses.
+struct Linear { static constexpr bool step = false; };
+struct Step   { static constexpr bool step = true; };
+
+//=================================================================================================================
+//======================================  Points redondants (normalisation)  ======================================
+//=================================================================================================================
+
+// Erreur commise en retirant le point (x1, d1) situé entre x0 et (x2, d2) :
+// écart entre f(x1) et la corde qui relie f(x0) à f(x2).
+inline double removal_error(double x0, double x1, double d1, double x2, double d2) {
+    return std::fabs(d1 - (d1 + d2) * (x1 - x0) / (x2 - x0));
+}
+
+// Un point intérieur est redondant s'il est aligné avec ses deux voisins
+inline bool is_collinear(double x0, double x1, double d1, double x2, double d2, double tol) {
+    return removal_error(x0, x1, d1, x2, d2) < tol;
+}
+
+// Premier point (saut depuis 0) : redondant seulement si le saut et le segment suivant sont nuls
+inline bool is_redundant_first(double d0, double d1, double tol) {
+    return std::fabs(d0) < tol && std::fabs(d1) < tol;
+}
+
+// Dernier point : redondant si le dernier segment est plat (f est constante après lui)
+inline bool is_redundant_last(double d, double tol) {
+    return std::fabs(d) < tol;
+}
+
+// Fusion de (x1, d1) dans le point précédent x0 quand x1 - x0 < eps (tolérance d'abscisses de la
+// représentation) ; (x2, d2) est le point suivant (x2 = +inf sans suivant). f prend y0 + d1 en x0 (écart |d1|)
+// et la corde x0 -> x2 remplace le segment x1 -> x2 (écart |d2| (x1 - x0) / (x2 - x0) en x1). On ne fusionne
+// que si ces deux écarts restent sous tol : un segment presque vertical reste tel quel.
+// En escalier, passer d2 = 0 (seul [x0, x1) change).
+inline bool is_fusable(double x0, double x1, double d1, double x2, double d2, double eps, double tol) {
+    if (x1 - x0 >= eps || std::fabs(d1) >= tol) return false;
+    return std::fabs(d2) * (x1 - x0) < tol * (x2 - x0);
+}
+
+// En escalier, un point est redondant dès que son saut est nul, quelle que soit sa position
+inline bool is_redundant_step(double d, double tol) {
+    return std::fabs(d) < tol;
+}
+
+//=================================================================================================================
+//======================================  Simplification à erreur bornée  =========================================
+//=================================================================================================================
+
+// (x, deltaY) -> (x, f(x))
+inline std::vector<std::pair<double, double>> cumulate(const std::vector<std::pair<double, double>>& deltas) {
+    std::vector<std::pair<double, double>> values;
+    values.reserve(deltas.size());
+    double y = 0.0;
+    for (const auto& p : deltas) {
+        y += p.second;
+        values.push_back({p.first, y});
+    }
+    return values;
+}
+
+// Indices des points gardés pour que chaque corde entre deux points gardés reste dans la bande
+// [f(x_k) + lo, f(x_k) + hi] en tout point intermédiaire x_k (lo <= 0 <= hi).
+// Les deux fonctions étant linéaires entre les points de f, l'écart max est atteint sur ces points :
+// la borne vaut donc partout (norme L-infini). Glouton par cône de pentes admissibles.
+inline std::vector<size_t> simplify_indices(const std::vector<std::pair<double, double>>& values,
+                                            double lo, double hi) {
+    std::vector<size_t> kept;
+    size_t n = values.size();
+    if (n == 0) return kept;
+    kept.push_back(0);
+
+    size_t a = 0;
+    while (a + 1 < n) {
+        double xa = values[a].first, ya = values[a].second;
+        double smin = -std::numeric_limits<double>::infinity();
+        double smax = std::numeric_limits<double>::infinity();
+        size_t best = a + 1;
+
+        for (size_t j = a + 1; j < n; ++j) {
+            double dx = values[j].first - xa;
+            double yj = values[j].second;
+            if (dx <= 0.0) {
+                // même abscisse que l'ancre : la corde ne peut pas s'y arrêter
+                if (ya < yj + lo || ya > yj + hi) break;
+                continue;
+            }
+            double s = (yj - ya) / dx;
+            if (s >= smin && s <= smax) best = j; // j peut terminer la corde
+            smin = std::max(smin, (yj + lo - ya) / dx);
+            smax = std::min(smax, (yj + hi - ya) / dx);
+            if (smin > smax) break;
+        }
+
+        kept.push_back(best);
+        a = best;
+    }
+    return kept;
+}
+
+// Version escalier : paliers (indice du point de départ, valeur). Chaque palier part d'un point de f et prend une
+// valeur commune aux bandes [f(x_k) + lo, f(x_k) + hi] des points qu'il couvre ; glouton par intersection.
+inline std::vector<std::pair<size_t, double>> simplify_step_runs(const std::vector<std::pair<double, double>>& values,
+                                                                  double lo, double hi) {
+    std::vector<std::pair<size_t, double>> runs;
+    size_t n = values.size();
+    size_t a = 0;
+    while (a < n) {
+        double bl = values[a].second + lo, bh = values[a].second + hi;
+        size_t j = a + 1;
+        while (j < n && values[j].second + lo <= bh && values[j].second + hi >= bl) {
+            bl = std::max(bl, values[j].second + lo);
+            bh = std::min(bh, values[j].second + hi);
+            ++j;
+        }
+        runs.push_back({a, std::clamp(values[a].second, bl, bh)});
+        a = j;
+    }
+    return runs;
+}
+
+// Simplifie une suite (x, deltaY) dans la bande [lo, hi] ; le résultat est aussi une suite (x, deltaY)
+template <typename Interp = Linear>
+std::vector<std::pair<double, double>> simplify_deltas(const std::vector<std::pair<double, double>>& deltas,
+                                                       double lo, double hi) {
+    auto values = cumulate(deltas);
+    std::vector<std::pair<double, double>> result;
+    double yprev = 0.0;
+    if constexpr (Interp::step) {
+        for (auto [k, y] : simplify_step_runs(values, lo, hi)) {
+            result.push_back({values[k].first, y - yprev});
+            yprev = y;
+        }
+    } else {
+        for (size_t k : simplify_indices(values, lo, hi)) {
+            result.push_back({values[k].first, values[k].second - yprev});
+            yprev = values[k].second;
+        }
+    }
+    return result;
+}
+
+// Plus petite erreur (à la dichotomie près) pour garder au plus max_points points (au moins 2). Vaut 0 quand f
+// a déjà assez de points ou qu'elle est constante : simplify(0) suffit alors à tenir max_points.
+template <typename Interp = Linear>
+double simplify_error_for(const std::vector<std::pair<double, double>>& deltas, size_t max_points) {
+    auto values = cumulate(deltas);
+    if (values.size() <= std::max<size_t>(max_points, 2)) return 0.0;
+
+    double ymin = values.front().second, ymax = ymin;
+    for (const auto& v : values) {
+        ymin = std::min(ymin, v.second);
+        ymax = std::max(ymax, v.second);
+    }
+
+    // avec e = ymax - ymin la corde premier -> dernier (un seul palier en escalier) suffit toujours
+    double low = 0.0, high = ymax - ymin;
+    for (int iter = 0; iter < 60 && high - low > 1e-12 * (1.0 + high); ++iter) {
+        double mid = 0.5 * (low + high);
+        size_t kept;
+        if constexpr (Interp::step) kept = simplify_step_runs(values, -mid, mid).size();
+        else kept = simplify_indices(values, -mid, mid).size();
+        if (kept <= std::max<size_t>(max_points, 2))
+            high = mid;
+        else
+            low = mid;
+    }
+    return high;
+}
+
+//=================================================================================================================
+//======================================  Moteur de fusion binaire (zip)  =========================================
+//=================================================================================================================
+// Une "source" fournit les points (x, deltaY) d'une fonction dans l'ordre croissant :
+//     bool next(double& x, double& d);   // false quand il n'y a plus de point
+
+// Source sur un vecteur de points (x, deltaY)
+struct VectorSource {
+    const std::vector<std::pair<double, double>>* pts;
+    size_t i = 0;
+    bool next(double& x, double& d) {
+        if (i >= pts->size()) return false;
+        x = (*pts)[i].first;
+        d = (*pts)[i].second;
+        ++i;
+        return true;
+    }
+};
+
+// Suit la valeur d'une fonction pendant un balayage de gauche à droite
+template <typename Src, typename Interp = Linear>
+struct Track {
+    Src src;
+    bool has = false;      // il reste un point à venir
+    double nx = 0, ny = 0; // prochain point (x, f(x))
+    bool started = false;  // au moins un point déjà passé
+    double px = 0, py = 0; // dernier point passé (x, f(x))
+
+    explicit Track(Src s) : src(s) { fetch(); }
+
+    void fetch() {
+        double x, d;
+        has = src.next(x, d);
+        if (has) { nx = x; ny = py + d; }
+    }
+
+    // passe tous les points d'abscisse <= x
+    void advanceTo(double x) {
+        while (has && nx <= x) {
+            px = nx; py = ny; started = true;
+            fetch();
+        }
+    }
+
+    // valeur en x (après advanceTo(x))
+    double value(double x) const {
+        if (!started) return 0.0;
+        if (Interp::step || !has || x <= px) return py;
+        return py + (ny - py) * (x - px) / (nx - px);
+    }
+};
+
+// Parcourt f et g en parallèle sur l'union de leurs abscisses : visit(x, F, G) reçoit f(x) et g(x).
+// visit retourne false pour arrêter le parcours. O(n + m).
+template <typename Interp = Linear, typename SrcF, typename SrcG, typename Visit>
+void merge_walk(SrcF f, SrcG g, Visit visit) {
+    Track<SrcF, Interp> tf(f);
+    Track<SrcG, Interp> tg(g);
+    while (tf.has || tg.has) {
+        double x;
+        if (tf.has && tg.has) x = std::min(tf.nx, tg.nx);
+        else x = tf.has ? tf.nx : tg.nx;
+        tf.advanceTo(x);
+        tg.advanceTo(x);
+        if (!visit(x, tf.value(x), tg.value(x))) return;
+    }
+}
+
+// Opérateurs ponctuels usuels
+struct OpPlus  { double operator()(double F, double G) const { return F + G; } };
+struct OpMinus { double operator()(double F, double G) const { return F - G; } };
+struct OpMin   { double operator()(double F, double G) const { return std::min(F, G); } };
+struct OpMax   { double operator()(double F, double G) const { return std::max(F, G); } };
+struct OpAxpy  { double a; double operator()(double F, double G) const { return F + a * G; } };
+struct OpAddClamp {
+    double lo, hi;
+    double operator()(double F, double G) const { return std::min(std::max(F + G, lo), hi); }
+};
+
+// Un "switch" décrit où l'opérateur n'est pas linéaire : il remplit s[] (au plus 4 valeurs, linéaires en F et G)
+// et un point de cassure est inséré partout où l'une d'elles change de signe le long d'un segment.
+struct NoSwitch { int operator()(double, double, double*) const { return 0; } };
+struct SwitchFG { int operator()(double F, double G, double* s) const { s[0] = F - G; return 1; } };
+struct SwitchAddClamp {
+    double lo, hi;
+    int operator()(double F, double G, double* s) const { s[0] = F + G - lo; s[1] = F + G - hi; return 2; }
+};
+
+// Fusionne f et g en r(x) = op(f(x), g(x)) et renvoie les points (x, deltaY) du résultat, en O(n + m).
+// Les points de cassure (croisements des switchs) sont insérés entre deux abscisses consécutives.
+// op(0, 0) doit valoir 0 : le résultat, comme toute fonction de cette représentation, est nul avant son premier point.
+// En escalier (Step), les switchs sont ignorés : r ne change qu'aux abscisses de f et g.
+template <typename Interp = Linear, typename SrcF, typename SrcG, typename Op, typename Switch>
+std::vector<std::pair<double, double>> zip_deltas(SrcF f, SrcG g, Op op, Switch sw) {
+    std::vector<std::pair<double, double>> out;
+    double rprev = 0.0;
+    bool first = true;
+    double xp = 0, Fp = 0, Gp = 0;
+    double sp[4];
+    int nsp = 0;
+
+    auto emit = [&](double x, double r) {
+        out.push_back({x, r - rprev});
+        rprev = r;
+    };
+
+    merge_walk<Interp>(f, g, [&](double x, double F, double G) {
+        if constexpr (Interp::step) {
+            emit(x, op(F, G));
+            return true;
+        }
+        double sc[4];
+        int nsc = sw(F, G, sc);
+        if (!first) {
+            double ts[4];
+            int nt = 0;
+            for (int i = 0; i < nsc && i < nsp; ++i) {
+                if ((sp[i] < 0 && sc[i] > 0) || (sp[i] > 0 && sc[i] < 0))
+                    ts[nt++] = sp[i] / (sp[i] - sc[i]);
+            }
+            std::sort(ts, ts + nt);
+            for (int k = 0; k < nt; ++k) {
+                double t = ts[k];
+                double xi = xp + t * (x - xp);
+                if (xi <= xp || xi >= x) continue;
+                emit(xi, op(Fp + t * (F - Fp), Gp + t * (G - Gp)));
+            }
+        }
+        emit(x, op(F, G));
+        first = false;
+        xp = x; Fp = F; Gp = G;
+        for (int i = 0; i < nsc; ++i) sp[i] = sc[i];
+        nsp = nsc;
+        return true;
+    });
+    return out;
+}
+
+//=================================================================================================================
+//======================================  Somme pondérée k-way (sum_all)  =========================================
+//=================================================================================================================
+
+// Somme compensée (Neumaier) : la pente totale reçoit des ajouts/retraits pendant tout le balayage
+struct CompensatedSum {
+    double sum = 0.0, comp = 0.0;
+    void add(double v) {
+        double t = sum + v;
+        if (std::fabs(sum) >= std::fabs(v)) comp += (sum - t) + v;
+        else comp += (v - t) + sum;
+        sum = t;
+    }
+    double value() const { return sum + comp; }
+};
+
+// r = somme des w_k f_k en un seul balayage : tas des prochaines abscisses, O(N log K) pour N points au total.
+// Entre deux abscisses consécutives r est linéaire de pente S = somme des w_k * pente_k ; on ne met à jour S
+// que pour les fonctions qui ont un point à l'abscisse courante. weights vide = tous les poids à 1.
+// En escalier, tous les points sont des sauts et S reste nulle.
+template <typename Interp = Linear, typename Src>
+std::vector<std::pair<double, double>> sum_all_deltas(std::vector<Src> srcs, const std::vector<double>& weights) {
+    struct State {
+        bool has = false, started = false;
+        double nx = 0, nd = 0; // prochain point (x, deltaY)
+        double slope = 0;      // pente pondérée du segment en cours
+    };
+    size_t K = srcs.size();
+    std::vector<State> st(K);
+    using Event = std::pair<double, size_t>;
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> heap;
+
+    for (size_t k = 0; k < K; ++k) {
+        st[k].has = srcs[k].next(st[k].nx, st[k].nd);
+        if (st[k].has) heap.push({st[k].nx, k});
+    }
+
+    std::vector<std::pair<double, double>> out;
+    CompensatedSum S;
+    double xprev = 0.0;
+
+    while (!heap.empty()) {
+        double x = heap.top().first;
+        double delta = out.empty() ? 0.0 : S.value() * (x - xprev);
+
+        while (!heap.empty() && heap.top().first == x) {
+            size_t k = heap.top().second;
+            heap.pop();
+            State& s = st[k];
+            double w = weights.empty() ? 1.0 : weights[k];
+
+            // le segment qui se termine en x est déjà compté dans S * (x - xprev) ; un premier point est un saut
+            if (Interp::step || !s.started) delta += w * s.nd;
+            S.add(-s.slope);
+            s.slope = 0.0;
+            s.started = true;
+
+            // points suivants à la même abscisse : des sauts
+            while ((s.has = srcs[k].next(s.nx, s.nd)) && s.nx <= x) delta += w * s.nd;
+            if (s.has) {
+                if constexpr (!Interp::step) {
+                    s.slope = w * s.nd / (s.nx - x);
+                    S.add(s.slope);
+                }
+                heap.push({s.nx, k});
+            }
+        }
+
+        out.push_back({x, delta});
+        xprev = x;
+    }
+    return out;
+}
+
+//=================================================================================================================
+//======================================  Enveloppe max/min de K fonctions  =======================================
+//=================================================================================================================
+
+// (x, f(x)) -> (x, deltaY) en retirant les points intérieurs alignés avec leurs voisins gardés
+// (en escalier : les points sans saut)
+template <typename Interp = Linear>
+std::vector<std::pair<double, double>> compact_values(const std::vector<std::pair<double, double>>& values,
+                                                      double tol = COLLINEAR_TOL) {
+    std::vector<std::pair<double, double>> kept;
+    for (size_t i = 0; i < values.size(); ++i) {
+        if constexpr (Interp::step) {
+            if (!kept.empty() && is_redundant_step(values[i].second - kept.back().second, tol)) continue;
+        } else if (!kept.empty() && i + 1 < values.size()) {
+            const auto& a = kept.back();
+            const auto& b = values[i];
+            const auto& c = values[i + 1];
+            if (b.first > a.first && c.first > b.first &&
+                is_collinear(a.first, b.first, b.second - a.second, c.first, c.second - b.second, tol))
+                continue;
+        }
+        kept.push_back(values[i]);
+    }
+    std::vector<std::pair<double, double>> deltas;
+    double yprev = 0.0;
+    for (const auto& p : kept) {
+        deltas.push_back({p.first, p.second - yprev});
+        yprev = p.second;
+    }
+    return deltas;
+}
+
+// Enveloppe supérieure (upper = true) ou inférieure de K fonctions, par balayage avec un tournoi cinétique :
+// chaque noeud interne garde le gagnant de ses deux fils et l'instant où le perdant le dépasse (certificat).
+// Événements : points des fonctions (tas) et échéances de certificats (croisements).
+// Coût O((N + C) log K) pour N points au total et C croisements traités (C = 0 en escalier : pentes nulles).
+template <typename Interp = Linear, typename Src>
+std::vector<std::pair<double, double>> envelope_deltas(std::vector<Src> srcs, bool upper) {
+    const double INF = std::numeric_limits<double>::infinity();
+    const double sign = upper ? 1.0 : -1.0;
+    size_t K = srcs.size();
+    if (K == 0) return {};
+
+    std::vector<Track<Src, Interp>> tracks;
+    tracks.reserve(K);
+    for (auto& s : srcs) tracks.emplace_back(s);
+
+    // droite courante (valeur signée) de la fonction k
+    auto slopeOf = [&](size_t k) {
+        const auto& tr = tracks[k];
+        if (Interp::step || !tr.started || !tr.has) return 0.0;
+        return sign * (tr.ny - tr.py) / (tr.nx - tr.px);
+    };
+    auto valueOf = [&](size_t k, double t) { return sign * tracks[k].value(t); };
+
+    size_t P = 1;
+    while (P < K) P *= 2;
+    std::vector<long> win(2 * P, -1);
+    std::vector<double> cert(2 * P, INF), fail(2 * P, INF);
+    for (size_t k = 0; k < K; ++k) win[P + k] = (long)k;
+
+    auto recompute = [&](size_t n, double t) {
+        long a = win[2 * n], b = win[2 * n + 1];
+        cert[n] = INF;
+        if (a < 0 || b < 0) {
+            win[n] = a < 0 ? b : a;
+        } else {
+            double va = valueOf(a, t), vb = valueOf(b, t);
+            double sa = slopeOf(a), sb = slopeOf(b);
+            double tol = 1e-12 * (1.0 + std::max(std::fabs(va), std::fabs(vb)));
+            long w, l;
+            if (va > vb + tol) { w = a; l = b; }
+            else if (vb > va + tol) { w = b; l = a; }
+            else { w = sa >= sb ? a : b; l = w == a ? b : a; } // égalité : la plus forte pente gagne juste après t
+            double sw = slopeOf(w), sl = slopeOf(l);
+            if (sl > sw) {
+                double tf = t + (valueOf(w, t) - valueOf(l, t)) / (sl - sw);
+                if (tf > t) cert[n] = tf;
+                else { w = l; } // croisement déjà atteint (arrondi) : le perdant passe devant
+            }
+            win[n] = w;
+        }
+        fail[n] = std::min(cert[n], std::min(fail[2 * n], fail[2 * n + 1]));
+    };
+
+    for (size_t n = P - 1; n >= 1; --n) recompute(n, 0.0);
+
+    // recalcule les noeuds dont le certificat échoue au plus tard en t
+    std::function<void(size_t, double)> refresh = [&](size_t n, double t) {
+        if (n >= P || fail[n] > t) return;
+        refresh(2 * n, t);
+        refresh(2 * n + 1, t);
+        recompute(n, t);
+    };
+
+    using Event = std::pair<double, size_t>;
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> heap;
+    for (size_t k = 0; k < K; ++k)
+        if (tracks[k].has) heap.push({tracks[k].nx, k});
+
+    std::vector<std::pair<double, double>> values;
+    bool first = true;
+    while (!heap.empty() || fail[1] < INF) {
+        double xb = heap.empty() ? INF : heap.top().first;
+        double t;
+        if (fail[1] < xb && !first) {
+            t = fail[1]; // croisement entre deux abscisses de points
+        } else {
+            t = xb;
+            while (!heap.empty() && heap.top().first == t) {
+                size_t k = heap.top().second;
+                heap.pop();
+                tracks[k].advanceTo(t);
+                if (tracks[k].has) heap.push({tracks[k].nx, k});
+                for (size_t n = (P + k) / 2; n >= 1; n /= 2) recompute(n, t);
+            }
+        }
+        refresh(1, t);
+        values.push_back({t, sign * valueOf(win[1], t)});
+        first = false;
+    }
+    return compact_values<Interp>(values);
+}
+
+//=================================================================================================================
+//======================================  Mise à jour locale (delta)  =============================================
+//=================================================================================================================
+
+// Support utile d'un delta (x, deltaY) : indices [lo, hi) des points qui modifient f.
+// Les points nuls en tête (g reste à 0) et en queue (g reste constante) ne changent rien ;
+// lo est le dernier point nul avant le premier point non nul, d'où part la première rampe.
+inline std::pair<size_t, size_t> delta_support(const std::vector<std::pair<double, double>>& pts) {
+    size_t first = 0;
+    while (first < pts.size() && pts[first].second == 0.0) ++first;
+    if (first == pts.size()) return {0, 0};
+    size_t last = pts.size();
+    while (pts[last - 1].second == 0.0) --last;
+    return {first > 0 ? first - 1 : 0, last};
+}
+
+// Part du deltaY d'un point (xr, dr) à donner à un nouveau point x inséré après (xl) sans changer f
+inline double split_share(double xl, double x, double xr, double dr) {
+    return dr * (x - xl) / (xr - xl);
+}
+
+// Ajoute w * g à f, une fois chaque abscisse de pts[lo, hi) présente dans f (voir split_share).
+// next() renvoie le point suivant de f (abscisse, pointeur sur son deltaY), en partant de pts[lo].
+// Chaque point de f reçoit w * (g(x) - g(x_prec)) ; le point de g qui ferme un segment reçoit le reste exact.
+template <typename Next>
+void spread_delta(const std::vector<std::pair<double, double>>& pts, size_t lo, size_t hi, double w, Next next) {
+    auto [x, d] = next();
+    *d += w * pts[lo].second;
+    double prev = x;
+    for (size_t i = lo + 1; i < hi; ++i) {
+        double slope = pts[i].second / (pts[i].first - pts[i - 1].first);
+        double rem = pts[i].second;
+        for (std::tie(x, d) = next(); x < pts[i].first; std::tie(x, d) = next()) {
+            double part = slope * (x - prev);
+            *d += w * part;
+            rem -= part;
+            prev = x;
+        }
+        *d += w * rem;
+        prev = x;
+    }
+}
+
+//=================================================================================================================
+//======================================  Mises à jour CBR  =======================================================
+//=================================================================================================================
+
+// Seuil commun aux trois représentations : un déplacement de fenêtre ou un changement de capacité plus petit
+// est ignoré. Le même partout, sinon l'arbre, la map et le tableau plat divergent après les mêmes appels.
+inline constexpr double CBR_TOL = 1e-6;
+
+// Delta d'une mise à jour CBR en chapeau : nul en a, gap en b, revenu à 0 en c (voir delta_profile).
+// active = false quand rien ne change (déplacement inférieur à tol, ou cas non couvert).
+struct CbrHat {
+    bool active = false;
+    double gap = 0.0, a = 0.0, b = 0.0, c = 0.0;
+};
+
+inline CbrHat cbr_stmin_hat(double stmin_old, double stmin, double ctmin, double cap_min, double cap_max, double tol) {
+    double cap = (cap_min > 0) ? cap_max : cap_min;
+    if (std::abs(stmin - stmin_old) < tol) return {};
+    if (stmin_old < stmin && stmin < ctmin) {
+        double slope = -cap / (ctmin - stmin_old);
+        return {true, slope * (stmin - stmin_old), stmin_old, stmin, ctmin};
+    } else if (stmin_old <= ctmin && ctmin < stmin) {
+        return {true, -cap, stmin_old, ctmin, stmin};
+    } else if (ctmin < stmin_old && stmin_old < stmin) {
+        double slope = -cap / (ctmin - stmin);
+        return {true, slope * (stmin_old - stmin), ctmin, stmin_old, stmin};
+    }
+    return {};
+}
+
+inline CbrHat cbr_ctmin_hat(double ctmin_old, double ctmin, double stmin, double cap_min, double cap_max, double tol) {
+    double cap = (cap_min > 0) ? cap_max : cap_min;
+    if (std::abs(ctmin - ctmin_old) < tol) return {};
+    if (stmin < ctmin_old && ctmin_old < ctmin) {
+        double slope = -cap / (ctmin - stmin);
+        return {true, slope * (ctmin - ctmin_old), stmin, ctmin_old, ctmin};
+    } else if (ctmin_old <= stmin && stmin < ctmin) {
+        return {true, -cap, ctmin_old, stmin, ctmin};
+    } else if (ctmin_old < ctmin && ctmin < stmin) {
+        double slope = -cap / (ctmin_old - stmin);
+        return {true, slope * (ctmin_old - ctmin), ctmin_old, ctmin, stmin};
+    }
+    return {};
+}
+
+inline CbrHat cbr_stmax_hat(double stmax_old, double stmax, double ctmax, double cap_min, double cap_max, double tol) {
+    double cap = (cap_min > 0) ? cap_min : cap_max;
+    if (std::abs(stmax - stmax_old) < tol) return {};
+    if (stmax < stmax_old && stmax_old < ctmax) {
+        double slope = cap / (ctmax - stmax);
+        return {true, slope * (stmax_old - stmax), stmax, stmax_old, ctmax};
+    } else if (stmax <= ctmax && ctmax < stmax_old) {
+        return {true, cap, stmax, ctmax, stmax_old};
+    } else if (ctmax < stmax && stmax < stmax_old) {
+        double slope = cap / (ctmax - stmax_old);
+        return {true, slope * (stmax - stmax_old), ctmax, stmax, stmax_old};
+    }
+    return {};
+}
+
+inline CbrHat cbr_ctmax_hat(double ctmax_old, double ctmax, double stmax, double cap_min, double cap_max, double tol) {
+    double cap = (cap_min > 0) ? cap_min : cap_max;
+    if (std::abs(ctmax - ctmax_old) < tol) return {};
+    if (stmax < ctmax && ctmax < ctmax_old) {
+        double slope = cap / (ctmax_old - stmax);
+        return {true, slope * (ctmax_old - ctmax), stmax, ctmax, ctmax_old};
+    } else if (ctmax <= stmax && stmax < ctmax_old) {
+        return {true, cap, ctmax, stmax, ctmax_old};
+    } else if (ctmax < ctmax_old && ctmax_old < stmax) {
+        double slope = cap / (ctmax - stmax);
+        return {true, slope * (ctmax - ctmax_old), ctmax, ctmax_old, stmax};
+    }
+    return {};
+}
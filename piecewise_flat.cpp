@@ -0,0 +1,703 @@
+#pragma once
+// FlatPiecewise : même fonction (et même API) que PiecewiseLinearFunction, mais les abscisses et les deltaY
+// sont rangés dans deux tableaux contigus triés (disposition flat_map). Les Inline premiers points tiennent
+// dans l'objet lui-même : pas d'allocation pour les petits profils (delta_profile, cba_profile...).
+// Insertion et suppression coûtent O(n) (décalage) : fait pour les profils de quelques dizaines de points.
+#include <cstring>
+#include <type_traits>
+#include "piecewise_map.cpp"
+
+//=================================================================================================================
+//======================================  Tableau à stockage en ligne  ============================================
+//=================================================================================================================
+
+// Tableau contigu dont les N premiers éléments sont stockés en ligne (N = 0 : toujours sur le tas).
+// Réservé aux types trivialement copiables : copies et décalages par memcpy / memmove.
+// Passé sur le tas, il revient en ligne quand erase, resize ou assign le ramènent à N/2 éléments ou moins :
+// l'hystérésis évite une allocation à chaque point ajouté puis retiré autour de N. clear() garde le tas.
+template <typename T, size_t N>
+class SmallVec {
+    static_assert(std::is_trivially_copyable_v<T>, "SmallVec : type trivialement copiable attendu");
+
+    T inl[N > 0 ? N : 1];
+    T* ptr = inl;
+    size_t n = 0;
+    size_t cap = N;
+
+    void release() {
+        if (ptr != inl) delete[] ptr;
+        ptr = inl;
+        cap = N;
+    }
+
+    // Retour au stockage en ligne une fois la taille retombée à N/2
+    void shrinkInline() {
+        if (ptr == inl || n > N / 2) return;
+        std::memcpy(inl, ptr, n * sizeof(T));
+        delete[] ptr;
+        ptr = inl;
+        cap = N;
+    }
+
+    void steal(SmallVec& o) {
+        if (o.ptr == o.inl) {
+            std::memcpy(inl, o.inl, o.n * sizeof(T));
+        } else {
+            ptr = o.ptr;
+            cap = o.cap;
+            o.ptr = o.inl;
+            o.cap = N;
+        }
+        n = o.n;
+        o.n = 0;
+    }
+
+public:
+    SmallVec() = default;
+    SmallVec(const SmallVec& o) { assign(o.ptr, o.n); }
+    SmallVec(SmallVec&& o) noexcept { steal(o); }
+    ~SmallVec() { release(); }
+
+    SmallVec& operator=(const SmallVec& o) {
+        if (this != &o) assign(o.ptr, o.n);
+        return *this;
+    }
+
+    SmallVec& operator=(SmallVec&& o) noexcept {
+        if (this != &o) {
+            release();
+            steal(o);
+        }
+        return *this;
+    }
+
+    void reserve(size_t c) {
+        if (c <= cap) return;
+        size_t nc = std::max(c, 2 * cap);
+        T* p = new T[nc];
+        std::memcpy(p, ptr, n * sizeof(T));
+        release();
+        ptr = p;
+        cap = nc;
+    }
+
+    void assign(const T* src, size_t count) {
+        n = 0;
+        shrinkInline();
+        reserve(count);
+        std::memcpy(ptr, src, count * sizeof(T));
+        n = count;
+    }
+
+    void push_back(T v) {
+        if (n == cap) reserve(n + 1);
+        ptr[n++] = v;
+    }
+
+    void insert(size_t i, T v) {
+        if (n == cap) reserve(n + 1);
+        std::memmove(ptr + i + 1, ptr + i, (n - i) * sizeof(T));
+        ptr[i] = v;
+        ++n;
+    }
+
+    void erase(size_t i) {
+        std::memmove(ptr + i, ptr + i + 1, (n - i - 1) * sizeof(T));
+        --n;
+        shrinkInline();
+    }
+
+    void resize(size_t count) {
+        reserve(count);
+        n = count;
+        shrinkInline();
+    }
+
+    void clear() { n = 0; }
+    size_t size() const { return n; }
+    bool empty() const { return n == 0; }
+    bool inlined() const { return ptr == inl; }
+    size_t heapBytes() const { return inlined() ? 0 : heap_block_bytes(cap * sizeof(T)); }
+    T* begin() { return ptr; }
+    T* end() { return ptr + n; }
+    const T* begin() const { return ptr; }
+    const T* end() const { return ptr + n; }
+    T& operator[](size_t i) { return ptr[i]; }
+    const T& operator[](size_t i) const { return ptr[i]; }
+    T& back() { return ptr[n - 1]; }
+    const T& back() const { return ptr[n - 1]; }
+};
+
+//=================================================================================================================
+//======================================  FlatPiecewise  ==========================================================
+//=================================================================================================================
+
+// Interp : Linear (défaut) ou Step, fonction en escalier (voir piecewise_core.cpp)
+template <size_t Inline = 8, typename Interp = Linear>
+class FlatPiecewiseT {
+private:
+    SmallVec<double, Inline> xs; // abscisses triées
+    SmallVec<double, Inline> ds; // deltaY
+    // Cache des valeurs cumulées ys[i] = f(xs[i]), à jour pour i < clean. eval est const : plusieurs threads
+    // peuvent remplir le cache d'un même objet en même temps. Comme pour PiecewiseLinearFunction, lock sérialise
+    // le remplissage et clean (publié en release) évite le verrou une fois à jour ; la copie lit le cache de la
+    // source sous son verrou.
+    struct Cache {
+        SmallVec<double, Inline> ys;
+        std::atomic<size_t> clean{0};
+        mutable std::mutex lock;
+
+        Cache() = default;
+        Cache(const Cache& other) { *this = other; }
+        Cache(Cache&& other) noexcept : ys(std::move(other.ys)), clean(other.clean.load(std::memory_order_relaxed)) {}
+        Cache& operator=(const Cache& other) {
+            if (this == &other) return *this;
+            std::lock_guard<std::mutex> guard(other.lock);
+            ys = other.ys;
+            clean.store(other.clean.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            return *this;
+        }
+        Cache& operator=(Cache&& other) noexcept {
+            ys = std::move(other.ys);
+            clean.store(other.clean.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            return *this;
+        }
+    };
+    mutable Cache cache;
+    bool autoNormalize = false; // normalisation après chaque sum/minus/minfunction/maxfunction
+
+    // Écritures : l'objet n'est pas partagé, aucun lecteur concurrent
+    void touch(size_t i) {
+        cache.clean.store(std::min(cache.clean.load(std::memory_order_relaxed), i), std::memory_order_relaxed);
+    }
+
+    void refresh() const {
+        size_t n = xs.size();
+        if (cache.clean.load(std::memory_order_acquire) >= n) return;
+        std::lock_guard<std::mutex> guard(cache.lock);
+        size_t clean = cache.clean.load(std::memory_order_relaxed);
+        if (clean >= n) return; // rempli par un autre thread entre-temps
+        SmallVec<double, Inline>& ys = cache.ys;
+        ys.resize(n);
+        double y = clean ? ys[clean - 1] : 0.0;
+        for (size_t i = clean; i < n; ++i) {
+            y += ds[i];
+            ys[i] = y;
+        }
+        cache.clean.store(n, std::memory_order_release);
+    }
+
+    // premier indice d'abscisse >= x
+    size_t lowerIndex(double x) const {
+        return std::lower_bound(xs.begin(), xs.end(), x) - xs.begin();
+    }
+
+    // Même règle que PiecewiseLinearFunction::eval : segment du premier x_j (j >= 1) avec x < x_j, comparaisons
+    // exactes. En escalier : valeur cumulée du dernier point d'abscisse <= x, sans interpolation.
+    double eval(double x) const {
+        refresh();
+        const SmallVec<double, Inline>& ys = cache.ys;
+        size_t n = xs.size();
+        if constexpr (Interp::step) {
+            size_t j;
+            if (n <= LINEAR_SCAN_MAX) {
+                j = 0;
+                for (size_t i = 0; i < n; ++i) j += (xs[i] <= x);
+            } else {
+                j = std::upper_bound(xs.begin(), xs.end(), x) - xs.begin();
+            }
+            return j ? ys[j - 1] : 0.0;
+        }
+        if (n == 0 || x < xs[0]) return 0.0;
+
+        size_t j;
+        if (n <= LINEAR_SCAN_MAX) {
+            // petits profils : comptage sans branche, vectorisable
+            size_t c = 0;
+            for (size_t i = 1; i < n; ++i) c += (xs[i] <= x);
+            j = 1 + c;
+        } else {
+            j = std::upper_bound(xs.begin() + 1, xs.end(), x) - xs.begin();
+        }
+
+        if (j == n) return ys[n - 1];
+        double slope = (ys[j] - ys[j - 1]) / (xs[j] - xs[j - 1]);
+        return ys[j - 1] + slope * (x - xs[j - 1]);
+    }
+
+    size_t simplifyBand(double lo, double hi) {
+        auto pts = to_points_delta();
+        auto kept = simplify_deltas<Interp>(pts, lo, hi);
+        if (kept.size() == pts.size()) return 0;
+        assignPoints(kept);
+        return pts.size() - kept.size();
+    }
+
+    // Remplace les points par une suite (x, deltaY) triée, en O(n)
+    void assignPoints(const std::vector<std::pair<double, double>>& pts) {
+        xs.resize(pts.size());
+        ds.resize(pts.size());
+        for (size_t i = 0; i < pts.size(); ++i) {
+            xs[i] = pts[i].first;
+            ds[i] = pts[i].second;
+        }
+        touch(0);
+    }
+
+public:
+    using Interpolation = Interp;
+
+    // Au-delà, eval passe du balayage linéaire à la recherche dichotomique
+    static constexpr size_t LINEAR_SCAN_MAX = 32;
+
+    FlatPiecewiseT(double y0 = 0.0) {
+        xs.push_back(0.0);
+        ds.push_back(y0);
+    }
+
+    // Conversions depuis / vers la représentation std::map
+    explicit FlatPiecewiseT(const PiecewiseLinearFunction& f) {
+        assignPoints(f.to_points_delta());
+    }
+
+    // Fonction construite à partir de points (x, deltaY) triés, en O(n)
+    static FlatPiecewiseT from_points(const std::vector<std::pair<double, double>>& pts) {
+        FlatPiecewiseT r;
+        r.assignPoints(pts);
+        return r;
+    }
+
+    PiecewiseLinearFunction to_map() const {
+        return PiecewiseLinearFunction::from_points(to_points_delta());
+    }
+
+    void addBreakpoint(double x, double deltaY) {
+        // Remplace la valeur existante si le point de rupture existe (comme PiecewiseLinearFunction)
+        size_t i = lowerIndex(x);
+        if (i < xs.size() && xs[i] == x) {
+            ds[i] = deltaY;
+        } else {
+            xs.insert(i, x);
+            ds.insert(i, deltaY);
+        }
+        touch(i);
+    }
+
+    void removeBreakpoint(double x) {
+        size_t i = lowerIndex(x);
+        if (i < xs.size() && xs[i] == x) {
+            xs.erase(i);
+            ds.erase(i);
+            touch(i);
+        }
+    }
+
+    // Évalue la fonction en un point x
+    double evaluate(double x) const {
+        return eval(x);
+    }
+
+    size_t size() const { return xs.size(); }
+
+    // Vrai tant que les points tiennent dans le stockage en ligne (aucune allocation)
+    bool inlined() const { return xs.inlined() && ds.inlined(); }
+
+    // Même rapport que RedBlackTree::stats() ; tableaux triés, pas de forme d'arbre (shapeKnown = false).
+    // bytes : tableaux débordés sur le tas (0 tant que les points tiennent en ligne).
+    ProfileStats stats() const {
+        ProfileStats s;
+        s.shapeKnown = false;
+        s.nodes = xs.size();
+        s.payloadBytes = s.nodes * 2 * sizeof(double);
+        std::lock_guard<std::mutex> guard(cache.lock); // cache éventuellement rempli par un autre thread
+        s.bytes = xs.heapBytes() + ds.heapBytes() + cache.ys.heapBytes();
+        return s;
+    }
+
+//======================================================================================================
+//====================================== opérations sur les fonctions ==================================
+//======================================================================================================
+    // Addition de deux fonctions
+    void sum(const FlatPiecewiseT& g) {
+        if (g.xs.empty()) return;
+        zip_inplace(g, OpPlus(), NoSwitch());
+    }
+
+    // Soustraction de deux fonctions (this - g)
+    void minus(const FlatPiecewiseT& g) {
+        if (g.xs.empty()) return;
+        zip_inplace(g, OpMinus(), NoSwitch());
+    }
+
+    // f += a * g en une seule fusion, g reste intact
+    void add_scaled(const FlatPiecewiseT& g, double a) {
+        if (g.xs.empty()) return;
+        zip_inplace(g, OpAxpy{a}, NoSwitch());
+    }
+
+    // f = clamp(f + g, lo, hi) en une seule fusion, avec les points de coupure sur lo et hi (lo <= 0 <= hi)
+    void add_clamped(const FlatPiecewiseT& g, double lo, double hi) {
+        zip_inplace(g, OpAddClamp{lo, hi}, SwitchAddClamp{lo, hi});
+    }
+
+    // f += w * g. Dans des tableaux, insérer les points de g décale déjà toute la fin :
+    // une fusion O(n + m) fait aussi bien que la mise à jour locale de la version std::map.
+    void apply_delta(const FlatPiecewiseT& g, double w = 1.0) {
+        add_scaled(g, w);
+    }
+
+    // Enveloppes supérieure max_k f_k et inférieure min_k f_k de K fonctions (balayage avec croisements)
+    static FlatPiecewiseT envelope_max(std::span<const FlatPiecewiseT*> fs) {
+        return envelope(fs, true);
+    }
+
+    static FlatPiecewiseT envelope_min(std::span<const FlatPiecewiseT*> fs) {
+        return envelope(fs, false);
+    }
+
+    static FlatPiecewiseT envelope(std::span<const FlatPiecewiseT*> fs, bool upper) {
+        std::vector<Cursor> srcs;
+        srcs.reserve(fs.size());
+        for (const FlatPiecewiseT* f : fs) srcs.push_back(f->cursor());
+        FlatPiecewiseT r;
+        r.assignPoints(envelope_deltas<Interp>(srcs, upper));
+        return r;
+    }
+
+    // Somme pondérée de K fonctions (weights vide = poids 1) en un seul balayage k-way, O(N log K)
+    static FlatPiecewiseT sum_all(std::span<const FlatPiecewiseT*> fs, std::span<const double> weights = {}) {
+        std::vector<Cursor> srcs;
+        srcs.reserve(fs.size());
+        for (const FlatPiecewiseT* f : fs) srcs.push_back(f->cursor());
+        FlatPiecewiseT r;
+        r.assignPoints(sum_all_deltas<Interp>(srcs, std::vector<double>(weights.begin(), weights.end())));
+        return r;
+    }
+
+    // Négation de la fonction
+    void negate() {
+        for (double& d : ds) d = -d;
+        touch(0);
+    }
+
+    // min(f, c) / max(f, c) : la constante c est définie à partir de x = 0
+    void minfunction(double c) {
+        std::vector<std::pair<double, double>> cst{{0.0, c}};
+        assignPoints(zip_deltas<Interp>(cursor(), VectorSource{&cst}, OpMin(), SwitchFG()));
+        if (autoNormalize) normalize();
+    }
+
+    void maxfunction(double c) {
+        std::vector<std::pair<double, double>> cst{{0.0, c}};
+        assignPoints(zip_deltas<Interp>(cursor(), VectorSource{&cst}, OpMax(), SwitchFG()));
+        if (autoNormalize) normalize();
+    }
+
+    // min(f, g) / max(f, g) point par point, croisements inclus
+    void minfunction(const FlatPiecewiseT& g) {
+        zip_inplace(g, OpMin());
+    }
+
+    void maxfunction(const FlatPiecewiseT& g) {
+        zip_inplace(g, OpMax());
+    }
+
+//======================================================================================================
+//====================================== fusion générique f op g (zip) =================================
+//======================================================================================================
+    // Parcours des points (x, deltaY) dans l'ordre croissant : source du moteur de fusion
+    struct Cursor {
+        const double* x;
+        const double* d;
+        const double* end;
+        bool next(double& px, double& pd) {
+            if (x == end) return false;
+            px = *x++;
+            pd = *d++;
+            return true;
+        }
+    };
+
+    Cursor cursor() const {
+        return Cursor{xs.begin(), ds.begin(), xs.end()};
+    }
+
+    // r = op(f, g) dans une nouvelle fonction, en O(n + m)
+    template <typename Op, typename Switch = SwitchFG>
+    FlatPiecewiseT zip(const FlatPiecewiseT& g, Op op, Switch sw = Switch()) const {
+        FlatPiecewiseT r;
+        r.assignPoints(zip_deltas<Interp>(cursor(), g.cursor(), op, sw));
+        return r;
+    }
+
+    // f = op(f, g) en place
+    template <typename Op, typename Switch = SwitchFG>
+    void zip_inplace(const FlatPiecewiseT& g, Op op, Switch sw = Switch()) {
+        assignPoints(zip_deltas<Interp>(cursor(), g.cursor(), op, sw));
+        if (autoNormalize) normalize();
+    }
+
+//======================================================================================================
+//====================================== normalisation : points redondants =============================
+//======================================================================================================
+    // Active la normalisation automatique après chaque sum/minus/minfunction/maxfunction
+    void setAutoNormalize(bool on) { autoNormalize = on; }
+
+    // Mêmes règles que PiecewiseLinearFunction::normalize (en escalier : tout point sans saut).
+    // Retourne le nombre de points supprimés.
+    size_t normalize(double tol = COLLINEAR_TOL) {
+        return normalize(-std::numeric_limits<double>::infinity(),
+                         std::numeric_limits<double>::infinity(), tol);
+    }
+
+    // Version locale : on n'examine que les points de [xmin, xmax] et leurs deux voisins.
+    // Les suppressions sont faites sur une liste chaînée d'indices, puis les tableaux sont compactés en O(n).
+    size_t normalize(double xmin, double xmax, double tol = COLLINEAR_TOL) {
+        size_t n = xs.size();
+        if (n == 0) return 0;
+        const size_t NONE = n;
+        std::vector<size_t> prv(n), nxt(n);
+        for (size_t i = 0; i < n; ++i) {
+            prv[i] = i ? i - 1 : NONE;
+            nxt[i] = i + 1;
+        }
+        std::vector<char> gone(n, 0);
+        auto unlink = [&](size_t i) {
+            if (prv[i] != NONE) nxt[prv[i]] = nxt[i];
+            if (nxt[i] != NONE) prv[nxt[i]] = prv[i];
+            gone[i] = 1;
+        };
+
+        size_t removed = 0;
+        size_t it = lowerIndex(xmin);
+        if (it > 0) --it;
+        size_t first = it;
+
+        while (it != NONE) {
+            size_t next = nxt[it];
+
+            size_t after = next != NONE ? nxt[next] : NONE;
+            if (next != NONE &&
+                is_fusable(xs[it], xs[next], ds[next],
+                           after != NONE ? xs[after] : std::numeric_limits<double>::infinity(),
+                           after != NONE && !Interp::step ? ds[after] : 0.0, EPSILON, tol)) {
+                ds[it] += ds[next];
+                unlink(next);
+                ++removed;
+                continue; // it a un nouveau voisin, on le réexamine
+            }
+
+            bool hasPrev = prv[it] != NONE;
+            bool hasNext = next != NONE;
+            bool redundant = false;
+            if (Interp::step) {
+                redundant = is_redundant_step(ds[it], tol);
+            } else if (hasPrev && hasNext) {
+                size_t prev = prv[it];
+                redundant = is_collinear(xs[prev], xs[it], ds[it], xs[next], ds[next], tol);
+            } else if (hasNext) {
+                redundant = is_redundant_first(ds[it], ds[next], tol);
+            } else if (hasPrev) {
+                redundant = is_redundant_last(ds[it], tol);
+            }
+
+            bool pastRange = xs[it] > xmax;
+            if (redundant) {
+                if (hasNext) ds[next] += ds[it];
+                unlink(it);
+                ++removed;
+            }
+            if (pastRange) break;
+            it = next;
+        }
+
+        if (removed) {
+            size_t k = first;
+            for (size_t i = first; i < n; ++i) {
+                if (gone[i]) continue;
+                xs[k] = xs[i];
+                ds[k] = ds[i];
+                ++k;
+            }
+            xs.resize(k);
+            ds.resize(k);
+        }
+        touch(first);
+        return removed;
+    }
+
+//======================================================================================================
+//====================================== simplification à erreur bornée ================================
+//======================================================================================================
+    // Approximation linéaire par morceaux avec |g - f| <= max_error partout (sous-ensemble des points de f)
+    size_t simplify(double max_error) {
+        return simplifyBand(-max_error, max_error);
+    }
+
+    // Variante conservative : f <= g <= f + max_error (majorant)
+    size_t simplify_upper(double max_error) {
+        return simplifyBand(0.0, max_error);
+    }
+
+    // Variante conservative : f - max_error <= g <= f (minorant)
+    size_t simplify_lower(double max_error) {
+        return simplifyBand(-max_error, 0.0);
+    }
+
+    // Garde au plus max_points points (au moins 2) ; retourne l'erreur L-infini garantie
+    double simplify_to(size_t max_points) {
+        double err = simplify_error_for<Interp>(to_points_delta(), max_points);
+        simplify(err); // err = 0 (f constante par exemple) : seuls les points exactement alignés partent
+        return err;
+    }
+
+//======================================================================================================
+//====================================== comparaison, min/max sur un intervalle ========================
+//======================================================================================================
+    // Vérifie si la fonction est toujours inférieure ou égale à une autre
+    bool isLessOrEqual(const FlatPiecewiseT& g) const {
+        bool result = true;
+        merge_walk<Interp>(cursor(), g.cursor(), [&](double, double F, double G) {
+            if (F > G + COLLINEAR_TOL * std::max(1.0, std::fabs(G))) result = false; // g(x) < f(x), aux arrondis près
+            return result;
+        });
+        return result;
+    }
+
+    // Évaluation du maximum sur un intervalle : bornes et points intérieurs
+    double evaluate_max(double t_inf, double t_sup) const {
+        if (t_inf > t_sup) return evaluate(t_inf);
+        double maxVal = std::max(evaluate(t_inf), evaluate(t_sup));
+        size_t end = std::upper_bound(xs.begin(), xs.end(), t_sup) - xs.begin();
+        for (size_t i = lowerIndex(t_inf); i < end; ++i) maxVal = std::max(maxVal, evaluate(xs[i]));
+        return maxVal;
+    }
+
+    // Évaluation du minimum sur un intervalle
+    double evaluate_min(double t_inf, double t_sup) const {
+        if (t_inf > t_sup) return evaluate(t_inf);
+        double minVal = std::min(evaluate(t_inf), evaluate(t_sup));
+        size_t end = std::upper_bound(xs.begin(), xs.end(), t_sup) - xs.begin();
+        for (size_t i = lowerIndex(t_inf); i < end; ++i) minVal = std::min(minVal, evaluate(xs[i]));
+        return minVal;
+    }
+
+//======================================================================================================
+//====================================== profils delta et mises à jour CBR =============================
+//======================================================================================================
+    static FlatPiecewiseT delta_profile(double gap, double a, double b, double c) {
+        FlatPiecewiseT delta;
+        delta.addBreakpoint(a, 0);
+        delta.addBreakpoint(b, gap);
+        delta.addBreakpoint(c, -gap);
+        return delta;
+    }
+
+    static FlatPiecewiseT cba_profile(double cap, double a, double b) {
+        FlatPiecewiseT cba;
+        cba.addBreakpoint(a, 0);
+        cba.addBreakpoint(b, cap);
+        return cba;
+    }
+
+    static FlatPiecewiseT hat_delta(const CbrHat& h) {
+        return h.active ? delta_profile(h.gap, h.a, h.b, h.c) : FlatPiecewiseT();
+    }
+
+    static FlatPiecewiseT cbr_stmin_delta(double stmin_old, double stmin, double ctmin, double cap_min, double cap_max) {
+        return hat_delta(cbr_stmin_hat(stmin_old, stmin, ctmin, cap_min, cap_max, CBR_TOL));
+    }
+
+    static FlatPiecewiseT cbr_ctmin_delta(double ctmin_old, double ctmin, double stmin, double cap_min, double cap_max) {
+        return hat_delta(cbr_ctmin_hat(ctmin_old, ctmin, stmin, cap_min, cap_max, CBR_TOL));
+    }
+
+    static FlatPiecewiseT cbr_stmax_delta(double stmax_old, double stmax, double ctmax, double cap_min, double cap_max) {
+        return hat_delta(cbr_stmax_hat(stmax_old, stmax, ctmax, cap_min, cap_max, CBR_TOL));
+    }
+
+    static FlatPiecewiseT cbr_ctmax_delta(double ctmax_old, double ctmax, double stmax, double cap_min, double cap_max) {
+        return hat_delta(cbr_ctmax_hat(ctmax_old, ctmax, stmax, cap_min, cap_max, CBR_TOL));
+    }
+
+    static FlatPiecewiseT cbr_cap_delta(double cap_old, double cap, double start, double end) {
+        if (std::abs(cap - cap_old) < CBR_TOL) return FlatPiecewiseT();
+        return cba_profile(cap - cap_old, start, end);
+    }
+
+    void update_cbr_stmin(double stmin_old, double stmin, double ctmin, double cap_min, double cap_max) {
+        apply_delta(cbr_stmin_delta(stmin_old, stmin, ctmin, cap_min, cap_max));
+    }
+
+    void update_cbr_ctmin(double ctmin_old, double ctmin, double stmin, double cap_min, double cap_max) {
+        apply_delta(cbr_ctmin_delta(ctmin_old, ctmin, stmin, cap_min, cap_max));
+    }
+
+    void update_cbr_stmax(double stmax_old, double stmax, double ctmax, double cap_min, double cap_max) {
+        apply_delta(cbr_stmax_delta(stmax_old, stmax, ctmax, cap_min, cap_max));
+    }
+
+    void update_cbr_ctmax(double ctmax_old, double ctmax, double stmax, double cap_min, double cap_max) {
+        apply_delta(cbr_ctmax_delta(ctmax_old, ctmax, stmax, cap_min, cap_max));
+    }
+
+    void update_cbr_cap(double cap_old, double cap, double start, double end) {
+        apply_delta(cbr_cap_delta(cap_old, cap, start, end));
+    }
+
+//======================================================================================================
+//====================================== export et extraction des points ===============================
+//======================================================================================================
+    // Exportation des points (x, f(x)) vers un fichier
+    void exportFunction(const std::string& filename) const {
+        std::ofstream out(filename);
+        if (!out) {
+            std::cerr << "Erreur: impossible d'ouvrir le fichier " << filename << std::endl;
+            return;
+        }
+        for (const auto& [x, y] : to_points_cumulative()) out << x << " " << y << "\n";
+        out.close();
+        trace<TraceLevel::Info>("flat.export", (double)xs.size());
+    }
+
+    std::vector<std::pair<double, double>> to_points_delta() const {
+        std::vector<std::pair<double, double>> pts(xs.size());
+        for (size_t i = 0; i < xs.size(); ++i) pts[i] = {xs[i], ds[i]};
+        return pts;
+    }
+
+    std::vector<std::pair<double, double>> to_points_cumulative() const {
+        refresh();
+        std::vector<std::pair<double, double>> pts(xs.size());
+        for (size_t i = 0; i < xs.size(); ++i) pts[i] = {xs[i], cache.ys[i]};
+        return pts;
+    }
+};
+
+using FlatPiecewise = FlatPiecewiseT<>;
+using FlatStep = FlatPiecewiseT<8, Step>; // fonction en escalier : eval = recherche dans les sommes préfixes
+
+//===================== Expressions paresseuses =====================
+
+template <size_t Inline, typename I>
+ProfileExpr<FlatPiecewiseT<Inline, I>> operator+(const FlatPiecewiseT<Inline, I>& a, const FlatPiecewiseT<Inline, I>& b) {
+    return lazy(a) + b;
+}
+
+template <size_t Inline, typename I>
+ProfileExpr<FlatPiecewiseT<Inline, I>> operator-(const FlatPiecewiseT<Inline, I>& a, const FlatPiecewiseT<Inline, I>& b) {
+    return lazy(a) - b;
+}
+
+template <size_t Inline, typename I>
+ProfileExpr<FlatPiecewiseT<Inline, I>> operator-(const FlatPiecewiseT<Inline, I>& a) {
+    return -lazy(a);
+}
+
+template <size_t Inline, typename I>
+ProfileExpr<FlatPiecewiseT<Inline, I>> operator*(double w, const FlatPiecewiseT<Inline, I>& a) {
+    return w * lazy(a);
+}
+
+static_assert(PiecewiseBackend<FlatPiecewise>);
+static_assert(PiecewiseBackend<FlatStep>);
@@ -0,0 +1,372 @@
+#pragma once
+// PiecewiseFunction : façade qui choisit seule sa représentation selon le nombre de points.
+//  - Inline : FlatPiecewise dont les points tiennent dans l'objet (delta_profile, cba_profile),
+//  - Flat   : FlatPiecewise sur le tas (tableaux triés contigus),
+//  - Tree   : RedBlackTree<DeltaPoint, Augment<SumDelta, Count>> (arbre augmenté des sommes de deltaY et du
+//             nombre de points : eval, somme préfixe et size() en O(log n) au plus, size() étant appelé par
+//             adapt() après chaque modification ; mise à jour locale apply_delta). Copie en O(n), comme les
+//             tableaux.
+// Inline <-> Flat se fait tout seul dans les tableaux (retour en ligne à la moitié de la capacité en ligne) ;
+// Flat <-> Tree suit deux seuils avec hystérésis : passage en arbre au-delà de promoteAt points, retour en
+// tableaux sous demoteAt (demoteAt < promoteAt), pour ne pas convertir à chaque point ajouté ou retiré
+// autour d'un seuil.
+//
+// Les deux représentations ont la même sémantique (même règle d'évaluation, même seuil CBR ; leur tolérance
+// d'abscisses ne sert qu'aux fusions de normalize, bornées par tol) : changer de mode ne change pas la
+// fonction. Les opérations binaires fusionnent directement les curseurs des deux opérandes, quel que soit
+// leur mode.
+#include <variant>
+#include "RBT_sarah.cpp"
+#include "piecewise_flat.cpp"
+
+class PiecewiseFunction {
+public:
+    enum class Mode { Inline, Flat, Tree };
+
+    // Seuils de changement de représentation, communs à toutes les instances
+    struct Thresholds {
+        size_t promoteAt = 256; // Flat -> Tree quand size() > promoteAt
+        size_t demoteAt = 64;   // Tree -> Flat quand size() < demoteAt
+    };
+
+    static Thresholds& thresholds() {
+        static Thresholds t;
+        return t;
+    }
+
+    static void setThresholds(size_t promoteAt, size_t demoteAt) {
+        if (demoteAt >= promoteAt) throw std::invalid_argument("PiecewiseFunction : demoteAt doit être < promoteAt");
+        thresholds() = Thresholds{promoteAt, demoteAt};
+    }
+
+    using Tree = RedBlackTree<DeltaPoint, Augment<SumDelta, Count>>;
+
+private:
+    std::variant<FlatPiecewise, Tree> rep;
+    bool autoNormalize = false;
+
+    template <typename Fn>
+    decltype(auto) visit(Fn&& fn) { return std::visit(std::forward<Fn>(fn), rep); }
+
+    template <typename Fn>
+    decltype(auto) visit(Fn&& fn) const { return std::visit(std::forward<Fn>(fn), rep); }
+
+    bool isTree() const { return std::holds_alternative<Tree>(rep); }
+
+    // Représentation voulue pour n points, en partant du mode courant (hystérésis)
+    static bool wantTree(size_t n, bool tree) {
+        const Thresholds& t = thresholds();
+        return tree ? n >= t.demoteAt : n > t.promoteAt;
+    }
+
+    void setPoints(const std::vector<std::pair<double, double>>& pts) {
+        if (wantTree(pts.size(), isTree())) rep = Tree::from_points(pts);
+        else rep = FlatPiecewise::from_points(pts);
+        visit([&](auto& f) { f.setAutoNormalize(autoNormalize); });
+    }
+
+    // À appeler après chaque modification en place : convertit si un seuil est franchi
+    void adapt() {
+        size_t n = size();
+        if (wantTree(n, isTree()) != isTree()) setPoints(to_points_delta());
+    }
+
+public:
+    PiecewiseFunction(double y0 = 0.0) : rep(FlatPiecewise(y0)) {}
+
+    explicit PiecewiseFunction(const Tree& f) { setPoints(f.to_points_delta()); }
+    explicit PiecewiseFunction(const PiecewiseLinearFunction& f) { setPoints(f.to_points_delta()); }
+    explicit PiecewiseFunction(const FlatPiecewise& f) { setPoints(f.to_points_delta()); }
+
+    static PiecewiseFunction from_points(const std::vector<std::pair<double, double>>& pts) {
+        PiecewiseFunction r;
+        r.setPoints(pts);
+        return r;
+    }
+
+    // Mode courant, pour l'instrumentation
+    Mode mode() const {
+        if (isTree()) return Mode::Tree;
+        return std::get<FlatPiecewise>(rep).inlined() ? Mode::Inline : Mode::Flat;
+    }
+
+    static const char* modeName(Mode m) {
+        switch (m) {
+        case Mode::Inline: return "inline";
+        case Mode::Flat:   return "flat";
+        case Mode::Tree:   return "tree";
+        }
+        return "?";
+    }
+
+    size_t size() const { return visit([](const auto& f) { return f.size(); }); }
+
+    void addBreakpoint(double x, double deltaY) {
+        visit([&](auto& f) { f.addBreakpoint(x, deltaY); });
+        adapt();
+    }
+
+    void removeBreakpoint(double x) {
+        visit([&](auto& f) { f.removeBreakpoint(x); });
+        adapt();
+    }
+
+    // Évalue la fonction en un point x
+    double evaluate(double x) const {
+        return visit([&](const auto& f) { return f.evaluate(x); });
+    }
+
+//======================================================================================================
+//====================================== fusion générique f op g (zip) =================================
+//======================================================================================================
+    // Curseur sur l'une ou l'autre représentation
+    struct Cursor {
+        std::variant<FlatPiecewise::Cursor, Tree::Cursor> c;
+        bool next(double& x, double& d) {
+            return std::visit([&](auto& s) { return s.next(x, d); }, c);
+        }
+    };
+
+    Cursor cursor() const {
+        return visit([](const auto& f) { return Cursor{f.cursor()}; });
+    }
+
+    // r = op(f, g) dans une nouvelle fonction, en O(n + m), avec le mode adapté à la taille du résultat
+    template <typename Op, typename Switch = SwitchFG>
+    PiecewiseFunction zip(const PiecewiseFunction& g, Op op, Switch sw = Switch()) const {
+        return from_points(zip_deltas(cursor(), g.cursor(), op, sw));
+    }
+
+    // f = op(f, g) en place
+    template <typename Op, typename Switch = SwitchFG>
+    void zip_inplace(const PiecewiseFunction& g, Op op, Switch sw = Switch()) {
+        setPoints(zip_deltas(cursor(), g.cursor(), op, sw));
+        if (autoNormalize) normalize();
+    }
+
+//======================================================================================================
+//====================================== opérations sur les fonctions ==================================
+//======================================================================================================
+    void sum(const PiecewiseFunction& g) {
+        if (g.size() == 0) return;
+        zip_inplace(g, OpPlus(), NoSwitch());
+    }
+
+    void minus(const PiecewiseFunction& g) {
+        if (g.size() == 0) return;
+        zip_inplace(g, OpMinus(), NoSwitch());
+    }
+
+    void add_scaled(const PiecewiseFunction& g, double a) {
+        if (g.size() == 0) return;
+        zip_inplace(g, OpAxpy{a}, NoSwitch());
+    }
+
+    void add_clamped(const PiecewiseFunction& g, double lo, double hi) {
+        zip_inplace(g, OpAddClamp{lo, hi}, SwitchAddClamp{lo, hi});
+    }
+
+    // f += w * g : mise à jour locale en mode arbre, fusion en mode tableaux
+    void apply_delta(const PiecewiseFunction& g, double w = 1.0) {
+        if (auto* t = std::get_if<Tree>(&rep)) {
+            t->apply_delta(RedBlackTree<DeltaPoint>::from_points(g.to_points_delta()), w);
+            adapt();
+        } else {
+            add_scaled(g, w);
+        }
+    }
+
+    static PiecewiseFunction envelope_max(std::span<const PiecewiseFunction*> fs) {
+        return envelope(fs, true);
+    }
+
+    static PiecewiseFunction envelope_min(std::span<const PiecewiseFunction*> fs) {
+        return envelope(fs, false);
+    }
+
+    static PiecewiseFunction envelope(std::span<const PiecewiseFunction*> fs, bool upper) {
+        std::vector<Cursor> srcs;
+        srcs.reserve(fs.size());
+        for (const PiecewiseFunction* f : fs) srcs.push_back(f->cursor());
+        return from_points(envelope_deltas(srcs, upper));
+    }
+
+    static PiecewiseFunction sum_all(std::span<const PiecewiseFunction*> fs, std::span<const double> weights = {}) {
+        std::vector<Cursor> srcs;
+        srcs.reserve(fs.size());
+        for (const PiecewiseFunction* f : fs) srcs.push_back(f->cursor());
+        return from_points(sum_all_deltas(srcs, std::vector<double>(weights.begin(), weights.end())));
+    }
+
+    void negate() {
+        visit([](auto& f) { f.negate(); });
+    }
+
+    void minfunction(double c) {
+        visit([&](auto& f) { f.minfunction(c); });
+        adapt();
+    }
+
+    void maxfunction(double c) {
+        visit([&](auto& f) { f.maxfunction(c); });
+        adapt();
+    }
+
+    void minfunction(const PiecewiseFunction& g) {
+        zip_inplace(g, OpMin());
+    }
+
+    void maxfunction(const PiecewiseFunction& g) {
+        zip_inplace(g, OpMax());
+    }
+
+//======================================================================================================
+//====================================== normalisation, simplification =================================
+//======================================================================================================
+    void setAutoNormalize(bool on) {
+        autoNormalize = on;
+        visit([&](auto& f) { f.setAutoNormalize(on); });
+    }
+
+    size_t normalize(double tol = COLLINEAR_TOL) {
+        size_t r = visit([&](auto& f) { return f.normalize(tol); });
+        adapt();
+        return r;
+    }
+
+    size_t normalize(double xmin, double xmax, double tol = COLLINEAR_TOL) {
+        size_t r = visit([&](auto& f) { return f.normalize(xmin, xmax, tol); });
+        adapt();
+        return r;
+    }
+
+    size_t simplify(double max_error) {
+        size_t r = visit([&](auto& f) { return f.simplify(max_error); });
+        adapt();
+        return r;
+    }
+
+    size_t simplify_upper(double max_error) {
+        size_t r = visit([&](auto& f) { return f.simplify_upper(max_error); });
+        adapt();
+        return r;
+    }
+
+    size_t simplify_lower(double max_error) {
+        size_t r = visit([&](auto& f) { return f.simplify_lower(max_error); });
+        adapt();
+        return r;
+    }
+
+    double simplify_to(size_t max_points) {
+        double r = visit([&](auto& f) { return f.simplify_to(max_points); });
+        adapt();
+        return r;
+    }
+
+//======================================================================================================
+//====================================== comparaison, min/max sur un intervalle ========================
+//======================================================================================================
+    bool isLessOrEqual(const PiecewiseFunction& g) const {
+        bool result = true;
+        merge_walk(cursor(), g.cursor(), [&](double, double F, double G) {
+            if (F > G + COLLINEAR_TOL * std::max(1.0, std::fabs(G))) result = false; // g(x) < f(x), aux arrondis près
+            return result;
+        });
+        return result;
+    }
+
+    double evaluate_max(double t_inf, double t_sup) const {
+        return visit([&](const auto& f) { return f.evaluate_max(t_inf, t_sup); });
+    }
+
+    double evaluate_min(double t_inf, double t_sup) const {
+        return visit([&](const auto& f) { return f.evaluate_min(t_inf, t_sup); });
+    }
+
+//======================================================================================================
+//====================================== profils delta et mises à jour CBR =============================
+//======================================================================================================
+    static PiecewiseFunction delta_profile(double gap, double a, double b, double c) {
+        return PiecewiseFunction(FlatPiecewise::delta_profile(gap, a, b, c));
+    }
+
+    static PiecewiseFunction cba_profile(double cap, double a, double b) {
+        return PiecewiseFunction(FlatPiecewise::cba_profile(cap, a, b));
+    }
+
+    static PiecewiseFunction cbr_stmin_delta(double stmin_old, double stmin, double ctmin, double cap_min, double cap_max) {
+        return PiecewiseFunction(FlatPiecewise::cbr_stmin_delta(stmin_old, stmin, ctmin, cap_min, cap_max));
+    }
+
+    static PiecewiseFunction cbr_ctmin_delta(double ctmin_old, double ctmin, double stmin, double cap_min, double cap_max) {
+        return PiecewiseFunction(FlatPiecewise::cbr_ctmin_delta(ctmin_old, ctmin, stmin, cap_min, cap_max));
+    }
+
+    static PiecewiseFunction cbr_stmax_delta(double stmax_old, double stmax, double ctmax, double cap_min, double cap_max) {
+        return PiecewiseFunction(FlatPiecewise::cbr_stmax_delta(stmax_old, stmax, ctmax, cap_min, cap_max));
+    }
+
+    static PiecewiseFunction cbr_ctmax_delta(double ctmax_old, double ctmax, double stmax, double cap_min, double cap_max) {
+        return PiecewiseFunction(FlatPiecewise::cbr_ctmax_delta(ctmax_old, ctmax, stmax, cap_min, cap_max));
+    }
+
+    static PiecewiseFunction cbr_cap_delta(double cap_old, double cap, double start, double end) {
+        return PiecewiseFunction(FlatPiecewise::cbr_cap_delta(cap_old, cap, start, end));
+    }
+
+    void update_cbr_stmin(double stmin_old, double stmin, double ctmin, double cap_min, double cap_max) {
+        apply_delta(cbr_stmin_delta(stmin_old, stmin, ctmin, cap_min, cap_max));
+    }
+
+    void update_cbr_ctmin(double ctmin_old, double ctmin, double stmin, double cap_min, double cap_max) {
+        apply_delta(cbr_ctmin_delta(ctmin_old, ctmin, stmin, cap_min, cap_max));
+    }
+
+    void update_cbr_stmax(double stmax_old, double stmax, double ctmax, double cap_min, double cap_max) {
+        apply_delta(cbr_stmax_delta(stmax_old, stmax, ctmax, cap_min, cap_max));
+    }
+
+    void update_cbr_ctmax(double ctmax_old, double ctmax, double stmax, double cap_min, double cap_max) {
+        apply_delta(cbr_ctmax_delta(ctmax_old, ctmax, stmax, cap_min, cap_max));
+    }
+
+    void update_cbr_cap(double cap_old, double cap, double start, double end) {
+        apply_delta(cbr_cap_delta(cap_old, cap, start, end));
+    }
+
+//======================================================================================================
+//====================================== export et extraction des points ===============================
+//======================================================================================================
+    void exportFunction(const std::string& filename) const {
+        visit([&](const auto& f) { f.exportFunction(filename); });
+    }
+
+    std::vector<std::pair<double, double>> to_points_delta() const {
+        return visit([](const auto& f) { return f.to_points_delta(); });
+    }
+
+    std::vector<std::pair<double, double>> to_points_cumulative() const {
+        return visit([](const auto& f) { return f.to_points_cumulative(); });
+    }
+};
+
+//===================== Expressions paresseuses =====================
+
+inline ProfileExpr<PiecewiseFunction> operator+(const PiecewiseFunction& a, const PiecewiseFunction& b) {
+    return lazy(a) + b;
+}
+
+inline ProfileExpr<PiecewiseFunction> operator-(const PiecewiseFunction& a, const PiecewiseFunction& b) {
+    return lazy(a) - b;
+}
+
+inline ProfileExpr<PiecewiseFunction> operator-(const PiecewiseFunction& a) {
+    return -lazy(a);
+}
+
+inline ProfileExpr<PiecewiseFunction> operator*(double w, const PiecewiseFunction& a) {
+    return w * lazy(a);
+}
+
+static_assert(PiecewiseBackend<PiecewiseFunction>);
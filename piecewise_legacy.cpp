@@ -0,0 +1,183 @@
+#pragma once
+// LegacyPiecewise : adaptateur des anciens prototypes (rbt_new.cpp, piecewise_RBT.cpp) à PiecewiseBackend.
+// Les deux prototypes définissent DeltaPoint et RedBlackTree : en inclure un seul, avant ce fichier, et ni
+// RBT_sarah.cpp ni piecewise_map.cpp dans la même unité (EPSILON de rbt_new.cpp).
+//
+// L'arbre du prototype reste la représentation ; l'adaptateur lui délègue ce qu'il sait faire : eval, sum, et
+// l'insertion d'un point nouveau, minus et negate quand il les a. sum et minus restent ceux du prototype, défauts
+// compris (le point qui suit une insertion n'est pas corrigé) : ils sont là pour être mesurés (bench_legacy.cpp).
+// Le reste (remplacement ou suppression d'un point, min / max, agrégats, simplification) passe par les points et
+// le moteur de piecewise_core.cpp, puis reconstruit l'arbre par insertions croissantes, toujours en fin d'arbre :
+// remove de rbt_new.cpp et toute insertion au milieu de piecewise_RBT.cpp plantent (MidInsert = false).
+// Les prototypes copient leur racine sans cloner : l'adaptateur copie par les points.
+#include <memory>
+#include "piecewise_concept.cpp"
+
+template <typename Tree, bool MidInsert>
+class LegacyPiecewise {
+public:
+    using Points = std::vector<std::pair<double, double>>;
+
+    LegacyPiecewise() = default;
+    LegacyPiecewise(const LegacyPiecewise& other) { assign(other.to_points_delta()); }
+
+    LegacyPiecewise& operator=(const LegacyPiecewise& other) {
+        if (this != &other) assign(other.to_points_delta());
+        return *this;
+    }
+
+    static LegacyPiecewise from_points(const Points& pts) {
+        LegacyPiecewise r;
+        r.assign(pts);
+        return r;
+    }
+
+    double evaluate(double x) const { return tree->eval(x); }
+
+    Points to_points_delta() const { return tree->to_points_delta(); }
+
+    size_t size() const { return to_points_delta().size(); }
+
+    // Point nouveau : insertion du prototype (en fin d'arbre seulement sans MidInsert) ; sinon par les points
+    void addBreakpoint(double x, double deltaY) {
+        if (MidInsert && !tree->contains(x)) {
+            tree->insert(DeltaPoint{x, deltaY});
+            return;
+        }
+        Points pts = to_points_delta();
+        auto it = std::lower_bound(pts.begin(), pts.end(), std::make_pair(x, -std::numeric_limits<double>::infinity()));
+        if (it != pts.end() && it->first == x) it->second = deltaY;
+        else pts.insert(it, {x, deltaY});
+        assign(pts);
+    }
+
+    void removeBreakpoint(double x) {
+        Points pts = to_points_delta();
+        auto it = std::lower_bound(pts.begin(), pts.end(), std::make_pair(x, -std::numeric_limits<double>::infinity()));
+        if (it == pts.end() || it->first != x) return;
+        pts.erase(it);
+        assign(pts);
+    }
+
+    // Source de points : la copie des points vit avec le curseur
+    struct Cursor {
+        std::shared_ptr<const Points> pts;
+        size_t i = 0;
+        bool next(double& x, double& d) {
+            if (i >= pts->size()) return false;
+            x = (*pts)[i].first;
+            d = (*pts)[i].second;
+            ++i;
+            return true;
+        }
+    };
+
+    Cursor cursor() const { return Cursor{std::make_shared<const Points>(to_points_delta())}; }
+
+    void sum(const LegacyPiecewise& g) { tree->sum(*g.tree); }
+
+    void minus(const LegacyPiecewise& g) {
+        if constexpr (requires { tree->minus(*g.tree); }) tree->minus(*g.tree);
+        else add_scaled(g, -1.0);
+    }
+
+    void add_scaled(const LegacyPiecewise& g, double a) { zip_inplace(g.cursor(), OpAxpy{a}, NoSwitch()); }
+
+    void negate() {
+        if constexpr (requires { tree->negate(); }) {
+            tree->negate();
+        } else {
+            Points pts = to_points_delta();
+            for (auto& p : pts) p.second = -p.second;
+            assign(pts);
+        }
+    }
+
+    void minfunction(double c) {
+        Points cst{{0.0, c}};
+        zip_inplace(VectorSource{&cst}, OpMin(), SwitchFG());
+    }
+
+    void maxfunction(double c) {
+        Points cst{{0.0, c}};
+        zip_inplace(VectorSource{&cst}, OpMax(), SwitchFG());
+    }
+
+    void minfunction(const LegacyPiecewise& g) { zip_inplace(g.cursor(), OpMin(), SwitchFG()); }
+    void maxfunction(const LegacyPiecewise& g) { zip_inplace(g.cursor(), OpMax(), SwitchFG()); }
+
+    // Les prototypes n'ont pas de normalisation : points à moins de tol de la corde de leurs voisins retirés
+    size_t normalize(double tol = COLLINEAR_TOL) { return simplify(tol); }
+
+    size_t simplify(double max_error) {
+        Points pts = to_points_delta();
+        Points kept = simplify_deltas(pts, -max_error, max_error);
+        size_t removed = pts.size() - kept.size();
+        if (removed) assign(kept);
+        return removed;
+    }
+
+    bool isLessOrEqual(const LegacyPiecewise& g) const {
+        bool result = true;
+        merge_walk(cursor(), g.cursor(), [&](double, double F, double G) {
+            if (F > G + COLLINEAR_TOL * std::max(1.0, std::fabs(G))) result = false; // g(x) < f(x), aux arrondis près
+            return result;
+        });
+        return result;
+    }
+
+    double evaluate_max(double t_inf, double t_sup) const {
+        return extremum_on(t_inf, t_sup, [](double a, double b) { return std::max(a, b); });
+    }
+
+    double evaluate_min(double t_inf, double t_sup) const {
+        return extremum_on(t_inf, t_sup, [](double a, double b) { return std::min(a, b); });
+    }
+
+    static LegacyPiecewise sum_all(std::span<const LegacyPiecewise*> fs, std::span<const double> weights = {}) {
+        return from_points(sum_all_deltas(cursors(fs), std::vector<double>(weights.begin(), weights.end())));
+    }
+
+    static LegacyPiecewise envelope_max(std::span<const LegacyPiecewise*> fs) {
+        return from_points(envelope_deltas(cursors(fs), true));
+    }
+
+    static LegacyPiecewise envelope_min(std::span<const LegacyPiecewise*> fs) {
+        return from_points(envelope_deltas(cursors(fs), false));
+    }
+
+private:
+    std::unique_ptr<Tree> tree = std::make_unique<Tree>();
+
+    // Nouvel arbre, insertions croissantes (toujours en fin d'arbre)
+    void assign(const Points& pts) {
+        tree = std::make_unique<Tree>();
+        for (const auto& [x, d] : pts) tree->insert(DeltaPoint{x, d});
+    }
+
+    template <typename Src, typename Op, typename Switch>
+    void zip_inplace(Src g, Op op, Switch sw) {
+        assign(zip_deltas(cursor(), g, op, sw));
+    }
+
+    static std::vector<Cursor> cursors(std::span<const LegacyPiecewise*> fs) {
+        std::vector<Cursor> srcs;
+        srcs.reserve(fs.size());
+        for (const LegacyPiecewise* f : fs) srcs.push_back(f->cursor());
+        return srcs;
+    }
+
+    // Bornes, puis valeurs aux points de l'intervalle (cumul des deltaY)
+    template <typename Pick>
+    double extremum_on(double t_inf, double t_sup, Pick pick) const {
+        if (t_inf > t_sup) return evaluate(t_inf);
+        double best = pick(evaluate(t_inf), evaluate(t_sup));
+        double y = 0.0;
+        for (const auto& [x, d] : to_points_delta()) {
+            if (x > t_sup) break;
+            y += d;
+            if (x >= t_inf) best = pick(best, y);
+        }
+        return best;
+    }
+};
@@ -1,5 +1,7 @@
+#pragma once
 #include <iostream>
 #include <map>
+#include <memory>
 #include <vector>
 #include <cmath>
 #include <stdexcept>
@@ -7,84 +9,208 @@
 #include <algorithm>
 #include <fstream>
 #include <utility>
+#include <limits>
+#include <span>
+#include <atomic>
+#include <mutex>
+#include "piecewise_core.cpp"
+#include "profile_expr.cpp"
+#include "piecewise_concept.cpp"
+#include "trace.cpp"
+#include "metrics.cpp"
+#include "recorder.cpp"
+#include "profile_stats.cpp"
 
 const double EPSILON = 1e-6; // Utiliser une tolérance plus petite pour les comparaisons de double
 
 class PiecewiseLinearFunction {
 private:
-    // map où la clé est l'abscisse (x) et la valeur est le deltaY
-    std::map<double, double> breakpoints;
-
-    double eval(double x) const {
-        if (breakpoints.empty()) {
-            return 0.0;
+    // Points et cache d'évaluation, partagés entre les copies (copie en O(1))
+    struct Store {
+        std::map<double, double> breakpoints; // clé : abscisse (x), valeur : deltaY
+        // Cache des valeurs cumulées : ys[i] = f(xs[i]). Les entrées d'abscisse < dirtyFrom sont à jour,
+        // le reste est recalculé au prochain eval (dirtyFrom = +inf : cache complet).
+        std::vector<double> xs, ys;
+        double dirtyFrom = -std::numeric_limits<double>::infinity();
+        // eval est const et le Store est partagé entre copies : plusieurs threads peuvent le remplir en même
+        // temps. cacheMutex sérialise le remplissage, fresh (publié en release) évite le verrou une fois à jour.
+        std::atomic<bool> fresh{false};
+        mutable std::mutex cacheMutex;
+
+        Store() = default;
+        // Détachement : la source peut être en train de remplir son cache depuis une autre copie
+        Store(const Store& other) : breakpoints(other.breakpoints) {
+            std::lock_guard<std::mutex> lock(other.cacheMutex);
+            xs = other.xs;
+            ys = other.ys;
+            dirtyFrom = other.dirtyFrom;
+            fresh.store(other.fresh.load(std::memory_order_relaxed), std::memory_order_relaxed);
         }
-    
-        double y = 0.0;
-        auto prev_it = breakpoints.begin();
-        double y_prev = prev_it->second;   // valeur au premier breakpoint
-        double x_prev = prev_it->first;
-    
-        // Cas particulier : si x < premier point
-        if (x < x_prev) {
-            return 0.0; // ou bien la valeur initiale si tu veux f(0) = y0
+        Store& operator=(const Store&) = delete;
+    };
+
+    // breaks() pour lire ; edit(x) pour écrire à partir de l'abscisse x : détache d'abord un Store
+    // encore partagé, puis invalide le cache à partir de x
+    std::shared_ptr<Store> store = std::make_shared<Store>();
+    bool autoNormalize = false; // normalisation après chaque sum/minus/minfunction/maxfunction
+
+    const std::map<double, double>& breaks() const { return store->breakpoints; }
+
+    std::map<double, double>& edit(double from = -std::numeric_limits<double>::infinity()) {
+        if (store.use_count() > 1) store = std::make_shared<Store>(*store);
+        store->dirtyFrom = std::min(store->dirtyFrom, from);
+        store->fresh.store(false, std::memory_order_relaxed); // Store non partagé : aucun lecteur concurrent
+        return store->breakpoints;
+    }
+
+    // Remet le cache à jour : on garde les entrées avant dirtyFrom et on recumule à partir de là
+    void refresh() const {
+        Store& st = *store;
+        if (st.fresh.load(std::memory_order_acquire)) return;
+        std::lock_guard<std::mutex> lock(st.cacheMutex);
+        if (st.fresh.load(std::memory_order_relaxed)) return; // rempli par un autre thread entre-temps
+        size_t keep = std::lower_bound(st.xs.begin(), st.xs.end(), st.dirtyFrom) - st.xs.begin();
+        st.xs.resize(keep);
+        st.ys.resize(keep);
+        double y = keep ? st.ys.back() : 0.0;
+        auto it = keep ? st.breakpoints.upper_bound(st.xs.back()) : st.breakpoints.begin();
+        for (; it != st.breakpoints.end(); ++it) {
+            y += it->second;
+            st.xs.push_back(it->first);
+            st.ys.push_back(y);
         }
+        st.dirtyFrom = std::numeric_limits<double>::infinity();
+        st.fresh.store(true, std::memory_order_release);
+    }
+
+    // O(log n) : recherche dans le cache puis interpolation
+    double eval(double x) const {
+        OpTimer<MetricOp::Eval> timer;
+        metric<MetricCounter::Evals>();
+        refresh();
+        const std::vector<double>& xs = store->xs;
+        const std::vector<double>& ys = store->ys;
+
+        // Cas particulier : fonction vide ou x < premier point
+        if (xs.empty() || x < xs[0]) return 0.0;
+
+        // Premier point x_j (j >= 1) avec x < x_j. Comparaison exacte : la fusion peut placer des croisements
+        // à moins de EPSILON d'un voisin, une tolérance choisirait alors un segment presque vertical.
+        size_t j = std::upper_bound(xs.begin() + 1, xs.end(), x) - xs.begin();
+
+        // Si x est au-delà du dernier breakpoint
+        if (j == xs.size()) return ys.back();
+
+        // interpolation entre (x_{j-1}, y_{j-1}) et (x_j, y_j)
+        double slope = (ys[j] - ys[j - 1]) / (xs[j] - xs[j - 1]);
+        return ys[j - 1] + slope * (x - xs[j - 1]);
+    }
     
-        // Accumuler et trouver l’intervalle où se situe x
-        for (auto it = std::next(breakpoints.begin()); it != breakpoints.end(); ++it) {
-            double x_curr = it->first;
-            double delta = it->second;
-            double y_curr = y_prev + delta;
-    
-            if (x <= x_curr + EPSILON) {
-                // interpolation entre (x_prev, y_prev) et (x_curr, y_curr)
-                double slope = (y_curr - y_prev) / (x_curr - x_prev);
-                return y_prev + slope * (x - x_prev);
-            }
-    
-            // avancer
-            x_prev = x_curr;
-            y_prev = y_curr;
+    size_t simplifyBand(double lo, double hi) {
+        RecordCall<> rec(this, RecordOp::SimplifyBand, {lo, hi});
+        auto pts = to_points_delta();
+        auto kept = simplify_deltas(pts, lo, hi);
+        if (kept.size() == pts.size()) return 0;
+        assignPoints(kept);
+        return pts.size() - kept.size();
+    }
+
+    // Remplace les points par une suite (x, deltaY) triée, en O(n)
+    void assignPoints(const std::vector<std::pair<double, double>>& pts) {
+        metric<MetricCounter::BreakpointsTouched>(pts.size());
+        if (store.use_count() > 1) store = std::make_shared<Store>(); // rien à recopier
+        auto& breakpoints = edit();
+        breakpoints.clear();
+        for (const auto& p : pts) breakpoints.emplace_hint(breakpoints.end(), p.first, p.second);
+    }
+
+    // Garantit un point d'abscisse x sans changer f : le nouveau point prend sa part du deltaY du suivant
+    void splitAt(double x) {
+        auto& breakpoints = edit(x);
+        auto next = breakpoints.lower_bound(x);
+        if (next != breakpoints.end() && next->first == x) return;
+        double share = 0.0; // avant le premier point (f = 0) ou après le dernier (f constante)
+        if (next != breakpoints.end() && next != breakpoints.begin()) {
+            auto prev = std::prev(next);
+            share = split_share(prev->first, x, next->first, next->second);
+            next->second -= share;
         }
-    
-        // Si x est au-delà du dernier breakpoint
-        return y_prev;
+        breakpoints.emplace_hint(next, x, share);
     }
     
 public:
     PiecewiseLinearFunction(double y0 = 0.0) {
-        breakpoints[0.0] = y0;
+        edit()[0.0] = y0;
     }
     
-    // Constructeur de copie
+    // Constructeur de copie : partage les points, O(1)
     PiecewiseLinearFunction(const PiecewiseLinearFunction& other) = default;
     
-    // Opérateur d'affectation
-    PiecewiseLinearFunction& operator=(const PiecewiseLinearFunction& other) = default;
+    // Opérateur d'affectation : partage les points, O(1)
+    PiecewiseLinearFunction& operator=(const PiecewiseLinearFunction& other) {
+        record_forget(this);
+        store = other.store;
+        autoNormalize = other.autoNormalize;
+        return *this;
+    }
+
+    ~PiecewiseLinearFunction() { record_forget(this); }
 
     void addBreakpoint(double x, double deltaY) {
+        RecordCall<> rec(this, RecordOp::AddBreakpoint, {x, deltaY});
+        OpTimer<MetricOp::Insert> timer;
         // Ajouter à la valeur existante si le point de rupture existe
-        breakpoints[x] = deltaY;
+        metric<MetricCounter::BreakpointsTouched>();
+        edit(x)[x] = deltaY;
     }
 
     void removeBreakpoint(double x) {
-        auto it = breakpoints.find(x);
-        if (it != breakpoints.end()) {
-            breakpoints.erase(it);
-        }
+        RecordCall<> rec(this, RecordOp::RemoveBreakpoint, {x});
+        OpTimer<MetricOp::Remove> timer;
+        if (!breaks().count(x)) return;
+        metric<MetricCounter::BreakpointsTouched>();
+        edit(x).erase(x);
     }
 
     // Évalue la fonction en un point x
     double evaluate(double x) const {
         return eval(x);
     }
+
+    size_t size() const { return breaks().size(); }
+
+    // Même rapport que RedBlackTree::stats() ; la forme de l'arbre de std::map n'est pas accessible
+    // (shapeKnown = false). Octets : noeuds de la map, bloc partagé et cache de valeurs cumulées.
+    ProfileStats stats() const {
+        // noeud std::map (libstdc++) : couleur + 3 pointeurs (32 octets) puis la paire (x, deltaY)
+        constexpr size_t MAP_NODE_BYTES = 32 + sizeof(std::pair<const double, double>);
+        ProfileStats s;
+        s.shapeKnown = false;
+        s.nodes = breaks().size();
+        s.payloadBytes = s.nodes * sizeof(std::pair<const double, double>);
+        s.bytes = s.nodes * heap_block_bytes(MAP_NODE_BYTES) + heap_block_bytes(sizeof(Store) + 16); // make_shared
+        {
+            std::lock_guard<std::mutex> lock(store->cacheMutex); // cache éventuellement rempli par un autre thread
+            if (store->xs.capacity()) s.bytes += heap_block_bytes(store->xs.capacity() * sizeof(double));
+            if (store->ys.capacity()) s.bytes += heap_block_bytes(store->ys.capacity() * sizeof(double));
+        }
+        s.sharedWith = store.use_count() - 1;
+        return s;
+    }
+
+    // Fonction construite à partir de points (x, deltaY) triés, en O(n)
+    static PiecewiseLinearFunction from_points(const std::vector<std::pair<double, double>>& pts) {
+        PiecewiseLinearFunction r;
+        r.assignPoints(pts);
+        return r;
+    }
 //======================================================================================================
 //==========================              sum/minus f+g /f-g          ==================================
 //======================================================================================================
 
 // //Addition de deux fonctions
 //     void sum(const PiecewiseLinearFunction& g) {
-//         if (g.breakpoints.empty()) return;
+//         if (g.breaks().empty()) return;
     
 //         double xg_min = g.breakpoints.begin()->first;
 //         double xg_max = g.breakpoints.rbegin()->first;
@@ -172,467 +298,286 @@ public:
 
 
     // Addition de deux fonctions
-void sum(const PiecewiseLinearFunction& g) {
-    if (g.breakpoints.empty()) return;
-
-    double xg_min = g.breakpoints.begin()->first;
-    double xg_max = g.breakpoints.rbegin()->first;
-    double yi_prec = 0.0;
-
-    // it_f commence au premier point de f strictement > xg_min
-    auto it_f = breakpoints.upper_bound(xg_min);
-
-    // ub = premier point de f strictement > xg_max (ou end())
-    auto ub = breakpoints.upper_bound(xg_max);
-
-    // Afficher en toute sécurité le point (s'il existe) qui est > xg_max
-    if (ub != breakpoints.end()) {
-        std::cout << "first f > xg_max: " << ub->first
-                  << "   value = " << ub->second << std::endl;
-    } else {
-        std::cout << "aucun point de f strictement > xg_max (ub == end())\n";
+    void sum(const PiecewiseLinearFunction& g) {
+        RecordCall<> rec(this, RecordOp::Sum, {}, &g);
+        OpTimer<MetricOp::Sum> timer;
+        metric<MetricCounter::Sums>();
+        if (g.breaks().empty()) return;
+        zip_inplace(g, OpPlus(), NoSwitch());
     }
 
-    // end_f doit être one-past-the-element we want to include.
-    // Si ub != end(), on veut INCLURE ub => end_f = next(ub).
-    // Si ub == end(), end_f = end().
-    auto end_f = ub;
-    if (ub != breakpoints.end()) ++end_f;
-
-    auto it_g = g.breakpoints.begin();
-
-    // Vérifier s’il y a un noeud de f juste à gauche de la plage de g
-    if (it_f != breakpoints.begin()) {
-        auto prev = it_f;
-        --prev;
-        yi_prec = this->eval(prev->first);
-        std::cout << "un noeud de f à gauche de g trouvé\n";
-        std::cout << " first yi = " << yi_prec << "\n";
-        std::cout << " first xi = " << prev->first << "\n";
+    // Soustraction de deux fonctions (this - g)
+    void minus(const PiecewiseLinearFunction& g) {
+        RecordCall<> rec(this, RecordOp::Minus, {}, &g);
+        OpTimer<MetricOp::Sum> timer;
+        metric<MetricCounter::Sums>();
+        if (g.breaks().empty()) return;
+        zip_inplace(g, OpMinus(), NoSwitch());
     }
 
-    struct Operation {
-        enum Type { Insert, Update } type;
-        double x;
-        double delta; // on garde ta sémantique d'origine (delta_sum)
-    };
-    std::vector<Operation> ops;
-
-    std::cout << "=== Starting sum ===\n";
-
-    while (it_f != end_f || it_g != g.breakpoints.end()) {
-        double x;
-        bool take_f = false, take_g = false;
-
-        if (it_g != g.breakpoints.end() &&
-            (it_f == end_f || it_g->first < it_f->first)) {
-            x = it_g->first;
-            take_g = true;
-        } else if (it_f != end_f &&
-                   (it_g == g.breakpoints.end() || it_f->first < it_g->first)) {
-            x = it_f->first;
-            take_f = true;
-        } else { // même abscisse
-            // ici it_f != end_f (sinon la boucle ne serait pas exécutée)
-            x = it_f->first;
-            take_f = take_g = true;
-        }
-
-        double F = this->eval(x);
-        double G = g.eval(x);
-        double sum = F + G;
-        double delta_sum = sum - yi_prec;
-        yi_prec = sum;
-
-        std::cout << "x=" << x 
-                  << " | F=" << F << " G=" << G 
-                  << " -> sum=" << sum 
-                  << " delta=" << delta_sum << "\n";
-
-        // déjà un point à x ?
-        auto it_match = breakpoints.find(x);
-        if (it_match != breakpoints.end()) {
-            ops.push_back({Operation::Update, x, delta_sum});
-        } else {
-            ops.push_back({Operation::Insert, x, delta_sum});
-        }
-
-        if (take_f) ++it_f;
-        if (take_g) ++it_g;
+    // f += a * g en une seule fusion, g reste intact (remplace g.negate(); f.sum(g) pour a = -1)
+    void add_scaled(const PiecewiseLinearFunction& g, double a) {
+        RecordCall<> rec(this, RecordOp::AddScaled, {a}, &g);
+        OpTimer<MetricOp::Sum> timer;
+        metric<MetricCounter::Sums>();
+        if (g.breaks().empty()) return;
+        zip_inplace(g, OpAxpy{a}, NoSwitch());
     }
 
-    // Appliquer les opérations (même sémantique qu'avant)
-    for (auto& op : ops) {
-        breakpoints[op.x] = op.delta;
+    // f = clamp(f + g, lo, hi) en une seule fusion, avec les points de coupure sur lo et hi (lo <= 0 <= hi)
+    void add_clamped(const PiecewiseLinearFunction& g, double lo, double hi) {
+        RecordCall<> rec(this, RecordOp::AddClamped, {lo, hi}, &g);
+        OpTimer<MetricOp::Clamp> timer;
+        metric<MetricCounter::Clamps>();
+        zip_inplace(g, OpAddClamp{lo, hi}, SwitchAddClamp{lo, hi});
     }
 
-    std::cout << "=== Sum completed ===\n";
-}
-
-
-    
-    // Soustraction de deux fonctions
-// Soustraction de deux fonctions (this - g)
-void minus(const PiecewiseLinearFunction& g) {
-    if (g.breakpoints.empty()) return;
-
-    double xg_min = g.breakpoints.begin()->first;
-    double xg_max = g.breakpoints.rbegin()->first;
-    double yi_prec = 0.0;
-
-    // bornes utiles de f
-    auto it_f = breakpoints.upper_bound(xg_min);
-    auto end_f = breakpoints.upper_bound(xg_max);
-
-    auto it_g = g.breakpoints.begin();
-
-    // initialiser yi_prec avec le point de f avant xg_min
-    if (it_f != breakpoints.begin()) {
-        auto prev = it_f;
-        --prev;
-        yi_prec = this->eval(prev->first);
-        std::cout << "un noeud de f à gauche de g trouvé\n";
-        std::cout << " first yi = " << yi_prec << "\n";
-        std::cout << " first xi = " << prev->first << "\n";
-    }
-
-    struct Operation {
-        enum Type { Insert, Update } type;
-        double x;
-        double delta;
-    };
-    std::vector<Operation> ops;
-
-    std::cout << "=== Starting minus ===\n";
-
-    while (it_f != end_f || it_g != g.breakpoints.end()) {
-        double x;
-        bool take_f = false, take_g = false;
-
-        if (it_g != g.breakpoints.end() &&
-            (it_f == end_f || it_g->first < it_f->first)) {
-            x = it_g->first;
-            take_g = true;
-        } else if (it_f != end_f &&
-                   (it_g == g.breakpoints.end() || it_f->first < it_g->first)) {
-            x = it_f->first;
-            take_f = true;
-        } else { // même abscisse
-            x = it_f->first;
-            take_f = take_g = true;
-        }
+    // f += w * g sur place, en ne touchant que les points de f dans le support de g : O((m + k) log n)
+    // pour m points dans g et k points de f sur ce support. Même résultat que add_scaled(g, w).
+    void apply_delta(const PiecewiseLinearFunction& g, double w = 1.0) {
+        RecordCall<> rec(this, RecordOp::ApplyDelta, {w}, &g);
+        OpTimer<MetricOp::ApplyDelta> timer;
+        std::vector<std::pair<double, double>> pts = g.to_points_delta();
+        metric<MetricCounter::BreakpointsTouched>(pts.size());
+        auto [lo, hi] = delta_support(pts);
+        if (lo == hi) return;
+        for (size_t i = lo; i < hi; ++i) splitAt(pts[i].first);
+        auto& breakpoints = edit(pts[lo].first);
+        auto it = breakpoints.end();
+        spread_delta(pts, lo, hi, w, [&]() {
+            it = (it == breakpoints.end()) ? breakpoints.find(pts[lo].first) : std::next(it);
+            return std::make_pair(it->first, &it->second);
+        });
+        if (autoNormalize) normalize(pts[lo].first, pts[hi - 1].first);
+    }
 
-        double F = this->eval(x);
-        double G = g.eval(x);
-        double diff = F - G;
-        double delta_diff = diff - yi_prec;
-        yi_prec = diff;
-
-        std::cout << "x=" << x 
-                  << " | F=" << F << " G=" << G 
-                  << " -> diff=" << diff 
-                  << " delta=" << delta_diff << "\n";
-
-        // déjà un point à x ?
-        auto it_match = breakpoints.find(x);
-        if (it_match != breakpoints.end()) {
-            ops.push_back({Operation::Update, x, delta_diff});
-        } else {
-            ops.push_back({Operation::Insert, x, delta_diff});
-        }
+    // Enveloppes supérieure max_k f_k et inférieure min_k f_k de K fonctions (balayage avec croisements)
+    static PiecewiseLinearFunction envelope_max(std::span<const PiecewiseLinearFunction*> fs) {
+        return envelope(fs, true);
+    }
 
-        if (take_f) ++it_f;
-        if (take_g) ++it_g;
+    static PiecewiseLinearFunction envelope_min(std::span<const PiecewiseLinearFunction*> fs) {
+        return envelope(fs, false);
     }
 
-    // Appliquer les opérations
-    for (auto& op : ops) {
-        breakpoints[op.x] = op.delta;
+    static PiecewiseLinearFunction envelope(std::span<const PiecewiseLinearFunction*> fs, bool upper) {
+        std::vector<Cursor> srcs;
+        srcs.reserve(fs.size());
+        for (const PiecewiseLinearFunction* f : fs) srcs.push_back(f->cursor());
+        PiecewiseLinearFunction r;
+        r.assignPoints(envelope_deltas(srcs, upper));
+        return r;
     }
 
-    std::cout << "=== Minus completed ===\n";
-}
+    // Somme pondérée de K fonctions (weights vide = poids 1) en un seul balayage k-way, O(N log K)
+    static PiecewiseLinearFunction sum_all(std::span<const PiecewiseLinearFunction*> fs,
+                                           std::span<const double> weights = {}) {
+        std::vector<Cursor> srcs;
+        srcs.reserve(fs.size());
+        for (const PiecewiseLinearFunction* f : fs) srcs.push_back(f->cursor());
+        PiecewiseLinearFunction r;
+        r.assignPoints(sum_all_deltas(srcs, std::vector<double>(weights.begin(), weights.end())));
+        return r;
+    }
 
     // Négation de la fonction
     void negate() {
-        for (auto& pair : breakpoints) {
+        RecordCall<> rec(this, RecordOp::Negate);
+        for (auto& pair : edit()) {
             pair.second = -pair.second;
         }
     }
 //======================================================================================================
 //====================================== min(f, constante c) and max  ==================================
 //======================================================================================================
+    // min(f, c) : la constante c est définie à partir de x = 0
     void minfunction(double c) {
-        std::cout << "--- minfunction start ---" << std::endl;
-    
-        if (breakpoints.empty()) return;
-
-        //  Premier élément
-        auto it_prev = breakpoints.begin();
-        double x_prev = it_prev->first;
-        double y_prev_old = it_prev->second;
-        double y_prev = std::min(y_prev_old, c); // tronquer au besoin
-        it_prev->second = y_prev;
-        
-        std::cout << "First node: x=" << x_prev << ", y=" << y_prev_old << std::endl;
-        
-        //  Élément suivant
-        auto it_current = std::next(it_prev);
-        if (it_current != breakpoints.end()) {
-            double x_current = it_current->first;
-            double y_current = y_prev_old + it_current->second;
-        
-            bool prevAbove = y_prev_old > c;
-            bool currUnder = y_current < c;
-        
-            std::cout << "Visiting first segment: x_current=" << x_current
-                      << ", y_current=" << y_current << std::endl;
-        
-            // Traversée de c ?
-            if (prevAbove && currUnder) {
-                std::cout << "Crossing found in first segment" << std::endl;
-                // Interpolation pour trouver xi
-                double t = (c - y_prev_old) / (y_current - y_prev_old);
-                double xi = x_prev + t * (x_current - x_prev);
-        
-                // Ajouter breakpoint à xi avec delta 0
-                double deltaAtXi = 0;
-                breakpoints[xi] = deltaAtXi;
-                std::cout << "Insert breakpoint at xi=" << xi << ", delta=" << deltaAtXi << std::endl;
-        
-                // Ajuster delta du point actuel
-                double remainingDelta = y_current - c;
-                it_current->second = remainingDelta;
-                std::cout << "Adjust current delta: x=" << x_current
-                          << ", remainingDelta=" << remainingDelta << std::endl;
-        
-            } else {
-
-                if(c < y_prev_old){
-                                    // Pas de coupure, ajuster delta
-                double newDelta = y_current - y_prev ;
-                it_current->second = newDelta;
-                std::cout << "No crossing zero above c, adjust delta: x=" << x_current
-                          << ", newDelta=" << newDelta << std::endl;
-                    
-                }else{
-                // Pas de coupure, ajuster delta
-                double newDelta = y_current - y_prev_old;
-                it_current->second = newDelta;
-                std::cout << "No crossing, adjust delta: x=" << x_current
-                          << ", newDelta=" << newDelta << std::endl;}
-            }
-        } else {
-            std::cout << "No element after first node" << std::endl;
-        }
-        
+        RecordCall<> rec(this, RecordOp::MinConst, {c});
+        OpTimer<MetricOp::MinMax> timer;
+        std::vector<std::pair<double, double>> cst{{0.0, c}};
+        assignPoints(zip_deltas(cursor(), VectorSource{&cst}, OpMin(), SwitchFG()));
+        if (autoNormalize) normalize();
+    }
 
+    // max(f, c) : la constante c est définie à partir de x = 0
+    void maxfunction(double c) {
+        RecordCall<> rec(this, RecordOp::MaxConst, {c});
+        OpTimer<MetricOp::MinMax> timer;
+        std::vector<std::pair<double, double>> cst{{0.0, c}};
+        assignPoints(zip_deltas(cursor(), VectorSource{&cst}, OpMax(), SwitchFG()));
+        if (autoNormalize) normalize();
+    }
 
+    // min(f, g) / max(f, g) point par point, croisements inclus
+    void minfunction(const PiecewiseLinearFunction& g) {
+        RecordCall<> rec(this, RecordOp::MinFunction, {}, &g);
+        OpTimer<MetricOp::MinMax> timer;
+        zip_inplace(g, OpMin());
+    }
 
-        std::vector<std::pair<double, double>> points;
-        double y = 0.0;
-        for (auto &kv : breakpoints) {
-            y += kv.second;
-            points.push_back({kv.first, y});
-            std::cout << "Accumulated point: x=" << kv.first << ", y=" << y << std::endl;
-        }
-    
-        // Appliquer min avec c
-        for (size_t i = 0; i < points.size() - 1; ++i) {
-            double x = points[i + 1].first;
-            double y_val = points[i + 1].second;
-    
-            double y_prev = points[i].second;
-            double x_prev = points[i].first;
-    
-            bool prevAbove = y_prev > c;
-            bool currAbove = y_val > c ;
-            bool prevUnder = y_prev < c;
-            bool currUnder = y_val < c ;
-    
-            std::cout << "\nVisiting segment: [" << x_prev << ", " << x << "] "
-                      << "y_prev=" << y_prev << ", y_curr=" << y_val << std::endl;
-    
-            // Cas où on traverse la ligne y=c
-            if ((prevAbove && currUnder) || (prevUnder && currAbove)) {
-                double t = (c - y_prev) / (y_val - y_prev);
-                double xi = x_prev + t * (x - x_prev);
-                double deltaAtXi = (y_prev >= c) ? 0 : c - y_prev;
-    
-                std::cout << "Crossing found at x=" << xi << ", deltaAtXi=" << deltaAtXi << std::endl;
-                this->addBreakpoint(xi, deltaAtXi);
-    
-                if (prevAbove && currUnder) {
-                    double remainingDelta = y_val - c;
-                    breakpoints[x] = remainingDelta;
-                    points[i + 1].second = c + remainingDelta;
-                    std::cout << "Adjusting current delta: x=" << x << ", remainingDelta=" << remainingDelta << std::endl;
-                }
-            }
-    
-            // Cas où le point tombe exactement sur c
-            if (prevAbove && y_val == c) {
-                std::cout << "Breakpoint exactly at c at x =" << x << std::endl;
-                breakpoints[x] = 0;
-                points[i + 1].second = c;
-            }
-    
-            // Supprimer les nœuds au-dessus de c
-            if (y_val > c) {
-                std::cout << "Deleting node above c: x=" << x << ", y=" << y_val << std::endl;
-                breakpoints.erase(x);
-            }
-        }
-    
-        std::cout << "--- minfunction end ---" << std::endl;
+    void maxfunction(const PiecewiseLinearFunction& g) {
+        RecordCall<> rec(this, RecordOp::MaxFunction, {}, &g);
+        OpTimer<MetricOp::MinMax> timer;
+        zip_inplace(g, OpMax());
     }
-    
 
-    void maxfunction(double c) {
-        std::cout << "--- maxfunction start ---" << std::endl;
-    
-        if (breakpoints.empty()) return;
-    
-        //  Premier élément
-        auto it_prev = breakpoints.begin();
-        double x_prev = it_prev->first;
-        double y_prev_old = it_prev->second;
-        double y_prev = std::max(y_prev_old, c); // relever au besoin
-        it_prev->second = y_prev;
-    
-        std::cout << "First node: x=" << x_prev << ", y=" << y_prev_old << std::endl;
-    
-        //  Élément suivant
-        auto it_current = std::next(it_prev);
-        if (it_current != breakpoints.end()) {
-            double x_current = it_current->first;
-            double y_current = y_prev_old + it_current->second;
-    
-            bool prevUnder = y_prev_old < c;
-            bool currAbove = y_current > c;
-    
-            std::cout << "Visiting first segment: x_current=" << x_current
-                      << ", y_current=" << y_current << std::endl;
-    
-            // Traversée de c ?
-            if (prevUnder && currAbove) {
-                std::cout << "Crossing found in first segment" << std::endl;
-                double t = (c - y_prev_old) / (y_current - y_prev_old);
-                double xi = x_prev + t * (x_current - x_prev);
-    
-                // Ajouter breakpoint à xi avec delta 0
-                double deltaAtXi = 0;
-                breakpoints[xi] = deltaAtXi;
-                std::cout << "Insert breakpoint at xi=" << xi << ", delta=" << deltaAtXi << std::endl;
-    
-                // Ajuster delta du point actuel
-                double remainingDelta = y_current - c;
-                it_current->second = remainingDelta;
-                std::cout << "Adjust current delta: x=" << x_current
-                          << ", remainingDelta=" << remainingDelta << std::endl;
-    
-            } else {
-                if (c > y_prev_old) {
-                    // Pas de coupure, ajuster delta
-                    double newDelta = y_current - y_prev;
-                    it_current->second = newDelta;
-                    std::cout << "No crossing zero under c, adjust delta: x=" << x_current
-                              << ", newDelta=" << newDelta << std::endl;
-                } else {
-                    double newDelta = y_current - y_prev_old;
-                    it_current->second = newDelta;
-                    std::cout << "No crossing, adjust delta: x=" << x_current
-                              << ", newDelta=" << newDelta << std::endl;
-                }
-            }
-        } else {
-            std::cout << "No element after first node" << std::endl;
-        }
-    
-        // Reconstruire points cumulés
-        std::vector<std::pair<double, double>> points;
-        double y = 0.0;
-        for (auto &kv : breakpoints) {
-            y += kv.second;
-            points.push_back({kv.first, y});
-            std::cout << "Accumulated point: x=" << kv.first << ", y=" << y << std::endl;
+//======================================================================================================
+//====================================== fusion générique f op g (zip) =================================
+//======================================================================================================
+    // Parcours des points (x, deltaY) dans l'ordre croissant, sans copie : source du moteur de fusion
+    struct Cursor {
+        std::map<double, double>::const_iterator it, end;
+        bool next(double& x, double& d) {
+            if (it == end) return false;
+            x = it->first;
+            d = it->second;
+            ++it;
+            return true;
         }
+    };
+
+    Cursor cursor() const {
+        return Cursor{breaks().begin(), breaks().end()};
+    }
+
+    // r = op(f, g) dans une nouvelle fonction, en O(n + m) (voir zip_deltas dans piecewise_core.cpp)
+    template <typename Op, typename Switch = SwitchFG>
+    PiecewiseLinearFunction zip(const PiecewiseLinearFunction& g, Op op, Switch sw = Switch()) const {
+        PiecewiseLinearFunction r;
+        r.assignPoints(zip_deltas(cursor(), g.cursor(), op, sw));
+        return r;
+    }
+
+    // f = op(f, g) en place
+    template <typename Op, typename Switch = SwitchFG>
+    void zip_inplace(const PiecewiseLinearFunction& g, Op op, Switch sw = Switch()) {
+        assignPoints(zip_deltas(cursor(), g.cursor(), op, sw));
+        if (autoNormalize) normalize();
+    }
     
-        // Appliquer max avec c
-        for (size_t i = 0; i < points.size() - 1; ++i) {
-            double x = points[i + 1].first;
-            double y_val = points[i + 1].second;
-    
-            double y_prev = points[i].second;
-            double x_prev = points[i].first;
-    
-            bool prevUnder = y_prev < c;
-            bool currUnder = y_val < c;
-    
-            std::cout << "\nVisiting segment: [" << x_prev << ", " << x << "] "
-                      << "y_prev=" << y_prev << ", y_curr=" << y_val << std::endl;
-    
-            // Cas où on traverse la ligne y=c
-            if ((prevUnder && y_val > c) || (y_prev > c && currUnder)) {
-                double t = (c - y_prev) / (y_val - y_prev);
-                double xi = x_prev + t * (x - x_prev);
-                double deltaAtXi = (y_prev <= c) ? 0 : c - y_prev;
-    
-                std::cout << "Crossing found at x=" << xi << ", deltaAtXi=" << deltaAtXi << std::endl;
-                this->addBreakpoint(xi, deltaAtXi);
-    
-                if (prevUnder && y_val > c) {
-                    double remainingDelta = y_val - c;
-                    breakpoints[x] = remainingDelta;
-                    points[i + 1].second = c + remainingDelta;
-                    std::cout << "Adjusting current delta: x=" << x << ", remainingDelta=" << remainingDelta << std::endl;
-                }
+//======================================================================================================
+//====================================== normalisation : points redondants =============================
+//======================================================================================================
+    // Active la normalisation automatique après chaque sum/minus/minfunction/maxfunction
+    void setAutoNormalize(bool on) {
+        RecordCall<> rec(this, RecordOp::AutoNormalize, {on ? 1.0 : 0.0});
+        autoNormalize = on;
+    }
+
+    // Supprime les points qui ne changent pas la fonction :
+    //  - points à moins de EPSILON l'un de l'autre, fusionnés dans le premier si f bouge de moins de tol,
+    //  - points intérieurs alignés avec leurs deux voisins,
+    //  - premier point sans saut suivi d'un segment plat, dernier point au bout d'un segment plat.
+    // Le deltaY d'un point retiré est reporté sur son successeur. Retourne le nombre de points supprimés.
+    size_t normalize(double tol = COLLINEAR_TOL) {
+        return normalize(-std::numeric_limits<double>::infinity(),
+                         std::numeric_limits<double>::infinity(), tol);
+    }
+
+    // Version locale : on n'examine que les points de [xmin, xmax] et leurs deux voisins
+    size_t normalize(double xmin, double xmax, double tol = COLLINEAR_TOL) {
+        RecordCall<> rec(this, RecordOp::Normalize, {xmin, xmax, tol});
+        OpTimer<MetricOp::Normalize> timer;
+        size_t removed = 0;
+        if (breaks().empty()) return 0;
+        auto start = breaks().lower_bound(xmin);
+        if (start != breaks().begin()) --start;
+        double from = start != breaks().end() ? start->first : xmin;
+        auto& breakpoints = edit(from); // rien ne change avant le point de départ
+
+        auto it = breakpoints.lower_bound(from);
+
+        while (it != breakpoints.end()) {
+            auto next = std::next(it);
+
+            auto after = next != breakpoints.end() ? std::next(next) : breakpoints.end();
+            bool hasAfter = after != breakpoints.end();
+            if (next != breakpoints.end() &&
+                is_fusable(it->first, next->first, next->second,
+                           hasAfter ? after->first : std::numeric_limits<double>::infinity(),
+                           hasAfter ? after->second : 0.0, EPSILON, tol)) {
+                it->second += next->second;
+                breakpoints.erase(next);
+                ++removed;
+                continue; // it a un nouveau voisin, on le réexamine
             }
-    
-            // Cas où le point tombe exactement sur c
-            if (prevUnder && y_val == c) {
-                std::cout << "Breakpoint exactly at c at x =" << x << std::endl;
-                breakpoints[x] = 0;
-                points[i + 1].second = c;
+
+            bool hasPrev = it != breakpoints.begin();
+            bool hasNext = next != breakpoints.end();
+            bool redundant = false;
+            if (hasPrev && hasNext) {
+                auto prev = std::prev(it);
+                redundant = is_collinear(prev->first, it->first, it->second,
+                                         next->first, next->second, tol);
+            } else if (hasNext) {
+                redundant = is_redundant_first(it->second, next->second, tol);
+            } else if (hasPrev) {
+                redundant = is_redundant_last(it->second, tol);
             }
-    
-            // Supprimer les nœuds en dessous de c
-            if (y_val < c) {
-                std::cout << "Deleting node under c: x=" << x << ", y=" << y_val << std::endl;
-                breakpoints.erase(x);
+
+            bool pastRange = it->first > xmax;
+            if (redundant) {
+                if (hasNext) next->second += it->second;
+                breakpoints.erase(it);
+                ++removed;
             }
+            if (pastRange) break;
+            it = next;
         }
-    
-        std::cout << "--- maxfunction end ---" << std::endl;
+        return removed;
     }
-    
-    
+
+//======================================================================================================
+//====================================== simplification à erreur bornée ================================
+//======================================================================================================
+    // Approximation linéaire par morceaux avec |g - f| <= max_error partout (sous-ensemble des points de f).
+    // Retourne le nombre de points supprimés.
+    size_t simplify(double max_error) {
+        return simplifyBand(-max_error, max_error);
+    }
+
+    // Variante conservative : f <= g <= f + max_error (majorant, pour les tests de capacité)
+    size_t simplify_upper(double max_error) {
+        return simplifyBand(0.0, max_error);
+    }
+
+    // Variante conservative : f - max_error <= g <= f (minorant)
+    size_t simplify_lower(double max_error) {
+        return simplifyBand(-max_error, 0.0);
+    }
+
+    // Garde au plus max_points points (au moins 2) ; retourne l'erreur L-infini garantie
+    double simplify_to(size_t max_points) {
+        double err = simplify_error_for(to_points_delta(), max_points);
+        simplify(err); // err = 0 (f constante par exemple) : seuls les points exactement alignés partent
+        return err;
+    }
+
 //======================================================================================================
 //====================================== verify if f<= g  ==============================================
 //=======================================================================================================
     // Vérifie si la fonction est toujours inférieure ou égale à une autre
     bool isLessOrEqual(const PiecewiseLinearFunction& g) const {
-        PiecewiseLinearFunction diff = g;
-        diff.minus(*this);
-        for (const auto& pair : diff.breakpoints) {
-            if (diff.evaluate(pair.first) < 0) {
-                return false;
-            }
-        }
-        return true;
+        // f et g sont linéaires entre deux abscisses consécutives de l'union : il suffit de comparer en ces points
+        bool result = true;
+        merge_walk(cursor(), g.cursor(), [&](double, double F, double G) {
+            if (F > G + COLLINEAR_TOL * std::max(1.0, std::fabs(G))) result = false; // g(x) < f(x), aux arrondis près
+            return result;
+        });
+        return result;
     }
 //======================================================================================================
 //======================================  find min/max f in [tinf, tsup]   ==============================
 //=======================================================================================================
-    // Évaluation du maximum sur un intervalle
+    // Évaluation du maximum sur un intervalle : O(k log n) pour k points dans [t_inf, t_sup] (eval sur le cache)
     double evaluate_max(double t_inf, double t_sup) const {
         if (t_inf > t_sup) return evaluate(t_inf);
         
         double maxVal = evaluate(t_inf);
         maxVal = std::max(maxVal, evaluate(t_sup));
 
-        auto it_begin = breakpoints.lower_bound(t_inf);
-        auto it_end = breakpoints.upper_bound(t_sup);
+        auto it_begin = breaks().lower_bound(t_inf);
+        auto it_end = breaks().upper_bound(t_sup);
         
         for (auto it = it_begin; it != it_end; ++it) {
             maxVal = std::max(maxVal, evaluate(it->first));
@@ -640,15 +585,15 @@ void minus(const PiecewiseLinearFunction& g) {
         return maxVal;
     }
     
-    // Évaluation du minimum sur un intervalle
+    // Évaluation du minimum sur un intervalle : O(k log n), idem
     double evaluate_min(double t_inf, double t_sup) const {
         if (t_inf > t_sup) return evaluate(t_inf);
         
         double minVal = evaluate(t_inf);
         minVal = std::min(minVal, evaluate(t_sup));
 
-        auto it_begin = breakpoints.lower_bound(t_inf);
-        auto it_end = breakpoints.upper_bound(t_sup);
+        auto it_begin = breaks().lower_bound(t_inf);
+        auto it_end = breaks().upper_bound(t_sup);
         
         for (auto it = it_begin; it != it_end; ++it) {
             minVal = std::min(minVal, evaluate(it->first));
@@ -690,7 +635,7 @@ void minus(const PiecewiseLinearFunction& g) {
 
         std::vector<std::pair<double, double>> points;
         double currentY = 0.0;
-        for (const auto& pair : breakpoints) {
+        for (const auto& pair : breaks()) {
             currentY += pair.second;
             points.push_back({pair.first, currentY});
         }
@@ -700,102 +645,77 @@ void minus(const PiecewiseLinearFunction& g) {
         }
 
         out.close();
-        std::cout << "Fonction exportee vers " << filename << std::endl;
+        trace<TraceLevel::Info>("map.export", (double)points.size());
     }
 //======================================================================================================
 //======================================  update global profile    =====================================
 //=======================================================================================================
-    // Mise à jour de la fonction selon la méthode CBR
+    // Delta (petit profil en chapeau ou en marche) d'une mise à jour CBR, nul si rien ne change
+    static PiecewiseLinearFunction cbr_stmin_delta(double stmin_old, double stmin, double ctmin, double cap_min, double cap_max) {
+        return hat_delta(cbr_stmin_hat(stmin_old, stmin, ctmin, cap_min, cap_max, CBR_TOL));
+    }
+
+    static PiecewiseLinearFunction cbr_ctmin_delta(double ctmin_old, double ctmin, double stmin, double cap_min, double cap_max) {
+        return hat_delta(cbr_ctmin_hat(ctmin_old, ctmin, stmin, cap_min, cap_max, CBR_TOL));
+    }
+
+    static PiecewiseLinearFunction cbr_stmax_delta(double stmax_old, double stmax, double ctmax, double cap_min, double cap_max) {
+        return hat_delta(cbr_stmax_hat(stmax_old, stmax, ctmax, cap_min, cap_max, CBR_TOL));
+    }
+
+    static PiecewiseLinearFunction cbr_ctmax_delta(double ctmax_old, double ctmax, double stmax, double cap_min, double cap_max) {
+        return hat_delta(cbr_ctmax_hat(ctmax_old, ctmax, stmax, cap_min, cap_max, CBR_TOL));
+    }
+
+    static PiecewiseLinearFunction hat_delta(const CbrHat& h) {
+        return h.active ? delta_profile(h.gap, h.a, h.b, h.c) : PiecewiseLinearFunction();
+    }
+
+    static PiecewiseLinearFunction cbr_cap_delta(double cap_old, double cap, double start, double end) {
+        if (std::abs(cap - cap_old) < CBR_TOL) return PiecewiseLinearFunction();
+        double gap = cap - cap_old;
+        PiecewiseLinearFunction delta = cba_profile(gap, start, end);
+        return delta;
+    }
+
+    // Mise à jour de la fonction selon la méthode CBR : le delta est ajouté sur place, en ne touchant que
+    // les points dans son support. Les cbr_*_delta servent aussi à le propager (voir ProfileNetwork).
     void update_cbr_stmin(double stmin_old, double stmin, double ctmin, double cap_min, double cap_max) {
-        double cap = (cap_min > 0) ? cap_max : cap_min;
-        if (std::abs(stmin - stmin_old) < EPSILON) return;
-        PiecewiseLinearFunction delta;
-        if (stmin_old < stmin && stmin < ctmin) {
-            double slope = -cap / (ctmin - stmin_old);
-            double gap = slope * (stmin - stmin_old);
-            delta = delta_profile(gap, stmin_old, stmin, ctmin);
-        } else if (stmin_old <= ctmin && ctmin < stmin) {
-            double gap = -cap;
-            delta = delta_profile(gap, stmin_old, ctmin, stmin);
-        } else if (ctmin < stmin_old && stmin_old < stmin) {
-            double slope = -cap / (ctmin - stmin);
-            double gap = slope * (stmin_old - stmin);
-            delta = delta_profile(gap, ctmin, stmin_old, stmin);
-        }
-        this->sum(delta);
+        RecordCall<> rec(this, RecordOp::CbrStMin, {stmin_old, stmin, ctmin, cap_min, cap_max});
+        apply_delta(cbr_stmin_delta(stmin_old, stmin, ctmin, cap_min, cap_max));
     }
 
     void update_cbr_ctmin(double ctmin_old, double ctmin, double stmin, double cap_min, double cap_max) {
-        double cap = (cap_min > 0) ? cap_max : cap_min;
-        if (std::abs(ctmin - ctmin_old) < EPSILON) return;
-        PiecewiseLinearFunction delta;
-        if (stmin < ctmin_old && ctmin_old < ctmin) {
-            double slope = -cap / (ctmin - stmin);
-            double gap = slope * (ctmin - ctmin_old);
-            delta = delta_profile(gap, stmin, ctmin_old, ctmin);
-        } else if (ctmin_old <= stmin && stmin < ctmin) {
-            double gap = -cap;
-            delta = delta_profile(gap, ctmin_old, stmin, ctmin);
-        } else if (ctmin_old < ctmin && ctmin < stmin) {
-            double slope = -cap / (ctmin_old - stmin);
-            double gap = slope * (ctmin_old - ctmin);
-            delta = delta_profile(gap, ctmin_old, ctmin, stmin);
-        }
-        this->sum(delta);
+        RecordCall<> rec(this, RecordOp::CbrCtMin, {ctmin_old, ctmin, stmin, cap_min, cap_max});
+        apply_delta(cbr_ctmin_delta(ctmin_old, ctmin, stmin, cap_min, cap_max));
     }
 
     void update_cbr_stmax(double stmax_old, double stmax, double ctmax, double cap_min, double cap_max) {
-        double cap = (cap_min > 0) ? cap_min : cap_max;
-        if (std::abs(stmax - stmax_old) < EPSILON) return;
-        PiecewiseLinearFunction delta;
-        if (stmax < stmax_old && stmax_old < ctmax) {
-            double slope = cap / (ctmax - stmax);
-            double gap = slope * (stmax_old - stmax);
-            delta = delta_profile(gap, stmax, stmax_old, ctmax);
-        } else if (stmax <= ctmax && ctmax < stmax_old) {
-            double gap = cap;
-            delta = delta_profile(gap, stmax, ctmax, stmax_old);
-        } else if (ctmax < stmax && stmax < stmax_old) {
-            double slope = cap / (ctmax - stmax_old);
-            double gap = slope * (stmax - stmax_old);
-            delta = delta_profile(gap, ctmax, stmax, stmax_old);
-        }
-        this->sum(delta);
+        RecordCall<> rec(this, RecordOp::CbrStMax, {stmax_old, stmax, ctmax, cap_min, cap_max});
+        apply_delta(cbr_stmax_delta(stmax_old, stmax, ctmax, cap_min, cap_max));
     }
 
     void update_cbr_ctmax(double ctmax_old, double ctmax, double stmax, double cap_min, double cap_max) {
-        double cap = (cap_min > 0) ? cap_min : cap_max;
-        if (std::abs(ctmax - ctmax_old) < EPSILON) return;
-        PiecewiseLinearFunction delta;
-        if (stmax < ctmax && ctmax < ctmax_old) {
-            double slope = cap / (ctmax_old - stmax);
-            double gap = slope * (ctmax_old - ctmax);
-            delta = delta_profile(gap, stmax, ctmax, ctmax_old);
-        } else if (ctmax <= stmax && stmax < ctmax_old) {
-            double gap = cap;
-            delta = delta_profile(gap, ctmax, stmax, ctmax_old);
-        } else if (ctmax < ctmax_old && ctmax_old < stmax) {
-            double slope = cap / (ctmax - stmax);
-            double gap = slope * (ctmax - ctmax_old);
-            delta = delta_profile(gap, ctmax, ctmax_old, stmax);
-        }
-        this->sum(delta);
+        RecordCall<> rec(this, RecordOp::CbrCtMax, {ctmax_old, ctmax, stmax, cap_min, cap_max});
+        apply_delta(cbr_ctmax_delta(ctmax_old, ctmax, stmax, cap_min, cap_max));
     }
 
     void update_cbr_cap(double cap_old, double cap, double start, double end) {
-        if (std::abs(cap - cap_old) < EPSILON) return;
-        double gap = cap - cap_old;
-        PiecewiseLinearFunction delta = cba_profile(gap, start, end);
-        this->sum(delta);
+        RecordCall<> rec(this, RecordOp::CbrCap, {cap_old, cap, start, end});
+        apply_delta(cbr_cap_delta(cap_old, cap, start, end));
     }
 //======================================================================================================
 //======================================  Extract points (x,f(x))   =====================================
 //=======================================================================================================
+    std::vector<std::pair<double, double>> to_points_delta() const {
+        return std::vector<std::pair<double, double>>(breaks().begin(), breaks().end());
+    }
+
     std::vector<std::pair<double, double>> to_points_cumulative() const {
         std::vector<std::pair<double, double>> points;
         double y = 0.0;
     
-        for (const auto& kv : breakpoints) {
+        for (const auto& kv : breaks()) {
             y += kv.second;                // cumul des deltas
             points.emplace_back(kv.first, y); // (x, valeur réelle de f(x))
         }
@@ -803,4 +723,26 @@ void minus(const PiecewiseLinearFunction& g) {
         return points;
     }
     
-};
\ No newline at end of file
+};
+
+//===================== Expressions paresseuses =====================
+
+// a - b + c construit un ProfileExpr ; le calcul n'a lieu qu'à la conversion en PiecewiseLinearFunction
+// (une seule somme k-way) ou point par point via eval(x).
+inline ProfileExpr<PiecewiseLinearFunction> operator+(const PiecewiseLinearFunction& a, const PiecewiseLinearFunction& b) {
+    return lazy(a) + b;
+}
+
+inline ProfileExpr<PiecewiseLinearFunction> operator-(const PiecewiseLinearFunction& a, const PiecewiseLinearFunction& b) {
+    return lazy(a) - b;
+}
+
+inline ProfileExpr<PiecewiseLinearFunction> operator-(const PiecewiseLinearFunction& a) {
+    return -lazy(a);
+}
+
+inline ProfileExpr<PiecewiseLinearFunction> operator*(double w, const PiecewiseLinearFunction& a) {
+    return w * lazy(a);
+}
+
+static_assert(PiecewiseBackend<PiecewiseLinearFunction>);
@@ -0,0 +1,213 @@
+#pragma once
+// Expressions paresseuses sur les profils : auto kmin = levelmin - totalmax + f1;
+// construit un DAG sans rien calculer. materialize() aplatit les parties linéaires en une seule somme
+// pondérée k-way (F::sum_all) ; min/max sont calculés une fois par noeud partagé. eval(x) parcourt le DAG
+// directement, sans construire de fonction.
+//
+// F est RedBlackTree<DeltaPoint> ou PiecewiseLinearFunction. Les feuilles gardent un pointeur vers les
+// fonctions de base : elles doivent vivre au moins aussi longtemps que l'expression.
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+
+template <typename F>
+struct ExprNode {
+    enum Kind { Leaf, Linear, Min, Max } kind;
+    const F* leaf = nullptr;
+    std::vector<std::pair<std::shared_ptr<const ExprNode>, double>> terms; // Linear : somme des w * terme
+    std::shared_ptr<const ExprNode> a, b;                                  // Min / Max
+};
+
+// eval (RedBlackTree) ou evaluate (PiecewiseLinearFunction)
+template <typename F>
+double eval_profile(const F& f, double x) {
+    if constexpr (requires { f.evaluate(x); }) return f.evaluate(x);
+    else return f.eval(x);
+}
+
+template <typename F>
+class ProfileExpr {
+public:
+    using Node = ExprNode<F>;
+    using NodePtr = std::shared_ptr<const Node>;
+
+    ProfileExpr(const F& f) {
+        auto n = std::make_shared<Node>();
+        n->kind = Node::Leaf;
+        n->leaf = &f;
+        node = n;
+    }
+
+    explicit ProfileExpr(NodePtr n) : node(std::move(n)) {}
+
+    const NodePtr& root() const { return node; }
+
+    // Combinaison linéaire de sous-expressions (partagées, pas copiées)
+    static ProfileExpr linear(std::vector<std::pair<NodePtr, double>> terms) {
+        auto n = std::make_shared<Node>();
+        n->kind = Node::Linear;
+        n->terms = std::move(terms);
+        return ProfileExpr(n);
+    }
+
+    static ProfileExpr binary(typename Node::Kind kind, const ProfileExpr& a, const ProfileExpr& b) {
+        auto n = std::make_shared<Node>();
+        n->kind = kind;
+        n->a = a.node;
+        n->b = b.node;
+        return ProfileExpr(n);
+    }
+
+    // Valeur en x sans construire le résultat ; chaque noeud partagé n'est évalué qu'une fois
+    double eval(double x) const {
+        std::unordered_map<const Node*, double> memo;
+        return evalNode(node.get(), x, memo);
+    }
+
+    // Construit le résultat : une seule somme k-way par partie linéaire
+    F materialize() const {
+        Context ctx;
+        return ctx.build(node.get());
+    }
+
+    operator F() const { return materialize(); }
+
+    // Forme aplatie (f_i, w_i) : une entrée par fonction ; std::invalid_argument si l'expression a un min/max
+    std::vector<std::pair<const F*, double>> linear_form() const {
+        Context ctx;
+        ctx.linearOnly = true;
+        return ctx.form(node.get());
+    }
+
+private:
+    NodePtr node;
+
+    static double evalNode(const Node* n, double x, std::unordered_map<const Node*, double>& memo) {
+        auto it = memo.find(n);
+        if (it != memo.end()) return it->second;
+        double v = 0.0;
+        switch (n->kind) {
+        case Node::Leaf:
+            v = eval_profile(*n->leaf, x);
+            break;
+        case Node::Linear:
+            for (const auto& [t, w] : n->terms) v += w * evalNode(t.get(), x, memo);
+            break;
+        case Node::Min:
+            v = std::min(evalNode(n->a.get(), x, memo), evalNode(n->b.get(), x, memo));
+            break;
+        case Node::Max:
+            v = std::max(evalNode(n->a.get(), x, memo), evalNode(n->b.get(), x, memo));
+            break;
+        }
+        memo[n] = v;
+        return v;
+    }
+
+    // État d'une matérialisation : formes linéaires et min/max déjà calculés, par noeud
+    struct Context {
+        using Form = std::vector<std::pair<const F*, double>>;
+        std::unordered_map<const Node*, Form> forms;
+        std::unordered_map<const Node*, std::unique_ptr<F>> built;
+        bool linearOnly = false;
+
+        // Forme aplatie : somme des w_i * f_i, une seule entrée par fonction
+        const Form& form(const Node* n) {
+            auto it = forms.find(n);
+            if (it != forms.end()) return it->second;
+
+            Form f;
+            if (n->kind == Node::Leaf) {
+                f.push_back({n->leaf, 1.0});
+            } else if (n->kind == Node::Linear) {
+                std::unordered_map<const F*, size_t> index;
+                for (const auto& [t, w] : n->terms) {
+                    for (const auto& [leaf, c] : form(t.get())) {
+                        auto [pos, fresh] = index.try_emplace(leaf, f.size());
+                        if (fresh) f.push_back({leaf, w * c});
+                        else f[pos->second].second += w * c;
+                    }
+                }
+            } else if (linearOnly) {
+                throw std::invalid_argument("ProfileExpr : min/max dans une expression linéaire");
+            } else {
+                f.push_back({nonlinear(n), 1.0});
+            }
+            return forms[n] = std::move(f);
+        }
+
+        const F* nonlinear(const Node* n) {
+            auto it = built.find(n);
+            if (it != built.end()) return it->second.get();
+            auto r = std::make_unique<F>(build(n->a.get()));
+            F other = build(n->b.get());
+            if (n->kind == Node::Min) r->minfunction(other);
+            else r->maxfunction(other);
+            return (built[n] = std::move(r)).get();
+        }
+
+        F build(const Node* n) {
+            const Form& f = form(n);
+            std::vector<const F*> fs;
+            std::vector<double> ws;
+            for (const auto& [leaf, w] : f) {
+                if (w == 0.0) continue;
+                fs.push_back(leaf);
+                ws.push_back(w);
+            }
+            return F::sum_all(fs, ws);
+        }
+    };
+};
+
+// Point d'entrée pour n'importe quel type de profil : lazy(a) - b + c
+template <typename F>
+ProfileExpr<F> lazy(const F& f) { return ProfileExpr<F>(f); }
+
+template <typename F>
+ProfileExpr<F> operator+(const ProfileExpr<F>& a, const ProfileExpr<F>& b) {
+    return ProfileExpr<F>::linear({{a.root(), 1.0}, {b.root(), 1.0}});
+}
+
+template <typename F>
+ProfileExpr<F> operator-(const ProfileExpr<F>& a, const ProfileExpr<F>& b) {
+    return ProfileExpr<F>::linear({{a.root(), 1.0}, {b.root(), -1.0}});
+}
+
+template <typename F>
+ProfileExpr<F> operator-(const ProfileExpr<F>& a) {
+    return ProfileExpr<F>::linear({{a.root(), -1.0}});
+}
+
+template <typename F>
+ProfileExpr<F> operator*(double w, const ProfileExpr<F>& a) {
+    return ProfileExpr<F>::linear({{a.root(), w}});
+}
+
+template <typename F>
+ProfileExpr<F> operator*(const ProfileExpr<F>& a, double w) { return w * a; }
+
+template <typename F>
+ProfileExpr<F> operator+(const ProfileExpr<F>& a, const F& b) { return a + ProfileExpr<F>(b); }
+
+template <typename F>
+ProfileExpr<F> operator+(const F& a, const ProfileExpr<F>& b) { return ProfileExpr<F>(a) + b; }
+
+template <typename F>
+ProfileExpr<F> operator-(const ProfileExpr<F>& a, const F& b) { return a - ProfileExpr<F>(b); }
+
+template <typename F>
+ProfileExpr<F> operator-(const F& a, const ProfileExpr<F>& b) { return ProfileExpr<F>(a) - b; }
+
+template <typename F>
+ProfileExpr<F> min(const ProfileExpr<F>& a, const ProfileExpr<F>& b) {
+    return ProfileExpr<F>::binary(ExprNode<F>::Min, a, b);
+}
+
+template <typename F>
+ProfileExpr<F> max(const ProfileExpr<F>& a, const ProfileExpr<F>& b) {
+    return ProfileExpr<F>::binary(ExprNode<F>::Max, a, b);
+}
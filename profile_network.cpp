@@ -0,0 +1,132 @@
+#pragma once
+// Réseau de profils : des fonctions de base, modifiées par deltas, et des fonctions dérivées qui sont des
+// combinaisons linéaires des bases (kmin = levelmin - totalmax + f1). Un delta appliqué à une base est
+// propagé tel quel à chacune de ses dérivées par apply_delta, qui ne touche que les points dans le support
+// du delta : O((m + k) log n) par fonction touchée au lieu d'une reconstruction complète.
+//
+// F est RedBlackTree<DeltaPoint> ou PiecewiseLinearFunction (apply_delta, sum_all, cbr_*_delta).
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <stdexcept>
+#include "profile_expr.cpp"
+
+template <typename F>
+class ProfileNetwork {
+public:
+    using Id = size_t;
+
+    // Nouvelle fonction de base, modifiable par apply_delta
+    Id add_base(F f = F()) {
+        Entry e;
+        e.f = std::make_unique<F>(std::move(f));
+        e.base = true;
+        return push(std::move(e));
+    }
+
+    // Nouvelle fonction dérivée : somme des w * fonction(id). Une dérivée utilisée comme terme est
+    // remplacée par sa propre combinaison des bases. Calculée une fois par une somme k-way.
+    Id add_derived(const std::vector<std::pair<Id, double>>& terms) {
+        std::vector<std::pair<Id, double>> combo;
+        std::unordered_map<Id, size_t> index;
+        auto add = [&](Id b, double w) {
+            auto [pos, fresh] = index.try_emplace(b, combo.size());
+            if (fresh) combo.push_back({b, w});
+            else combo[pos->second].second += w;
+        };
+        for (const auto& [id, w] : terms) {
+            const Entry& t = entry(id);
+            if (t.base) add(id, w);
+            else for (const auto& [b, wb] : t.terms) add(b, w * wb);
+        }
+
+        std::vector<const F*> fs;
+        std::vector<double> ws;
+        Entry e;
+        for (const auto& [b, w] : combo) {
+            if (w == 0.0) continue;
+            fs.push_back(entries[b].f.get());
+            ws.push_back(w);
+            e.terms.push_back({b, w});
+        }
+        e.f = std::make_unique<F>(F::sum_all(fs, ws));
+        e.base = false;
+        Id id = push(std::move(e));
+        for (const auto& [b, w] : entries[id].terms) entries[b].dependents.push_back({id, w});
+        return id;
+    }
+
+    // Même chose à partir d'une expression linéaire dont les feuilles sont des fonctions du réseau :
+    // net.add_derived(lazy(net.get(levelmin)) - net.get(totalmax) + net.get(f1))
+    Id add_derived(const ProfileExpr<F>& e) {
+        std::vector<std::pair<Id, double>> terms;
+        for (const auto& [f, w] : e.linear_form()) {
+            auto it = ids.find(f);
+            if (it == ids.end()) throw std::invalid_argument("ProfileNetwork : fonction hors du réseau");
+            terms.push_back({it->second, w});
+        }
+        return add_derived(terms);
+    }
+
+    // base += w * delta, propagé à toutes les dérivées de la base
+    void apply_delta(Id base, const F& delta, double w = 1.0) {
+        Entry& e = entry(base);
+        if (!e.base) throw std::logic_error("ProfileNetwork : une fonction dérivée ne se modifie pas directement");
+        e.f->apply_delta(delta, w);
+        for (const auto& [d, wd] : e.dependents) entries[d].f->apply_delta(delta, w * wd);
+    }
+
+    // Mises à jour CBR d'une base : seul le petit delta circule
+    void update_cbr_stmin(Id base, double stmin_old, double stmin, double ctmin, double cap_min, double cap_max) {
+        apply_delta(base, F::cbr_stmin_delta(stmin_old, stmin, ctmin, cap_min, cap_max));
+    }
+
+    void update_cbr_ctmin(Id base, double ctmin_old, double ctmin, double stmin, double cap_min, double cap_max) {
+        apply_delta(base, F::cbr_ctmin_delta(ctmin_old, ctmin, stmin, cap_min, cap_max));
+    }
+
+    void update_cbr_stmax(Id base, double stmax_old, double stmax, double ctmax, double cap_min, double cap_max) {
+        apply_delta(base, F::cbr_stmax_delta(stmax_old, stmax, ctmax, cap_min, cap_max));
+    }
+
+    void update_cbr_ctmax(Id base, double ctmax_old, double ctmax, double stmax, double cap_min, double cap_max) {
+        apply_delta(base, F::cbr_ctmax_delta(ctmax_old, ctmax, stmax, cap_min, cap_max));
+    }
+
+    void update_cbr_cap(Id base, double cap_old, double cap, double start, double end) {
+        apply_delta(base, F::cbr_cap_delta(cap_old, cap, start, end));
+    }
+
+    const F& get(Id id) const { return *entry(id).f; }
+    bool is_base(Id id) const { return entry(id).base; }
+    size_t size() const { return entries.size(); }
+
+private:
+    struct Entry {
+        std::unique_ptr<F> f;                          // adresse stable : feuilles des ProfileExpr
+        bool base = true;
+        std::vector<std::pair<Id, double>> terms;      // dérivée : combinaison des bases
+        std::vector<std::pair<Id, double>> dependents; // base : dérivées qui l'utilisent, avec leur poids
+    };
+
+    std::vector<Entry> entries;
+    std::unordered_map<const F*, Id> ids;
+
+    Id push(Entry e) {
+        Id id = entries.size();
+        ids[e.f.get()] = id;
+        entries.push_back(std::move(e));
+        return id;
+    }
+
+    Entry& entry(Id id) {
+        if (id >= entries.size()) throw std::out_of_range("ProfileNetwork : identifiant inconnu");
+        return entries[id];
+    }
+
+    const Entry& entry(Id id) const {
+        if (id >= entries.size()) throw std::out_of_range("ProfileNetwork : identifiant inconnu");
+        return entries[id];
+    }
+};
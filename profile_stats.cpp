@@ -0,0 +1,50 @@
+#pragma once
+// Forme et mémoire d'un profil : RedBlackTree::stats() et PiecewiseLinearFunction::stats().
+// Calcul en O(n), itératif (pas de récursion ni de std::function), pour pouvoir l'échantillonner en production.
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+// Taille réellement prise sur le tas par une allocation de request octets, en-tête et arrondi compris
+// (modèle de ptmalloc / glibc sur 64 bits : en-tête de 8 octets, blocs multiples de 16, au moins 32).
+inline size_t heap_block_bytes(size_t request) {
+    return std::max<size_t>(32, (request + 8 + 15) & ~size_t(15));
+}
+
+struct ProfileStats {
+    size_t nodes = 0;          // points de la fonction
+    size_t height = 0;         // plus long chemin racine -> feuille, en noeuds (0 si vide)
+    size_t blackHeight = 0;    // noeuds noirs d'un chemin racine -> feuille
+    double avgDepth = 0.0;     // profondeur moyenne des noeuds (racine = 0)
+    size_t bytes = 0;          // octets sur le tas, pertes de l'allocateur comprises
+    size_t payloadBytes = 0;   // octets utiles (x, deltaY)
+    bool shapeKnown = true;    // false pour std::map : height, blackHeight, avgDepth et subtreeSizes absents
+    size_t sharedWith = 0;     // autres fonctions qui partagent ces points (copie paresseuse)
+    // subtreeSizes[k] = nombre de noeuds dont le sous-arbre a une taille dans [2^k, 2^(k+1))
+    std::vector<size_t> subtreeSizes;
+
+    static size_t sizeClass(size_t n) { return std::bit_width(n) - 1; }
+
+    void addSubtree(size_t n) {
+        size_t k = sizeClass(n);
+        if (subtreeSizes.size() <= k) subtreeSizes.resize(k + 1, 0);
+        ++subtreeSizes[k];
+    }
+
+    // Rapport texte, une mesure par ligne (même format que les métriques : "<nom> <valeur>")
+    void write(std::ostream& out) const {
+        out << "nodes " << nodes << "\n";
+        if (shapeKnown) {
+            out << "height " << height << "\n";
+            out << "black_height " << blackHeight << "\n";
+            out << "avg_depth " << avgDepth << "\n";
+        }
+        out << "bytes " << bytes << "\n";
+        out << "payload_bytes " << payloadBytes << "\n";
+        out << "shared_with " << sharedWith << "\n";
+        for (size_t k = 0; k < subtreeSizes.size(); ++k)
+            out << "subtree_size_" << (size_t(1) << k) << " " << subtreeSizes[k] << "\n";
+    }
+};
@@ -0,0 +1,81 @@
+#pragma once
+// Augmentations de l'arbre rouge-noir choisies à la compilation :
+//     RedBlackTree<DeltaPoint, Augment<SumDelta, PrefixMax, Count>>
+// Chaque politique ajoute ses champs au noeud (struct Fields) et une fonction pull(n) qui recalcule ces
+// champs à partir de n et de ses deux enfants, supposés à jour. L'arbre appelle Aug::pull après chaque
+// insertion, suppression, rotation ou modification de deltaY, du noeud touché jusqu'à la racine.
+//
+// Augment<> (par défaut) : Fields est vide (optimisation de la base vide, le noeud ne grossit pas) et
+// l'arbre ne fait aucune remontée : une augmentation non demandée ne coûte rien.
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+
+// Somme des deltaY du sous-arbre : eval en une descente, O(log n)
+struct SumDelta {
+    struct Fields { double sumDelta = 0.0; };
+
+    template <typename N>
+    static void pull(N* n) {
+        double s = n->data.deltaY;
+        if (n->left) s += n->left->sumDelta;
+        if (n->right) s += n->right->sumDelta;
+        n->sumDelta = s;
+    }
+};
+
+// Plus grande somme préfixe du sous-arbre, c.-à-d. max de f aux points du sous-arbre (relatif à la valeur
+// juste avant son premier point). Demande SumDelta.
+struct PrefixMax {
+    struct Fields { double prefixMax = 0.0; };
+
+    template <typename N>
+    static void pull(N* n) {
+        double upTo = (n->left ? n->left->sumDelta : 0.0) + n->data.deltaY;
+        double m = upTo;
+        if (n->left) m = std::max(m, n->left->prefixMax);
+        if (n->right) m = std::max(m, upTo + n->right->prefixMax);
+        n->prefixMax = m;
+    }
+};
+
+// Plus petite somme préfixe du sous-arbre (symétrique de PrefixMax). Demande SumDelta.
+struct PrefixMin {
+    struct Fields { double prefixMin = 0.0; };
+
+    template <typename N>
+    static void pull(N* n) {
+        double upTo = (n->left ? n->left->sumDelta : 0.0) + n->data.deltaY;
+        double m = upTo;
+        if (n->left) m = std::min(m, n->left->prefixMin);
+        if (n->right) m = std::min(m, upTo + n->right->prefixMin);
+        n->prefixMin = m;
+    }
+};
+
+// Nombre de noeuds du sous-arbre : size() en O(1), k-ième point et rang en O(log n)
+struct Count {
+    struct Fields { size_t count = 1; };
+
+    template <typename N>
+    static void pull(N* n) {
+        n->count = 1 + (n->left ? n->left->count : 0) + (n->right ? n->right->count : 0);
+    }
+};
+
+template <typename... P>
+struct Augment {
+    struct Fields : P::Fields... {};
+
+    template <typename Q>
+    static constexpr bool has = (std::is_same_v<Q, P> || ...);
+
+    static constexpr bool active = sizeof...(P) > 0;
+
+    static_assert(!(has<PrefixMax> || has<PrefixMin>) || has<SumDelta>,
+                  "PrefixMax / PrefixMin s'appuient sur SumDelta");
+
+    // Les politiques ne lisent que les champs des enfants : l'ordre dans la liste est indifférent
+    template <typename N>
+    static void pull(N* n) { (P::pull(n), ...); }
+};
@@ -1,4 +1,6 @@
 // C++ Program to Implement Red Black Tree
+// Prototype antérieur à RBT_sarah.cpp, conservé pour mémoire : ne satisfait pas PiecewiseBackend
+// (piecewise_concept.cpp) et n'est plus maintenu.
 #include <iostream>
 #include <vector>
 #include <cmath>
@@ -289,6 +291,22 @@ public:
     // Destructor: Delete Red-Black Tree
     ~RedBlackTree() { deleteTree(root); }
 
+    // Accès en lecture pour l'adaptateur LegacyPiecewise (piecewise_legacy.cpp) : points (x, deltaY) dans
+    // l'ordre croissant, et présence d'un point à EPSILON près
+    vector<pair<double, double>> to_points_delta() {
+        vector<pair<double, double>> points;
+        function<void(Node*)> inorder = [&](Node* node) {
+            if (!node) return;
+            inorder(node->left);
+            points.push_back({node->data.x, node->data.deltaY});
+            inorder(node->right);
+        };
+        inorder(root);
+        return points;
+    }
+
+    bool contains(double x) { return search(root, T{x, 0.0}) != nullptr; }
+
     // Public function: Insert a value into Red-Black Tree
     void insert(T key)
     {
@@ -0,0 +1,287 @@
+#pragma once
+// Enregistrement des opérations qui modifient les profils (RedBlackTree, PiecewiseLinearFunction) dans une
+// trace binaire compacte, rejouable sur n'importe quelle représentation (replay.cpp) : une exécution lente en
+// production devient un banc d'essai reproductible.
+//
+// Compilé seulement avec -DPROFILE_RECORD=1 : sinon RecordCall<> et record_forget sont vides et le compilateur
+// les retire. Les appels ne sont écrits qu'entre Recorder::start(fichier) et Recorder::stop() :
+//
+//     g++ -DPROFILE_RECORD=1 ...   puis   Recorder::start("run.trace"); ... Recorder::stop();
+//
+// Chaque profil reçoit un numéro à sa première apparition dans un appel enregistré, accompagné d'un instantané
+// de ses points (Snapshot) : les profils construits hors trace (fichier, from_points, copie, sum_all...) sont
+// ainsi repris tels quels. Seul l'appel le plus externe est écrit (sum appelle normalize, update_cbr_* appelle
+// apply_delta sur un profil temporaire : une seule entrée). Une affectation, un swap ou un déplacement change
+// un profil sans appel enregistré : il est oublié (Drop) et sera de nouveau photographié s'il réapparaît.
+// stop() écrit l'état final des profils encore vivants (Check), que le rejeu compare au sien.
+//
+// Format (ordre des octets de la machine) : "PRTR", version u32, puis des entrées
+//     u8 op, u32 profil, [u32 opérande], f64 x nombre d'arguments de op
+//     Snapshot / Check : u8 op, u32 profil, u64 n, n x (f64 x, f64 deltaY)
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <initializer_list>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#ifndef PROFILE_RECORD
+#define PROFILE_RECORD 0
+#endif
+
+inline constexpr bool RECORD_ENABLED = PROFILE_RECORD != 0;
+
+enum class RecordOp : uint8_t {
+    Snapshot, Drop, Check,
+    Insert, AddBreakpoint, RemoveBreakpoint,
+    Sum, Minus, AddScaled, AddClamped, ApplyDelta, Negate,
+    MinConst, MaxConst, MinFunction, MaxFunction,
+    Normalize, SimplifyBand, AutoNormalize,
+    CbrStMin, CbrCtMin, CbrStMax, CbrCtMax, CbrCap,
+    COUNT
+};
+
+inline constexpr size_t RECORD_OPS = static_cast<size_t>(RecordOp::COUNT);
+
+// Nom, nombre d'arguments double et présence d'un profil opérande de chaque entrée
+struct RecordOpInfo {
+    const char* name;
+    uint8_t args;
+    bool operand;
+};
+
+inline const RecordOpInfo& recordOpInfo(RecordOp op) {
+    static const RecordOpInfo infos[] = {
+        {"snapshot", 0, false},       {"drop", 0, false},          {"check", 0, false},
+        {"insert", 2, false},         {"addBreakpoint", 2, false}, {"removeBreakpoint", 1, false},
+        {"sum", 0, true},             {"minus", 0, true},          {"add_scaled", 1, true},
+        {"add_clamped", 2, true},     {"apply_delta", 1, true},    {"negate", 0, false},
+        {"minfunction_c", 1, false},  {"maxfunction_c", 1, false}, {"minfunction", 0, true},
+        {"maxfunction", 0, true},     {"normalize", 3, false},     {"simplify", 2, false},
+        {"setAutoNormalize", 1, false},
+        {"update_cbr_stmin", 5, false}, {"update_cbr_ctmin", 5, false}, {"update_cbr_stmax", 5, false},
+        {"update_cbr_ctmax", 5, false}, {"update_cbr_cap", 4, false},
+    };
+    return infos[static_cast<size_t>(op)];
+}
+
+inline constexpr char RECORD_MAGIC[4] = {'P', 'R', 'T', 'R'};
+inline constexpr uint32_t RECORD_VERSION = 1;
+
+class Recorder {
+public:
+    static Recorder& instance() {
+        static Recorder r;
+        return r;
+    }
+
+    // Ouvre la trace (remplace un fichier existant) ; les profils déjà vus sont oubliés
+    static bool start(const std::string& filename) {
+        Recorder& r = instance();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.out.close();
+        r.out.open(filename, std::ios::binary | std::ios::trunc);
+        if (!r.out) {
+            std::cerr << "Erreur: impossible d'ouvrir le fichier " << filename << std::endl;
+            return false;
+        }
+        r.out.write(RECORD_MAGIC, sizeof(RECORD_MAGIC));
+        r.put(RECORD_VERSION);
+        r.known.clear();
+        r.records = 0;
+        active().store(true, std::memory_order_release);
+        return true;
+    }
+
+    // Écrit l'état final des profils encore vivants et ferme la trace
+    static void stop() {
+        Recorder& r = instance();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        if (!isActive()) return;
+        active().store(false, std::memory_order_release);
+        for (const auto& [p, k] : r.known) r.putPoints(RecordOp::Check, k.id, k.points(p));
+        r.known.clear();
+        r.out.close();
+    }
+
+    ~Recorder() { active().store(false, std::memory_order_release); } // profils statiques détruits après
+
+    static bool isActive() { return active().load(std::memory_order_acquire); }
+
+    // Entrées écrites depuis start()
+    static uint64_t count() { return instance().records; }
+
+    template <typename F, typename G>
+    void call(const F* self, RecordOp op, std::initializer_list<double> args, const G* operand) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!isActive()) return;
+        uint32_t id = idOf(self);
+        uint32_t other = operand ? idOf(operand) : 0;
+        put(static_cast<uint8_t>(op));
+        put(id);
+        if (recordOpInfo(op).operand) put(other);
+        for (double a : args) put(a);
+        ++records;
+    }
+
+    // Profil détruit ou changé hors trace
+    void forget(const void* p) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = known.find(p);
+        if (it == known.end()) return;
+        if (isActive()) {
+            put(static_cast<uint8_t>(RecordOp::Drop));
+            put(it->second.id);
+            ++records;
+        }
+        known.erase(it);
+    }
+
+    // Profondeur d'appels enregistrés du thread : seul l'appel le plus externe est écrit
+    static int& depth() {
+        thread_local int d = 0;
+        return d;
+    }
+
+private:
+    using PointsFn = std::vector<std::pair<double, double>> (*)(const void*);
+
+    struct Known {
+        uint32_t id;
+        PointsFn points;
+    };
+
+    std::mutex mutex;
+    std::ofstream out;
+    std::unordered_map<const void*, Known> known;
+    uint32_t nextId = 1; // jamais réutilisé, même après start()
+    uint64_t records = 0;
+
+    static std::atomic<bool>& active() {
+        static std::atomic<bool> on{false};
+        return on;
+    }
+
+    template <typename T>
+    void put(T v) {
+        out.write(reinterpret_cast<const char*>(&v), sizeof(v));
+    }
+
+    void putPoints(RecordOp op, uint32_t id, const std::vector<std::pair<double, double>>& pts) {
+        put(static_cast<uint8_t>(op));
+        put(id);
+        put(uint64_t(pts.size()));
+        for (const auto& [x, d] : pts) {
+            put(x);
+            put(d);
+        }
+        ++records;
+    }
+
+    // Numéro du profil ; à la première apparition, instantané de ses points
+    template <typename F>
+    uint32_t idOf(const F* f) {
+        auto it = known.find(f);
+        if (it != known.end()) return it->second.id;
+        PointsFn points = [](const void* p) { return static_cast<const F*>(p)->to_points_delta(); };
+        Known k{nextId++, points};
+        known.emplace(f, k);
+        putPoints(RecordOp::Snapshot, k.id, points(f));
+        return k.id;
+    }
+};
+
+//=================================================================================================================
+//======================================  Points d'enregistrement  ================================================
+//=================================================================================================================
+
+// Enregistre l'appel en cours sur self (arguments dans l'ordre de la signature, operand = profil lu) ;
+// vide sans PROFILE_RECORD
+template <bool = RECORD_ENABLED>
+class RecordCall {
+public:
+    template <typename F, typename G = F>
+    RecordCall(const F* self, RecordOp op, std::initializer_list<double> args = {}, const G* operand = nullptr) {
+        if (Recorder::depth()++ == 0 && Recorder::isActive()) Recorder::instance().call(self, op, args, operand);
+    }
+    ~RecordCall() { --Recorder::depth(); }
+    RecordCall(const RecordCall&) = delete;
+    RecordCall& operator=(const RecordCall&) = delete;
+};
+
+template <>
+class RecordCall<false> {
+public:
+    template <typename F, typename G = F>
+    RecordCall(const F*, RecordOp, std::initializer_list<double> = {}, const G* = nullptr) {}
+};
+
+// Profil détruit, déplacé ou réaffecté (vide sans PROFILE_RECORD)
+inline void record_forget(const void* p) {
+    if constexpr (RECORD_ENABLED)
+        if (Recorder::isActive()) Recorder::instance().forget(p);
+}
+
+//=================================================================================================================
+//======================================  Lecture  ================================================================
+//=================================================================================================================
+
+struct RecordEntry {
+    RecordOp op;
+    uint32_t id;
+    uint32_t operand = 0;
+    std::array<double, 5> args{};
+    std::vector<std::pair<double, double>> points; // Snapshot / Check
+};
+
+// Charge toute la trace (le rejeu ne lit pas le disque pendant la mesure)
+inline bool read_record_trace(const std::string& filename, std::vector<RecordEntry>& entries) {
+    std::ifstream in(filename, std::ios::binary);
+    if (!in) {
+        std::cerr << "Erreur: impossible d'ouvrir le fichier " << filename << std::endl;
+        return false;
+    }
+    auto get = [&](auto& v) { return bool(in.read(reinterpret_cast<char*>(&v), sizeof(v))); };
+
+    char magic[4];
+    uint32_t version = 0;
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, RECORD_MAGIC, sizeof(magic)) != 0 || !get(version) ||
+        version != RECORD_VERSION) {
+        std::cerr << "Erreur: " << filename << " n'est pas une trace d'opérations (version " << RECORD_VERSION << ")"
+                  << std::endl;
+        return false;
+    }
+
+    uint8_t code;
+    while (get(code)) {
+        RecordEntry e;
+        e.op = static_cast<RecordOp>(code);
+        bool ok = code < RECORD_OPS && get(e.id);
+        if (ok && (e.op == RecordOp::Snapshot || e.op == RecordOp::Check)) {
+            uint64_t n = 0;
+            ok = get(n);
+            for (uint64_t i = 0; ok && i < n; ++i) {
+                std::pair<double, double> p;
+                ok = get(p.first) && get(p.second);
+                e.points.push_back(p);
+            }
+        } else if (ok) {
+            const RecordOpInfo& info = recordOpInfo(e.op);
+            if (info.operand) ok = get(e.operand);
+            for (size_t i = 0; ok && i < info.args; ++i) ok = get(e.args[i]);
+        }
+        if (!ok) {
+            std::cerr << "Erreur: trace tronquée ou invalide après " << entries.size() << " entrées dans " << filename
+                      << std::endl;
+            return false;
+        }
+        entries.push_back(std::move(e));
+    }
+    return true;
+}
@@ -0,0 +1,259 @@
+// Rejeu d'une trace d'opérations (recorder.cpp) sur chaque représentation maintenue : les appels sont ré-exécutés
+// dans l'ordre, chacun chronométré seul, avec un histogramme par opération (p50, p90, p99, p99.9, max) et les
+// allocations ; résultats JSON sur la sortie standard ou dans --out.
+//
+// Les instantanés (Snapshot) reconstruisent les profils et ne sont pas chronométrés. Les états finaux (Check) de
+// la trace sont comparés point par point à ceux du rejeu : "mismatches" compte les profils qui diffèrent
+// (nombre de points, ou écart relatif > 1e-6 sur une abscisse ou un deltaY), ce qui signale une trace
+// incomplète ou une représentation qui ne calcule pas la même chose.
+// Une opération absente d'une représentation est remplacée par son équivalent (apply_delta par add_scaled,
+// simplifyBand par simplify / simplify_upper / simplify_lower, insert par addBreakpoint).
+//
+//     g++ -std=c++20 -O2 -DNDEBUG -DPROFILE_RECORD=1 bench.cpp -o bench_record   (trace de démonstration)
+//     ./bench_record --tail 200000 --tail-n 1000000 --record run.trace
+//     g++ -std=c++20 -O2 -DNDEBUG replay.cpp -o replay
+//     ./replay run.trace --backend rbt --backend map --repeat 5 --out replay.json
+//     ./replay run.trace --print | head
+#include "RBT_sarah.cpp"
+#include "piecewise_function.cpp"
+#include "bench_core.cpp"
+#include "bench_tail.cpp"
+#include "recorder.cpp"
+#include <unordered_map>
+
+struct ReplayResult {
+    std::string backend;
+    uint64_t bestNs = 0;   // meilleur temps total sur --repeat passes
+    uint64_t allocs = 0;   // allocations d'une passe
+    size_t mismatches = 0; // profils dont l'état final diffère de la trace
+    double maxError = 0.0;
+    std::array<LatencyHistogram, RECORD_OPS> byOp{};
+    bool failed = false;   // trace incohérente (opérande inconnu)
+};
+
+// Écart entre les points (x, deltaY) de f et ceux d'un état final enregistré, comparés un à un : abscisses
+// relatives à leur amplitude, deltaY relatifs à celle de la fonction. Nombre de points différent : écart 1.
+// (Comparer des évaluations en ces abscisses signalerait à tort les sauts et les points quasi confondus.)
+template <typename F>
+double replay_error(const F& f, const std::vector<std::pair<double, double>>& pts) {
+    std::vector<std::pair<double, double>> got = f.to_points_delta();
+    if (got.size() != pts.size()) return 1.0;
+    double y = 0.0, scale = 1.0, xscale = 1.0, err = 0.0;
+    for (const auto& [x, d] : pts) {
+        scale = std::max(scale, std::abs(y += d));
+        xscale = std::max(xscale, std::abs(x));
+    }
+    for (size_t i = 0; i < pts.size(); ++i)
+        err = std::max({err, std::abs(got[i].first - pts[i].first) / xscale,
+                        std::abs(got[i].second - pts[i].second) / scale});
+    return err;
+}
+
+template <typename F>
+void replay_op(F& f, const F* g, const RecordEntry& e) {
+    const auto& a = e.args;
+    switch (e.op) {
+    case RecordOp::Insert:
+        if constexpr (requires { f.insert(DeltaPoint{a[0], a[1]}); }) f.insert(DeltaPoint{a[0], a[1]});
+        else f.addBreakpoint(a[0], a[1]);
+        break;
+    case RecordOp::AddBreakpoint:    f.addBreakpoint(a[0], a[1]); break;
+    case RecordOp::RemoveBreakpoint: f.removeBreakpoint(a[0]); break;
+    case RecordOp::Sum:              f.sum(*g); break;
+    case RecordOp::Minus:            f.minus(*g); break;
+    case RecordOp::AddScaled:        f.add_scaled(*g, a[0]); break;
+    case RecordOp::AddClamped:
+        if constexpr (requires { f.add_clamped(*g, a[0], a[1]); }) f.add_clamped(*g, a[0], a[1]);
+        break;
+    case RecordOp::ApplyDelta:
+        if constexpr (requires { f.apply_delta(*g, a[0]); }) f.apply_delta(*g, a[0]);
+        else f.add_scaled(*g, a[0]);
+        break;
+    case RecordOp::Negate:      f.negate(); break;
+    case RecordOp::MinConst:    f.minfunction(a[0]); break;
+    case RecordOp::MaxConst:    f.maxfunction(a[0]); break;
+    case RecordOp::MinFunction: f.minfunction(*g); break;
+    case RecordOp::MaxFunction: f.maxfunction(*g); break;
+    case RecordOp::Normalize:
+        if constexpr (requires { f.normalize(a[0], a[1], a[2]); }) f.normalize(a[0], a[1], a[2]);
+        else f.normalize(a[2]);
+        break;
+    case RecordOp::SimplifyBand:
+        if constexpr (requires { f.simplifyBand(a[0], a[1]); }) f.simplifyBand(a[0], a[1]);
+        else if constexpr (requires { f.simplify_upper(a[1]); f.simplify_lower(a[1]); }) {
+            if (a[0] == 0.0) f.simplify_upper(a[1]);
+            else if (a[1] == 0.0) f.simplify_lower(-a[0]);
+            else f.simplify(std::min(-a[0], a[1]));
+        } else {
+            f.simplify(std::min(-a[0], a[1]));
+        }
+        break;
+    case RecordOp::AutoNormalize:
+        if constexpr (requires { f.setAutoNormalize(true); }) f.setAutoNormalize(a[0] != 0.0);
+        break;
+    case RecordOp::CbrStMin: case RecordOp::CbrCtMin: case RecordOp::CbrStMax: case RecordOp::CbrCtMax:
+    case RecordOp::CbrCap: {
+        auto kind = static_cast<CbrKind>(static_cast<size_t>(e.op) - static_cast<size_t>(RecordOp::CbrStMin));
+        apply_cbr_update(f, CbrUpdate{kind, a[0], a[1], a[2], a[3], a[4]});
+        break;
+    }
+    case RecordOp::Snapshot: case RecordOp::Drop: case RecordOp::Check: case RecordOp::COUNT: break;
+    }
+}
+
+// Une passe complète ; retourne le temps total des opérations chronométrées
+template <typename F>
+uint64_t replay_pass(const std::vector<RecordEntry>& entries, ReplayResult& r, bool last) {
+    std::unordered_map<uint32_t, F> profiles; // adresses stables : g reste valide pendant l'appel
+    uint64_t total = 0;
+    uint64_t a0 = bench_allocs();
+    for (const RecordEntry& e : entries) {
+        switch (e.op) {
+        case RecordOp::Snapshot:
+            profiles.erase(e.id);
+            bench_fill(profiles[e.id], e.points);
+            continue;
+        case RecordOp::Drop:
+            profiles.erase(e.id);
+            continue;
+        case RecordOp::Check:
+            if (last) {
+                auto it = profiles.find(e.id);
+                double err = it == profiles.end() ? 1.0 : replay_error(it->second, e.points);
+                r.maxError = std::max(r.maxError, err);
+                r.mismatches += err > 1e-6;
+            }
+            continue;
+        default: break;
+        }
+
+        auto self = profiles.find(e.id);
+        auto other = recordOpInfo(e.op).operand ? profiles.find(e.operand) : profiles.end();
+        if (self == profiles.end() || (recordOpInfo(e.op).operand && other == profiles.end())) {
+            std::cerr << r.backend << ": profil inconnu dans l'entrée " << (&e - entries.data()) << " ("
+                      << recordOpInfo(e.op).name << ")" << std::endl;
+            r.failed = true;
+            return total;
+        }
+        const F* g = other == profiles.end() ? nullptr : &other->second;
+        auto t0 = std::chrono::steady_clock::now();
+        replay_op(self->second, g, e);
+        auto t1 = std::chrono::steady_clock::now();
+        uint64_t ns = uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+        total += ns;
+        r.byOp[static_cast<size_t>(e.op)].record(ns);
+    }
+    r.allocs = bench_allocs() - a0;
+    return total;
+}
+
+template <typename F>
+ReplayResult run_replay(const std::string& backend, const std::vector<RecordEntry>& entries, int repeat,
+                        bool quiet) {
+    ReplayResult r;
+    r.backend = backend;
+    for (int pass = 0; pass < repeat && !r.failed; ++pass) {
+        uint64_t ns = replay_pass<F>(entries, r, pass + 1 == repeat);
+        if (pass == 0 || ns < r.bestNs) r.bestNs = ns;
+    }
+    if (!quiet)
+        std::cerr << backend << " replay " << r.bestNs / 1e6 << " ms, mismatches " << r.mismatches
+                  << (r.failed ? " (échec)" : "") << std::endl;
+    return r;
+}
+
+inline void write_replay_json(std::ostream& out, const std::string& trace, const std::vector<RecordEntry>& entries,
+                              int repeat, const std::vector<ReplayResult>& results) {
+    std::array<size_t, RECORD_OPS> counts{};
+    for (const RecordEntry& e : entries) ++counts[static_cast<size_t>(e.op)];
+    out << std::setprecision(6);
+    out << "{\n  \"benchmark\": \"replay\",\n  \"trace\": \"" << trace << "\",\n  \"entries\": " << entries.size()
+        << ",\n  \"repeat\": " << repeat << ",\n  \"results\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const ReplayResult& r = results[i];
+        out << (i ? "," : "") << "\n    {\n      \"backend\": \"" << r.backend << "\", \"failed\": "
+            << (r.failed ? "true" : "false") << ", \"total_ns\": " << r.bestNs << ", \"allocs\": " << r.allocs
+            << ", \"mismatches\": " << r.mismatches << ", \"max_error\": " << r.maxError << ",\n      \"latency_ns\": {";
+        bool first = true;
+        for (size_t k = 0; k < RECORD_OPS; ++k) {
+            if (!r.byOp[k].count) continue;
+            out << (first ? "\n" : ",\n") << "        \"" << recordOpInfo(static_cast<RecordOp>(k)).name << "\": ";
+            write_latency_json(out, r.byOp[k]);
+            first = false;
+        }
+        out << "\n      }\n    }";
+    }
+    out << "\n  ],\n  \"counts\": {";
+    bool first = true;
+    for (size_t k = 0; k < RECORD_OPS; ++k) {
+        if (!counts[k]) continue;
+        out << (first ? "" : ", ") << "\"" << recordOpInfo(static_cast<RecordOp>(k)).name << "\": " << counts[k];
+        first = false;
+    }
+    out << "}\n}\n";
+}
+
+// Une ligne par entrée : rang op profil [opérande] arguments, ou nombre de points pour Snapshot / Check
+inline void print_trace(std::ostream& out, const std::vector<RecordEntry>& entries) {
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const RecordEntry& e = entries[i];
+        const RecordOpInfo& info = recordOpInfo(e.op);
+        out << i << " " << info.name << " #" << e.id;
+        if (info.operand) out << " #" << e.operand;
+        for (size_t k = 0; k < info.args; ++k) out << " " << e.args[k];
+        if (e.op == RecordOp::Snapshot || e.op == RecordOp::Check) out << " (" << e.points.size() << " points)";
+        out << "\n";
+    }
+}
+
+int main(int argc, char** argv) {
+    // trace et options propres au rejeu, retirées avant parse_bench_args
+    std::string trace;
+    int repeat = 1;
+    bool print = false;
+    std::vector<char*> rest{argv[0]};
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--repeat" && i + 1 < argc) repeat = std::max(1, std::stoi(argv[++i]));
+        else if (a == "--print") print = true;
+        else if (trace.empty() && a.rfind("--", 0) != 0) trace = a;
+        else rest.push_back(argv[i]);
+    }
+    if (trace.empty()) {
+        std::cerr << "usage: " << argv[0] << " TRACE [--repeat K] [--print] [--backend NOM] [--out FICHIER] [--quiet]"
+                  << std::endl;
+        return 2;
+    }
+    BenchOptions opt = parse_bench_args(int(rest.size()), rest.data());
+
+    std::vector<RecordEntry> entries;
+    if (!read_record_trace(trace, entries)) return 1;
+    if (print) {
+        print_trace(std::cout, entries);
+        return 0;
+    }
+
+    std::vector<ReplayResult> results;
+    auto replay = [&]<typename F>(const char* name) {
+        if (opt.wantsBackend(name)) results.push_back(run_replay<F>(name, entries, repeat, opt.quiet));
+    };
+    replay.operator()<RedBlackTree<DeltaPoint>>("rbt");
+    replay.operator()<RedBlackTree<DeltaPoint, Augment<SumDelta>>>("rbt_sumdelta");
+    replay.operator()<PiecewiseLinearFunction>("map");
+    replay.operator()<FlatPiecewise>("flat");
+    replay.operator()<PiecewiseFunction>("adaptive");
+
+    if (opt.out.empty()) {
+        write_replay_json(std::cout, trace, entries, repeat, results);
+    } else {
+        std::ofstream out(opt.out);
+        if (!out) {
+            std::cerr << "Erreur: impossible d'ouvrir le fichier " << opt.out << std::endl;
+            return 1;
+        }
+        write_replay_json(out, trace, entries, repeat, results);
+    }
+    bool failed = false;
+    for (const ReplayResult& r : results) failed |= r.failed || r.mismatches > 0;
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,144 @@
+#pragma once
+// Traces de diagnostic des profils (arbre, std::map, tableaux), à la place des std::cout dans les opérations.
+//
+// Niveau choisi à la compilation par PROFILE_TRACE_LEVEL (0 par défaut) : trace<L>(...) au-dessus de ce niveau
+// est retiré par le compilateur (if constexpr), sans test ni écriture. Les traces compilées ne sont écrites que
+// si elles sont activées à l'exécution (Trace::enable), dans un tampon circulaire sans verrou : chaque écrivain
+// réserve une case par fetch_add, les plus anciennes sont écrasées. Trace::snapshot / Trace::dump relisent les
+// cases complètes à la demande (protocole à numéro de séquence, une case en cours d'écriture est ignorée).
+//
+//     g++ -DPROFILE_TRACE_LEVEL=2 ...   puis   Trace::enable(true); ... Trace::dump(std::cerr);
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+#ifndef PROFILE_TRACE_LEVEL
+#define PROFILE_TRACE_LEVEL 0
+#endif
+
+enum class TraceLevel : int { Off = 0, Info = 1, Debug = 2, Verbose = 3 };
+
+inline constexpr TraceLevel COMPILED_TRACE_LEVEL = static_cast<TraceLevel>(PROFILE_TRACE_LEVEL);
+
+// Une trace : nom d'événement (chaîne littérale) et deux valeurs numériques
+struct TraceEvent {
+    uint64_t seq;      // rang d'écriture, croissant
+    uint64_t timeNs;   // horloge monotone
+    uint32_t thread;   // empreinte du thread écrivain
+    TraceLevel level;
+    const char* what;
+    double a, b;
+};
+
+class Trace {
+public:
+    static constexpr size_t CAPACITY = 4096; // puissance de 2
+
+    static void enable(bool on) { enabled().store(on, std::memory_order_relaxed); }
+    static bool isEnabled() { return enabled().load(std::memory_order_relaxed); }
+
+    static void emit(TraceLevel level, const char* what, double a, double b) {
+        if (!isEnabled()) return;
+        uint64_t seq = head().fetch_add(1, std::memory_order_relaxed);
+        Slot& s = ring()[seq & (CAPACITY - 1)];
+        s.stamp.store(0, std::memory_order_relaxed); // case en cours d'écriture
+        std::atomic_thread_fence(std::memory_order_release);
+        s.timeNs.store(nowNs(), std::memory_order_relaxed);
+        s.thread.store(threadTag(), std::memory_order_relaxed);
+        s.level.store(static_cast<int>(level), std::memory_order_relaxed);
+        s.what.store(what, std::memory_order_relaxed);
+        s.a.store(a, std::memory_order_relaxed);
+        s.b.store(b, std::memory_order_relaxed);
+        s.stamp.store(seq + 1, std::memory_order_release);
+    }
+
+    // Traces encore présentes dans le tampon, de la plus ancienne à la plus récente
+    static std::vector<TraceEvent> snapshot() {
+        std::vector<TraceEvent> out;
+        uint64_t end = head().load(std::memory_order_acquire);
+        uint64_t begin = end > CAPACITY ? end - CAPACITY : 0;
+        for (uint64_t seq = begin; seq < end; ++seq) {
+            Slot& s = ring()[seq & (CAPACITY - 1)];
+            if (s.stamp.load(std::memory_order_acquire) != seq + 1) continue;
+            TraceEvent e{seq,
+                         s.timeNs.load(std::memory_order_relaxed),
+                         s.thread.load(std::memory_order_relaxed),
+                         static_cast<TraceLevel>(s.level.load(std::memory_order_relaxed)),
+                         s.what.load(std::memory_order_relaxed),
+                         s.a.load(std::memory_order_relaxed),
+                         s.b.load(std::memory_order_relaxed)};
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (s.stamp.load(std::memory_order_relaxed) != seq + 1) continue; // réécrite pendant la lecture
+            out.push_back(e);
+        }
+        return out;
+    }
+
+    // Une ligne par trace : seq temps(ns) thread niveau événement a b
+    static void dump(std::ostream& out) {
+        for (const TraceEvent& e : snapshot())
+            out << e.seq << " " << e.timeNs << " " << e.thread << " " << levelName(e.level) << " "
+                << e.what << " " << e.a << " " << e.b << "\n";
+    }
+
+    // Vide le tampon (à appeler sans écrivain actif)
+    static void clear() {
+        for (size_t i = 0; i < CAPACITY; ++i) ring()[i].stamp.store(0, std::memory_order_relaxed);
+        head().store(0, std::memory_order_release);
+    }
+
+    static const char* levelName(TraceLevel l) {
+        switch (l) {
+        case TraceLevel::Off:     return "off";
+        case TraceLevel::Info:    return "info";
+        case TraceLevel::Debug:   return "debug";
+        case TraceLevel::Verbose: return "verbose";
+        }
+        return "?";
+    }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> stamp{0}; // seq + 1 une fois la case complète, 0 pendant l'écriture
+        std::atomic<uint64_t> timeNs{0};
+        std::atomic<uint32_t> thread{0};
+        std::atomic<int> level{0};
+        std::atomic<const char*> what{nullptr};
+        std::atomic<double> a{0.0}, b{0.0};
+    };
+
+    static std::atomic<bool>& enabled() {
+        static std::atomic<bool> on{false};
+        return on;
+    }
+
+    static std::atomic<uint64_t>& head() {
+        static std::atomic<uint64_t> h{0};
+        return h;
+    }
+
+    static Slot* ring() {
+        static Slot slots[CAPACITY];
+        return slots;
+    }
+
+    static uint64_t nowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    static uint32_t threadTag() {
+        thread_local uint32_t tag = static_cast<uint32_t>(std::hash<std::thread::id>()(std::this_thread::get_id()));
+        return tag;
+    }
+};
+
+// Point de trace : retiré à la compilation si L dépasse PROFILE_TRACE_LEVEL
+template <TraceLevel L>
+inline void trace(const char* what, double a = 0.0, double b = 0.0) {
+    if constexpr (L != TraceLevel::Off && L <= COMPILED_TRACE_LEVEL) Trace::emit(L, what, a, b);
+}
@@ -0,0 +1,279 @@
+#pragma once
+// Charges synthétiques d'ordonnancement pour les bancs d'essai et les essais : ensembles de tâches avec leurs
+// fenêtres (stmin, ctmin, stmax, ctmax) et capacités, profils CBR qui en découlent, et suites de mises à jour
+// update_cbr_* telles qu'en produit la propagation. Tout est tiré d'une graine : même spécification, même
+// charge, sur toute machine (std::mt19937_64 et tirages faits à la main, pas de std::*_distribution dont les
+// résultats changent d'une bibliothèque standard à l'autre).
+//
+// Les charges s'utilisent en mémoire (generate_tasks, generate_updates, workload_profile_points) ou passent par
+// des fichiers texte, une tâche ou un appel par ligne (write_tasks / read_tasks, write_updates / read_updates),
+// voir workload_gen.cpp pour l'outil en ligne de commande.
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+//=================================================================================================================
+//======================================  Tâches  =================================================================
+//=================================================================================================================
+
+// Répartition des dates de début au plus tôt sur l'horizon
+enum class WorkloadDistribution {
+    Uniform,   // uniforme sur [0, horizon]
+    Clustered, // rafales : tâches groupées autour de quelques centres (écart type horizon / (8 clusters))
+    FrontLoaded // décroissance exponentielle : beaucoup de tâches en début d'horizon
+};
+
+inline const char* workloadDistributionName(WorkloadDistribution d) {
+    switch (d) {
+    case WorkloadDistribution::Uniform:     return "uniform";
+    case WorkloadDistribution::Clustered:   return "clustered";
+    case WorkloadDistribution::FrontLoaded: return "front";
+    }
+    return "?";
+}
+
+inline bool parseWorkloadDistribution(const std::string& s, WorkloadDistribution& d) {
+    for (WorkloadDistribution v : {WorkloadDistribution::Uniform, WorkloadDistribution::Clustered,
+                                   WorkloadDistribution::FrontLoaded})
+        if (s == workloadDistributionName(v)) {
+            d = v;
+            return true;
+        }
+    return false;
+}
+
+struct WorkloadSpec {
+    size_t tasks = 1000;
+    double horizon = 10000.0;
+    double overlap = 4.0;       // tâches en cours en moyenne à un instant donné : durée moyenne = overlap * horizon / tasks
+    double slack = 2.0;         // marge moyenne stmax - stmin, en durées de tâche
+    double capLow = 1.0;        // capacité tirée dans [capLow, capHigh]
+    double capHigh = 5.0;
+    size_t clusters = 8;        // pour Clustered
+    WorkloadDistribution distribution = WorkloadDistribution::Uniform;
+    uint64_t seed = 42;
+};
+
+// Une tâche : fenêtres au plus tôt [stmin, ctmin] et au plus tard [stmax, ctmax], de même durée
+struct WorkloadTask {
+    double stmin, ctmin, stmax, ctmax;
+    double capMin, capMax;
+
+    double duration() const { return ctmin - stmin; }
+};
+
+// Tirages portables : uniforme dans [0, 1) sur 53 bits
+inline double workload_uniform(std::mt19937_64& rng) { return double(rng() >> 11) * 0x1.0p-53; }
+
+// Gaussienne centrée réduite (Box-Muller)
+inline double workload_gaussian(std::mt19937_64& rng) {
+    double u = 1.0 - workload_uniform(rng), v = workload_uniform(rng);
+    return std::sqrt(-2.0 * std::log(u)) * std::cos(2.0 * M_PI * v);
+}
+
+inline std::vector<WorkloadTask> generate_tasks(const WorkloadSpec& spec) {
+    std::mt19937_64 rng(spec.seed);
+    const double meanDur = spec.tasks ? spec.overlap * spec.horizon / double(spec.tasks) : 1.0;
+
+    std::vector<double> centres(std::max<size_t>(1, spec.clusters));
+    for (double& c : centres) c = spec.horizon * workload_uniform(rng);
+    const double spread = spec.horizon / (8.0 * double(centres.size()));
+
+    std::vector<WorkloadTask> tasks(spec.tasks);
+    for (WorkloadTask& t : tasks) {
+        double dur = meanDur * (0.5 + workload_uniform(rng)); // [0,5 ; 1,5] fois la moyenne
+        double slack = spec.slack * dur * 2.0 * workload_uniform(rng);
+        double latest = std::max(0.0, spec.horizon - dur - slack); // dernière date de début au plus tôt possible
+        double start = 0.0;
+        switch (spec.distribution) {
+        case WorkloadDistribution::Uniform:
+            start = latest * workload_uniform(rng);
+            break;
+        case WorkloadDistribution::Clustered:
+            start = centres[rng() % centres.size()] + spread * workload_gaussian(rng);
+            break;
+        case WorkloadDistribution::FrontLoaded:
+            start = -std::log(1.0 - workload_uniform(rng)) * spec.horizon / 5.0;
+            break;
+        }
+        start = std::clamp(start, 0.0, latest);
+        double cap = spec.capLow + (spec.capHigh - spec.capLow) * workload_uniform(rng);
+        t = {start, start + dur, start + slack, start + slack + dur, cap, cap};
+    }
+    std::sort(tasks.begin(), tasks.end(), [](const WorkloadTask& a, const WorkloadTask& b) { return a.stmin < b.stmin; });
+    return tasks;
+}
+
+// Points (x, deltaY) triés du profil cumulé des tâches : somme des cba_profile(cap, stmin, ctmin) (au plus tôt)
+// ou (cap, stmax, ctmax) (au plus tard), rampe de 0 à cap sur la fenêtre de chaque tâche.
+inline std::vector<std::pair<double, double>> workload_profile_points(const std::vector<WorkloadTask>& tasks,
+                                                                      bool latest = false) {
+    std::vector<std::pair<double, double>> pts;
+    pts.reserve(2 * tasks.size());
+    for (const WorkloadTask& t : tasks) {
+        pts.push_back({latest ? t.stmax : t.stmin, 0.0});
+        pts.push_back({latest ? t.ctmax : t.ctmin, t.capMax});
+    }
+    std::sort(pts.begin(), pts.end());
+    size_t k = 0;
+    for (size_t i = 0; i < pts.size(); ++i) {
+        if (k && pts[k - 1].first == pts[i].first) pts[k - 1].second += pts[i].second;
+        else pts[k++] = pts[i];
+    }
+    pts.resize(k);
+    return pts;
+}
+
+//=================================================================================================================
+//======================================  Mises à jour CBR  =======================================================
+//=================================================================================================================
+
+enum class CbrKind : uint8_t { StMin, CtMin, StMax, CtMax, Cap, COUNT };
+
+inline constexpr size_t CBR_KINDS = static_cast<size_t>(CbrKind::COUNT);
+
+inline const char* cbrKindName(CbrKind k) {
+    static const char* names[] = {"update_cbr_stmin", "update_cbr_ctmin", "update_cbr_stmax", "update_cbr_ctmax",
+                                  "update_cbr_cap"};
+    return names[static_cast<size_t>(k)];
+}
+
+// Un appel update_cbr_* : ses arguments dans l'ordre (old, new, borne, cap_min, cap_max ; pour cap :
+// cap_old, cap, start, end, e inutilisé)
+struct CbrUpdate {
+    CbrKind kind;
+    double a, b, c, d, e;
+};
+
+template <typename F>
+void apply_cbr_update(F& f, const CbrUpdate& u) {
+    switch (u.kind) {
+    case CbrKind::StMin: f.update_cbr_stmin(u.a, u.b, u.c, u.d, u.e); break;
+    case CbrKind::CtMin: f.update_cbr_ctmin(u.a, u.b, u.c, u.d, u.e); break;
+    case CbrKind::StMax: f.update_cbr_stmax(u.a, u.b, u.c, u.d, u.e); break;
+    case CbrKind::CtMax: f.update_cbr_ctmax(u.a, u.b, u.c, u.d, u.e); break;
+    case CbrKind::Cap:   f.update_cbr_cap(u.a, u.b, u.c, u.d); break;
+    case CbrKind::COUNT: break;
+    }
+}
+
+// Suite de calls appels imitant la propagation : à chaque pas, une tâche voit sa fenêtre se resserrer par le
+// début (update_cbr_stmin puis ctmin) ou par la fin (stmax puis ctmax), ou sa capacité changer (cap). Une tâche
+// sans marge ne peut plus que changer de capacité : chaque appel part de l'état laissé par les précédents, la
+// suite se rejoue donc telle quelle. tasks est modifié : état final des fenêtres.
+inline std::vector<CbrUpdate> generate_updates(std::vector<WorkloadTask>& tasks, const WorkloadSpec& spec,
+                                               size_t calls) {
+    std::vector<CbrUpdate> out;
+    if (tasks.empty()) return out;
+    std::mt19937_64 rng(spec.seed ^ 0x9e3779b97f4a7c15ULL);
+
+    out.reserve(calls + 1);
+    while (out.size() < calls) {
+        size_t i = rng() % tasks.size();
+        WorkloadTask& t = tasks[i];
+        double dur = t.duration();
+        double slack = t.stmax - t.stmin;
+        double step = slack * (0.05 + 0.45 * workload_uniform(rng));
+        double r = workload_uniform(rng);
+        bool exhausted = slack < 1e-3 * dur + 1e-6;
+        if (!exhausted && r < 0.45) { // début au plus tôt repoussé
+            double s0 = t.stmin, s1 = t.stmin + step;
+            out.push_back({CbrKind::StMin, s0, s1, t.ctmin, t.capMin, t.capMax});
+            out.push_back({CbrKind::CtMin, t.ctmin, s1 + dur, s1, t.capMin, t.capMax});
+            t.stmin = s1;
+            t.ctmin = s1 + dur;
+        } else if (!exhausted && r < 0.9) { // fin au plus tard avancée
+            double s0 = t.stmax, s1 = t.stmax - step;
+            out.push_back({CbrKind::StMax, s0, s1, t.ctmax, t.capMin, t.capMax});
+            out.push_back({CbrKind::CtMax, t.ctmax, s1 + dur, s1, t.capMin, t.capMax});
+            t.stmax = s1;
+            t.ctmax = s1 + dur;
+        } else { // changement de capacité, seul possible sans marge
+            double c1 = spec.capLow + (spec.capHigh - spec.capLow) * workload_uniform(rng);
+            out.push_back({CbrKind::Cap, t.capMax, c1, t.stmin, t.ctmax, 0.0});
+            t.capMin = t.capMax = c1;
+        }
+    }
+    out.resize(calls);
+    return out;
+}
+
+//=================================================================================================================
+//======================================  Fichiers  ===============================================================
+//=================================================================================================================
+
+// Tâches : "stmin ctmin stmax ctmax cap_min cap_max" par ligne, lignes "#" ignorées
+inline bool write_tasks(const std::string& filename, const std::vector<WorkloadTask>& tasks) {
+    std::ofstream out(filename);
+    if (!out) {
+        std::cerr << "Erreur: impossible d'ouvrir le fichier " << filename << std::endl;
+        return false;
+    }
+    out << "# stmin ctmin stmax ctmax cap_min cap_max\n" << std::setprecision(17);
+    for (const WorkloadTask& t : tasks)
+        out << t.stmin << " " << t.ctmin << " " << t.stmax << " " << t.ctmax << " " << t.capMin << " " << t.capMax
+            << "\n";
+    return true;
+}
+
+inline std::vector<WorkloadTask> read_tasks(const std::string& filename) {
+    std::vector<WorkloadTask> tasks;
+    std::ifstream in(filename);
+    if (!in) {
+        std::cerr << "Erreur: impossible d'ouvrir le fichier " << filename << std::endl;
+        return tasks;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream s(line);
+        WorkloadTask t;
+        if (s >> t.stmin >> t.ctmin >> t.stmax >> t.ctmax >> t.capMin >> t.capMax) tasks.push_back(t);
+        else std::cerr << "Erreur: ligne de tâche invalide dans " << filename << " : " << line << std::endl;
+    }
+    return tasks;
+}
+
+// Mises à jour : "<update_cbr_*> a b c d e" par ligne (les arguments de l'appel), lignes "#" ignorées
+inline bool write_updates(const std::string& filename, const std::vector<CbrUpdate>& updates) {
+    std::ofstream out(filename);
+    if (!out) {
+        std::cerr << "Erreur: impossible d'ouvrir le fichier " << filename << std::endl;
+        return false;
+    }
+    out << "# op a b c d e\n" << std::setprecision(17);
+    for (const CbrUpdate& u : updates)
+        out << cbrKindName(u.kind) << " " << u.a << " " << u.b << " " << u.c << " " << u.d << " " << u.e << "\n";
+    return true;
+}
+
+inline std::vector<CbrUpdate> read_updates(const std::string& filename) {
+    std::vector<CbrUpdate> updates;
+    std::ifstream in(filename);
+    if (!in) {
+        std::cerr << "Erreur: impossible d'ouvrir le fichier " << filename << std::endl;
+        return updates;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream s(line);
+        std::string name;
+        CbrUpdate u{CbrKind::COUNT, 0, 0, 0, 0, 0};
+        s >> name >> u.a >> u.b >> u.c >> u.d >> u.e;
+        for (size_t k = 0; k < CBR_KINDS; ++k)
+            if (name == cbrKindName(static_cast<CbrKind>(k))) u.kind = static_cast<CbrKind>(k);
+        if (s && u.kind != CbrKind::COUNT) updates.push_back(u);
+        else std::cerr << "Erreur: ligne de mise à jour invalide dans " << filename << " : " << line << std::endl;
+    }
+    return updates;
+}
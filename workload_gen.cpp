@@ -0,0 +1,93 @@
+// Générateur de charges d'ordonnancement (workload.cpp) : écrit les tâches, les mises à jour update_cbr_* d'une
+// propagation simulée et les profils cumulés au plus tôt / au plus tard (format exportFunction, pour draw_f.py).
+// Sans fichier de sortie, affiche un résumé de la charge.
+//
+//     g++ -std=c++20 -O2 -DNDEBUG workload_gen.cpp -o workload_gen
+//     ./workload_gen --tasks 25000 --horizon 1000000 --overlap 8 --dist clustered --seed 7
+//     ./workload_gen --tasks 25000 --horizon 1000000 --tasks-out tasks.txt --profile-out kmin.txt
+//     ./workload_gen --tasks-in tasks.txt --updates 200000 --updates-out updates.txt
+#include "RBT_sarah.cpp"
+#include "workload.cpp"
+
+int main(int argc, char** argv) {
+    WorkloadSpec spec;
+    size_t updates = 0;
+    std::string tasksIn, tasksOut, updatesOut, profileOut, latestOut;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                std::cerr << "Erreur: valeur manquante après " << a << std::endl;
+                std::exit(2);
+            }
+            return argv[++i];
+        };
+        if (a == "--tasks") spec.tasks = std::stoull(value());
+        else if (a == "--horizon") spec.horizon = std::stod(value());
+        else if (a == "--overlap") spec.overlap = std::stod(value());
+        else if (a == "--slack") spec.slack = std::stod(value());
+        else if (a == "--cap-low") spec.capLow = std::stod(value());
+        else if (a == "--cap-high") spec.capHigh = std::stod(value());
+        else if (a == "--clusters") spec.clusters = std::max<size_t>(1, std::stoull(value()));
+        else if (a == "--seed") spec.seed = std::stoull(value());
+        else if (a == "--updates") updates = std::stoull(value());
+        else if (a == "--tasks-in") tasksIn = value();
+        else if (a == "--tasks-out") tasksOut = value();
+        else if (a == "--updates-out") updatesOut = value();
+        else if (a == "--profile-out") profileOut = value();
+        else if (a == "--latest-out") latestOut = value();
+        else if (a == "--dist") {
+            std::string d = value();
+            if (!parseWorkloadDistribution(d, spec.distribution)) {
+                std::cerr << "Erreur: distribution inconnue " << d << " (uniform, clustered, front)" << std::endl;
+                return 2;
+            }
+        } else {
+            std::cerr << "Erreur: option inconnue " << a << "\n"
+                      << "usage: " << argv[0]
+                      << " [--tasks N] [--horizon H] [--overlap K] [--slack S] [--cap-low C] [--cap-high C]"
+                      << " [--dist uniform|clustered|front] [--clusters K] [--seed S] [--updates APPELS]"
+                      << " [--tasks-in FICHIER] [--tasks-out FICHIER] [--updates-out FICHIER]"
+                      << " [--profile-out FICHIER] [--latest-out FICHIER]" << std::endl;
+            return 2;
+        }
+    }
+
+    // --tasks-in : fenêtres relues (mises à jour et profils tirés de ces tâches), sinon générées
+    std::vector<WorkloadTask> tasks = tasksIn.empty() ? generate_tasks(spec) : read_tasks(tasksIn);
+    if (!tasksIn.empty() && tasks.empty()) return 1;
+    if (!tasksOut.empty() && !write_tasks(tasksOut, tasks)) return 1;
+
+    auto exportProfile = [&](const std::string& filename, bool latest) {
+        if (filename.empty()) return;
+        RedBlackTree<DeltaPoint> f = RedBlackTree<DeltaPoint>::from_points(workload_profile_points(tasks, latest));
+        f.exportFunction(filename);
+    };
+    exportProfile(profileOut, false);
+    exportProfile(latestOut, true);
+
+    std::vector<CbrUpdate> stream;
+    if (updates) {
+        std::vector<WorkloadTask> state = tasks;
+        stream = generate_updates(state, spec, updates);
+        if (!updatesOut.empty() && !write_updates(updatesOut, stream)) return 1;
+    }
+
+    if (tasksOut.empty() && updatesOut.empty() && profileOut.empty() && latestOut.empty()) {
+        double busy = 0.0, slack = 0.0;
+        for (const WorkloadTask& t : tasks) {
+            busy += t.duration();
+            slack += t.stmax - t.stmin;
+        }
+        std::array<size_t, CBR_KINDS> byKind{};
+        for (const CbrUpdate& u : stream) ++byKind[static_cast<size_t>(u.kind)];
+        double n = double(std::max<size_t>(1, tasks.size()));
+        std::cout << "tâches " << tasks.size() << " (" << workloadDistributionName(spec.distribution)
+                  << ", graine " << spec.seed << "), durée moyenne " << busy / n << ", marge moyenne " << slack / n
+                  << ", recouvrement " << busy / std::max(spec.horizon, 1e-9) << "\n"
+                  << "points du profil au plus tôt " << workload_profile_points(tasks).size() << "\n";
+        for (size_t k = 0; k < CBR_KINDS; ++k)
+            if (byKind[k]) std::cout << cbrKindName(static_cast<CbrKind>(k)) << " " << byKind[k] << "\n";
+    }
+    return 0;
+}